@@ -0,0 +1,17 @@
+// bench/benchWorker.js
+// Runs the benchmark off the page's main thread so progress stays visible.
+import { runBenchmark } from './benchmark.js';
+import { loadWasmEvaluator, WASM_EVALUATOR_URL } from '../js/wasmEvaluate.js';
+
+self.onmessage = async function(e) {
+    try {
+        const options = e.data || {};
+        const evaluator = options.evaluator === "wasm" ? await loadWasmEvaluator(WASM_EVALUATOR_URL) : null;
+        if (options.evaluator === "wasm" && !evaluator) throw new Error("The WebAssembly evaluator is not available");
+        const report = runBenchmark(options, line => self.postMessage({ progress: line }), evaluator);
+        self.postMessage({ report });
+    } catch (error) {
+        console.error("[Bench] Benchmark failed:", error);
+        self.postMessage({ error: error.message || "Benchmark failed" });
+    }
+};
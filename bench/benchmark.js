@@ -0,0 +1,263 @@
+// bench/benchmark.js
+// Search benchmark shared by the Node runner (bench/run.js) and the browser page
+// (bench/index.html). Every position is searched
+//   - once to a fixed depth (node counts are deterministic, so changes in them
+//     point at search changes, changes in NPS at speed changes), and
+//   - `repeats` times with a fixed time limit (depth reached and best-move stability).
+// Each search starts from an empty transposition table. The report is plain JSON.
+// Another evaluator (the WebAssembly one) can be benchmarked in place of the
+// JavaScript one; the scores of the evaluator used are first checked against
+// evaluatePosition.
+
+import { findBestMove, prepareSearch, setSearchEvaluator } from '../js/aiSearch.js';
+import { evaluatePosition, IncrementalEvaluator } from '../js/aiEvaluate.js';
+import { Position, MAX_GAME_PLY } from '../js/position.js';
+import { generateMoves, getPositionStatus, MAX_MOVES } from '../js/moveGen.js';
+import { GameStatus, Player } from '../js/constants.js';
+import { DEFAULT_TT_SIZE_MB } from '../js/transpositionTable.js';
+import { BENCH_POSITIONS, benchPositionState } from './positions.js';
+
+export const BENCH_REPORT_VERSION = 1;
+
+export const DEFAULT_BENCH_OPTIONS = {
+    depth: 6,            // Fixed-depth search
+    timeLimitMs: 1000,   // Fixed-time search
+    repeats: 3,          // Fixed-time searches per position
+    maxTimedDepth: 30,   // Depth cap of the fixed-time searches
+    hashSizeMb: DEFAULT_TT_SIZE_MB,
+    positions: null,     // Names of the positions to run (null = all)
+    warmupDepth: 4,      // Unmeasured search of every position first, so the JIT has settled (0 = none)
+    nullMove: true,      // Null-move pruning (A/B: run with and without, compare the reports)
+    lateMoveReductions: true,
+    evaluator: "js",     // Label of the evaluator: "js", or "wasm" with a WasmEvaluator passed to runBenchmark
+    evaluatorCheckDepth: 3, // Plies of every position's move tree the evaluator is checked over
+    quiet: true          // Silence the search's console.log output while measuring
+};
+
+const UNLIMITED_TIME_MS = 1e9;
+const MAX_REPORTED_MISMATCHES = 5;
+
+function moveToString(move) {
+    if (!move) return null;
+    return `${move.pieceName} ${move.fromRow}${move.fromCol}-${move.toRow}${move.toCol}`;
+}
+
+function nodesPerSecond(nodes, timeMs) {
+    return timeMs > 0 ? Math.round(nodes * 1000 / timeMs) : 0;
+}
+
+function round(value, digits = 2) {
+    const f = 10 ** digits;
+    return Math.round(value * f) / f;
+}
+
+/** Number of times the best move changed between completed iterations. */
+function countBestMoveChanges(iterations) {
+    let changes = 0;
+    for (let i = 1; i < iterations.length; i++) {
+        if (moveToString(iterations[i].move) !== moveToString(iterations[i - 1].move)) changes++;
+    }
+    return changes;
+}
+
+/** Runs one search from an empty table and measures it. */
+function measureSearch(state, depth, timeLimitMs, hashSizeMb, pruning) {
+    prepareSearch({ hashSizeMb, newGame: true });
+    const start = performance.now();
+    const result = findBestMove(state, depth, timeLimitMs, { pruning });
+    const timeMs = performance.now() - start;
+    const iterations = result.iterations || [];
+    return {
+        depthReached: result.depthAchieved,
+        bestMove: moveToString(result.move),
+        eval: result.eval,
+        nodes: result.nodes,
+        timeMs: round(timeMs),
+        nps: nodesPerSecond(result.nodes, timeMs),
+        ttHitRate: round(result.ttHitRate || 0, 4),
+        ttFill: round(result.ttFill || 0, 4),
+        timeToDepthMs: iterations.map(it => ({ depth: it.depth, timeMs: round(it.timeMs), nodes: it.nodes })),
+        bestMoveChanges: countBestMoveChanges(iterations),
+        error: result.error || undefined
+    };
+}
+
+/**
+ * Checks an evaluator against evaluatePosition at every node of the move trees of
+ * the positions, to `depth` plies, with the moves made through the evaluator.
+ * @returns {{ depth: number, nodes: number, mismatches: Array<object> }}
+ */
+export function checkEvaluator(evaluator, positions, depth) {
+    const moveBuffers = Array.from({ length: Math.min(depth, MAX_GAME_PLY) + 1 }, () => new Int32Array(MAX_MOVES));
+    const mismatches = [];
+    let nodes = 0;
+    const visit = (pos, name, remaining, ply) => {
+        nodes++;
+        const score = evaluator.evaluate(pos);
+        const expected = evaluatePosition(pos);
+        if (score !== expected && mismatches.length < MAX_REPORTED_MISMATCHES) {
+            mismatches.push({ position: name, squares: Array.from(pos.squares).join(","), sideToMove: pos.sideToMove, score, expected });
+        }
+        if (remaining === 0 || getPositionStatus(pos) !== GameStatus.ONGOING) return;
+        const moves = moveBuffers[ply];
+        const count = generateMoves(pos, pos.sideToMove, moves);
+        for (let i = 0; i < count; i++) {
+            evaluator.makeMove(pos, moves[i]);
+            visit(pos, name, remaining - 1, ply + 1);
+            evaluator.unmakeMove(pos, moves[i]);
+        }
+    };
+    for (const position of positions) {
+        const pos = Position.fromBoardState(benchPositionState(position), Player.PLAYER1);
+        evaluator.reset(pos);
+        visit(pos, position.name, depth, 0);
+    }
+    return { depth, nodes, mismatches };
+}
+
+function benchEnvironment() {
+    if (typeof process !== 'undefined' && process.versions?.node) {
+        return { runtime: "node", version: process.versions.node, platform: process.platform, arch: process.arch };
+    }
+    return {
+        runtime: "browser",
+        userAgent: typeof navigator !== 'undefined' ? navigator.userAgent : "unknown",
+        hardwareConcurrency: typeof navigator !== 'undefined' ? navigator.hardwareConcurrency : undefined
+    };
+}
+
+/**
+ * Runs the benchmark.
+ * @param {object} [options] - Overrides of DEFAULT_BENCH_OPTIONS.
+ * @param {function(string): void} [onProgress] - Called with a short line per finished search.
+ * @param {object|null} [evaluator] - Search evaluator to use instead of the JavaScript one
+ *   (see aiSearch.setSearchEvaluator); name it in options.evaluator.
+ * @returns {object} JSON-serializable report.
+ */
+export function runBenchmark(options = {}, onProgress = null, evaluator = null) {
+    const opts = { ...DEFAULT_BENCH_OPTIONS, ...options };
+    const positions = opts.positions
+        ? BENCH_POSITIONS.filter(p => opts.positions.includes(p.name))
+        : BENCH_POSITIONS;
+    if (positions.length === 0) {
+        throw new Error(`No benchmark positions match: ${opts.positions}`);
+    }
+
+    const originalLog = console.log;
+    if (opts.quiet) console.log = () => {};
+    const results = [];
+    const pruning = { nullMove: opts.nullMove, lateMoveReductions: opts.lateMoveReductions };
+    let evaluatorCheck;
+    try {
+        setSearchEvaluator(evaluator);
+        evaluatorCheck = checkEvaluator(evaluator || new IncrementalEvaluator(), positions, opts.evaluatorCheckDepth);
+        onProgress?.(`${opts.evaluator} evaluator: ${evaluatorCheck.nodes} positions checked, ` +
+                     `${evaluatorCheck.mismatches.length ? "MISMATCHES" : "same scores"}`);
+        if (opts.warmupDepth > 0) {
+            for (const position of positions) {
+                measureSearch(benchPositionState(position), opts.warmupDepth, UNLIMITED_TIME_MS, opts.hashSizeMb, pruning);
+            }
+        }
+
+        for (const position of positions) {
+            const state = benchPositionState(position);
+
+            const fixedDepth = measureSearch(state, opts.depth, UNLIMITED_TIME_MS, opts.hashSizeMb, pruning);
+            onProgress?.(`${position.name}: depth ${fixedDepth.depthReached}, ${fixedDepth.nodes} nodes, ${fixedDepth.nps} nps`);
+
+            const timed = [];
+            for (let i = 0; i < opts.repeats; i++) {
+                timed.push(measureSearch(state, opts.maxTimedDepth, opts.timeLimitMs, opts.hashSizeMb, pruning));
+            }
+            const timedMoves = new Set(timed.map(r => r.bestMove));
+            const timedNodes = timed.reduce((sum, r) => sum + r.nodes, 0);
+            const timedTime = timed.reduce((sum, r) => sum + r.timeMs, 0);
+            onProgress?.(`${position.name}: ${opts.timeLimitMs}ms x${opts.repeats}, depths ${timed.map(r => r.depthReached).join("/")}`);
+
+            results.push({
+                name: position.name,
+                description: position.description,
+                fixedDepth,
+                fixedTime: {
+                    runs: timed,
+                    depthMin: Math.min(...timed.map(r => r.depthReached)),
+                    depthMax: Math.max(...timed.map(r => r.depthReached)),
+                    nps: nodesPerSecond(timedNodes, timedTime),
+                    // Same best move in every repeat
+                    stable: timedMoves.size === 1,
+                    agreesWithFixedDepth: timed.length > 0 && timed[0].bestMove === fixedDepth.bestMove
+                }
+            });
+        }
+    } finally {
+        console.log = originalLog;
+        setSearchEvaluator(null);
+    }
+
+    const depthNodes = results.reduce((sum, r) => sum + r.fixedDepth.nodes, 0);
+    const depthTime = results.reduce((sum, r) => sum + r.fixedDepth.timeMs, 0);
+    return {
+        version: BENCH_REPORT_VERSION,
+        timestamp: new Date().toISOString(),
+        environment: benchEnvironment(),
+        options: { ...opts, quiet: undefined },
+        positions: results,
+        evaluatorCheck,
+        summary: {
+            fixedDepthNodes: depthNodes,
+            fixedDepthTimeMs: round(depthTime),
+            fixedDepthNps: nodesPerSecond(depthNodes, depthTime),
+            fixedTimeNps: nodesPerSecond(
+                results.reduce((sum, r) => sum + r.fixedTime.runs.reduce((s, x) => s + x.nodes, 0), 0),
+                results.reduce((sum, r) => sum + r.fixedTime.runs.reduce((s, x) => s + x.timeMs, 0), 0)),
+            unstablePositions: results.filter(r => !r.fixedTime.stable).map(r => r.name)
+        }
+    };
+}
+
+/**
+ * Compares a report against a baseline report made with the same options.
+ * Only positions present in both reports are compared.
+ * @param {number} maxSlowdown - Allowed fixed-depth NPS drop as a fraction (0.1 = 10%).
+ * @returns {{ regressions: string[], notes: string[] }}
+ */
+export function compareBenchReports(report, baseline, maxSlowdown) {
+    const regressions = [];
+    const notes = [];
+    const base = new Map(baseline.positions.map(p => [p.name, p]));
+    const evaluator = report.options.evaluator ?? "js", baseEvaluator = baseline.options?.evaluator ?? "js";
+    if (evaluator !== baseEvaluator) notes.push(`evaluator ${baseEvaluator} -> ${evaluator}`);
+    if (report.evaluatorCheck?.mismatches.length > 0) {
+        regressions.push(`${evaluator} evaluator differs from evaluatePosition in ${report.evaluatorCheck.mismatches.length}+ positions`);
+    }
+    let nodes = 0, timeMs = 0, baseNodes = 0, baseTimeMs = 0;
+    for (const p of report.positions) {
+        const b = base.get(p.name);
+        if (!b) continue;
+        nodes += p.fixedDepth.nodes;
+        timeMs += p.fixedDepth.timeMs;
+        baseNodes += b.fixedDepth.nodes;
+        baseTimeMs += b.fixedDepth.timeMs;
+        if (p.fixedDepth.nodes !== b.fixedDepth.nodes) {
+            notes.push(`${p.name}: fixed-depth nodes ${b.fixedDepth.nodes} -> ${p.fixedDepth.nodes}`);
+        }
+        if (p.fixedDepth.bestMove !== b.fixedDepth.bestMove) {
+            notes.push(`${p.name}: best move ${b.fixedDepth.bestMove} -> ${p.fixedDepth.bestMove}`);
+        }
+        // Search changes (pruning A/B runs) show up as depth reached in the same time
+        if (p.fixedTime.depthMin !== b.fixedTime.depthMin || p.fixedTime.depthMax !== b.fixedTime.depthMax) {
+            notes.push(`${p.name}: fixed-time depth ${b.fixedTime.depthMin}-${b.fixedTime.depthMax} -> ${p.fixedTime.depthMin}-${p.fixedTime.depthMax}`);
+        }
+    }
+    if (baseNodes === 0) {
+        notes.push("No positions in common with the baseline");
+        return { regressions, notes };
+    }
+
+    const nps = nodesPerSecond(nodes, timeMs);
+    const baseNps = nodesPerSecond(baseNodes, baseTimeMs);
+    const ratio = baseNps > 0 ? nps / baseNps : 1;
+    const line = `fixed-depth NPS ${baseNps} -> ${nps} (${((ratio - 1) * 100).toFixed(1)}%)`;
+    if (ratio < 1 - maxSlowdown) regressions.push(line); else notes.push(line);
+    return { regressions, notes };
+}
@@ -0,0 +1,274 @@
+// bench/perft.js
+// Move-generation correctness and speed tool:
+//   node bench/perft.js [--depth N] [--positions start,random-a] [--player 0|1]
+//                       [--divide] [--check] [--check-depth N] [--json]
+//
+// Perft counts the leaf nodes of the full move tree to a fixed depth. A position
+// whose game is over (den entered, side wiped out) is a leaf: it is counted at
+// depth 0 and not expanded further. The optimized generator (moveGen.js on
+// position.js) is timed and reported in nodes/sec.
+//
+// --check cross-checks it against the reference implementation (rules.js on the
+// nested board format):
+//   - the reference perft counts of every depth must match, and
+//   - at every node up to --check-depth, the move sets, game status and Zobrist
+//     key must match; the first mismatches are printed with their position.
+
+import { pathToFileURL } from 'node:url';
+import { Player, GameStatus, BOARD_ROWS, BOARD_COLS } from '../js/constants.js';
+import { getAllValidMoves, getGameStatus } from '../js/rules.js';
+import { computeZobristKey } from '../js/zobrist.js';
+import {
+    Position, EMPTY, PIECE_TYPES, MAX_GAME_PLY,
+    codeType, codePlayer, moveFrom, moveTo, squareRow, squareCol, toSquare
+} from '../js/position.js';
+import { generateMoves, getPositionStatus, MAX_MOVES } from '../js/moveGen.js';
+import { BENCH_POSITIONS, benchPositionState } from './positions.js';
+
+const DEFAULT_DEPTH = 4;
+const DEFAULT_CHECK_DEPTH = 3;
+const MAX_REPORTED_MISMATCHES = 5;
+
+// Reusable per-ply move buffers of the optimized perft
+const moveBuffers = Array.from({ length: MAX_GAME_PLY }, () => new Int32Array(MAX_MOVES));
+
+// --- Optimized Generator ---
+
+/** Leaf count of the move tree below `pos` (restored on return). */
+export function perft(pos, depth, ply = 0) {
+    if (depth === 0) return 1;
+    if (getPositionStatus(pos) !== GameStatus.ONGOING) return 0;
+    const moves = moveBuffers[ply];
+    const count = generateMoves(pos, pos.sideToMove, moves);
+    if (depth === 1) return count; // Bulk counting: every child is a leaf
+
+    let nodes = 0;
+    for (let i = 0; i < count; i++) {
+        pos.makeMove(moves[i]);
+        nodes += perft(pos, depth - 1, ply + 1);
+        pos.unmakeMove(moves[i]);
+    }
+    return nodes;
+}
+
+/** Leaf counts per root move, as [{ move, nodes }]. */
+export function perftDivide(pos, depth) {
+    const moves = new Int32Array(MAX_MOVES);
+    const count = depth > 0 && getPositionStatus(pos) === GameStatus.ONGOING
+        ? generateMoves(pos, pos.sideToMove, moves)
+        : 0;
+    const result = [];
+    for (let i = 0; i < count; i++) {
+        pos.makeMove(moves[i]);
+        result.push({ move: packedMoveToString(moves[i]), nodes: perft(pos, depth - 1, 1) });
+        pos.unmakeMove(moves[i]);
+    }
+    return result;
+}
+
+// --- Reference Generator ---
+
+/** Copy of a nested board state with one move applied (the input is not modified). */
+function applyReferenceMove(state, move) {
+    const next = state.map(row => row.map(cell => ({ terrain: cell.terrain, piece: cell.piece })));
+    const piece = next[move.fromRow][move.fromCol].piece;
+    next[move.fromRow][move.fromCol].piece = null;
+    next[move.toRow][move.toCol].piece = { ...piece, row: move.toRow, col: move.toCol };
+    return next;
+}
+
+/** Leaf count using rules.js on the nested board format. */
+export function referencePerft(state, player, depth) {
+    if (depth === 0) return 1;
+    if (getGameStatus(state) !== GameStatus.ONGOING) return 0;
+    const moves = getAllValidMoves(player, state);
+    if (depth === 1) return moves.length;
+
+    let nodes = 0;
+    for (const move of moves) {
+        nodes += referencePerft(applyReferenceMove(state, move), Player.getOpponent(player), depth - 1);
+    }
+    return nodes;
+}
+
+// --- Node-by-Node Cross-Check ---
+
+function packedMoveToString(move) {
+    const from = moveFrom(move);
+    const to = moveTo(move);
+    return `${squareRow(from)}${squareCol(from)}-${squareRow(to)}${squareCol(to)}`;
+}
+
+function referenceMoveToString(move) {
+    return `${move.fromRow}${move.fromCol}-${move.toRow}${move.toCol}`;
+}
+
+/** One line per row; Red pieces in upper case, Blue in lower case, '.' for empty. */
+function positionToText(pos) {
+    const lines = [];
+    for (let r = 0; r < BOARD_ROWS; r++) {
+        let line = "";
+        for (let c = 0; c < BOARD_COLS; c++) {
+            const code = pos.squares[toSquare(r, c)];
+            if (code === EMPTY) { line += "."; continue; }
+            const letter = PIECE_TYPES[codeType(code)] === "leopard" ? "p" : PIECE_TYPES[codeType(code)][0];
+            line += codePlayer(code) === Player.PLAYER1 ? letter.toUpperCase() : letter;
+        }
+        lines.push(line);
+    }
+    return lines.join("\n");
+}
+
+/**
+ * Walks the optimized move tree and compares every node with the reference.
+ * @returns {{ nodes: number, mismatches: string[] }}
+ */
+export function crossCheck(pos, depth) {
+    const mismatches = [];
+    let nodes = 0;
+
+    const visit = (d, ply, path) => {
+        nodes++;
+        const state = pos.toBoardState();
+        const report = (what) => {
+            if (mismatches.length < MAX_REPORTED_MISMATCHES) {
+                mismatches.push(`${what}\n  path: ${path.join(" ") || "(root)"}, side to move: ${pos.sideToMove}\n${positionToText(pos)}`);
+            } else if (mismatches.length === MAX_REPORTED_MISMATCHES) {
+                mismatches.push("(further mismatches not shown)");
+            }
+        };
+
+        if (pos.hashKey() !== computeZobristKey(state, pos.sideToMove)) report("Zobrist key differs");
+        const status = getPositionStatus(pos);
+        const referenceStatus = getGameStatus(state);
+        if (status !== referenceStatus) report(`Status differs: ${status} vs reference ${referenceStatus}`);
+        if (d === 0 || status !== GameStatus.ONGOING) return;
+
+        const moves = moveBuffers[ply];
+        const count = generateMoves(pos, pos.sideToMove, moves);
+        const mine = Array.from(moves.subarray(0, count), packedMoveToString).sort();
+        const reference = getAllValidMoves(pos.sideToMove, state).map(referenceMoveToString).sort();
+        if (mine.join() !== reference.join()) {
+            const missing = reference.filter(m => !mine.includes(m));
+            const extra = mine.filter(m => !reference.includes(m));
+            report(`Moves differ: missing [${missing.join(" ")}], extra [${extra.join(" ")}]`);
+        }
+
+        for (let i = 0; i < count; i++) {
+            const move = moves[i];
+            pos.makeMove(move);
+            path.push(packedMoveToString(move));
+            visit(d - 1, ply + 1, path);
+            path.pop();
+            pos.unmakeMove(move);
+        }
+    };
+
+    visit(depth, 0, []);
+    return { nodes, mismatches };
+}
+
+// --- Command Line ---
+
+function parseArgs(argv) {
+    const flags = new Set(["divide", "check", "json"]);
+    const args = {};
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        if (!arg.startsWith("--")) throw new Error(`Unexpected argument: ${arg}`);
+        const name = arg.slice(2);
+        if (flags.has(name)) { args[name] = true; continue; }
+        const value = argv[i + 1];
+        if (value === undefined || value.startsWith("--")) throw new Error(`Missing value for ${arg}`);
+        args[name] = value;
+        i++;
+    }
+    return args;
+}
+
+function toInteger(args, name, fallback, min, max) {
+    if (args[name] === undefined) return fallback;
+    const n = Number(args[name]);
+    if (!Number.isInteger(n) || n < min || n > max) throw new Error(`--${name} expects an integer from ${min} to ${max}`);
+    return n;
+}
+
+function timed(fn) {
+    const start = performance.now();
+    const value = fn();
+    return { value, timeMs: performance.now() - start };
+}
+
+function nodesPerSecond(nodes, timeMs) {
+    return timeMs > 0 ? Math.round(nodes * 1000 / timeMs) : 0;
+}
+
+function main() {
+    let args, depth, checkDepth, player;
+    try {
+        args = parseArgs(process.argv.slice(2));
+        depth = toInteger(args, "depth", DEFAULT_DEPTH, 1, MAX_GAME_PLY - 1);
+        checkDepth = toInteger(args, "check-depth", Math.min(depth, DEFAULT_CHECK_DEPTH), 0, depth);
+        player = toInteger(args, "player", Player.PLAYER1, Player.PLAYER0, Player.PLAYER1);
+    } catch (e) {
+        console.error(e.message);
+        process.exit(2);
+    }
+    const names = args.positions ? args.positions.split(",") : null;
+    const positions = names ? BENCH_POSITIONS.filter(p => names.includes(p.name)) : BENCH_POSITIONS;
+    if (positions.length === 0) {
+        console.error(`No positions match: ${args.positions}`);
+        process.exit(2);
+    }
+
+    const out = args.json ? () => {} : (line) => console.log(line);
+    const report = { depth, player, positions: [] };
+    let failed = false;
+
+    for (const position of positions) {
+        const state = benchPositionState(position);
+        const pos = Position.fromBoardState(state, player);
+        const entry = { name: position.name, depths: [] };
+        out(`${position.name} (${position.description}), player ${player} to move`);
+
+        for (let d = 1; d <= depth; d++) {
+            const fast = timed(() => perft(pos, d));
+            const row = { depth: d, nodes: fast.value, timeMs: Math.round(fast.timeMs * 100) / 100, nps: nodesPerSecond(fast.value, fast.timeMs) };
+            let line = `  perft(${d}) = ${fast.value}  ${row.timeMs.toFixed(1)}ms  ${row.nps} nodes/s`;
+            if (args.check) {
+                const ref = timed(() => referencePerft(state, player, d));
+                row.referenceNodes = ref.value;
+                row.referenceNps = nodesPerSecond(ref.value, ref.timeMs);
+                line += `  | reference ${ref.value} ${row.referenceNps} nodes/s`;
+                if (ref.value !== fast.value) {
+                    line += "  MISMATCH";
+                    failed = true;
+                }
+            }
+            entry.depths.push(row);
+            out(line);
+        }
+
+        if (args.divide) {
+            entry.divide = perftDivide(pos, depth);
+            for (const { move, nodes } of entry.divide) out(`    ${move}: ${nodes}`);
+        }
+
+        if (args.check) {
+            const { nodes, mismatches } = crossCheck(pos, checkDepth);
+            entry.crossCheck = { depth: checkDepth, nodes, mismatches };
+            out(`  cross-check to depth ${checkDepth}: ${nodes} nodes, ${mismatches.length ? "MISMATCHES" : "ok"}`);
+            for (const m of mismatches) out("  " + m.replace(/\n/g, "\n  "));
+            if (mismatches.length) failed = true;
+        }
+        report.positions.push(entry);
+    }
+
+    if (args.json) console.log(JSON.stringify(report, null, 2));
+    if (failed) process.exit(1);
+}
+
+// Run as a command, but stay importable by other tools
+if (process.argv[1] && import.meta.url === pathToFileURL(process.argv[1]).href) {
+    main();
+}
@@ -0,0 +1,80 @@
+// bench/positions.js
+// Fixed positions searched by the benchmark. The AI (Player 1, Red, top) is to move
+// in all of them. Layouts use the same { type, player, r, c } entries as
+// Board.setupPiecesFromLayout; `layout: null` is the standard start.
+
+import { Player } from '../js/constants.js';
+import { Board } from '../js/board.js';
+
+/** Expands compact [type, player, row, col] tuples into layout entries. */
+function layout(pieces) {
+    return pieces.map(([type, player, r, c]) => ({ type, player, r, c }));
+}
+
+const P0 = Player.PLAYER0;
+const P1 = Player.PLAYER1;
+
+export const BENCH_POSITIONS = [
+    {
+        name: "start",
+        description: "Standard opening setup",
+        layout: null
+    },
+    {
+        // Generated with the handleRandomizeBoard procedure (180-degree symmetry)
+        name: "random-a",
+        description: "Randomized symmetric layout",
+        layout: layout([
+            ["dog", P1, 2, 1], ["dog", P0, 6, 5], ["cat", P1, 1, 5], ["cat", P0, 7, 1],
+            ["lion", P1, 1, 0], ["lion", P0, 7, 6], ["elephant", P1, 3, 0], ["elephant", P0, 5, 6],
+            ["leopard", P1, 2, 6], ["leopard", P0, 6, 0], ["wolf", P1, 1, 2], ["wolf", P0, 7, 4],
+            ["rat", P1, 2, 3], ["rat", P0, 6, 3], ["tiger", P1, 2, 4], ["tiger", P0, 6, 2]
+        ])
+    },
+    {
+        name: "random-b",
+        description: "Randomized symmetric layout",
+        layout: layout([
+            ["leopard", P1, 2, 6], ["leopard", P0, 6, 0], ["rat", P1, 1, 3], ["rat", P0, 7, 3],
+            ["elephant", P1, 1, 6], ["elephant", P0, 7, 0], ["wolf", P1, 3, 6], ["wolf", P0, 5, 0],
+            ["lion", P1, 3, 3], ["lion", P0, 5, 3], ["cat", P1, 1, 2], ["cat", P0, 7, 4],
+            ["dog", P1, 1, 0], ["dog", P0, 7, 6], ["tiger", P1, 0, 5], ["tiger", P0, 8, 1]
+        ])
+    },
+    {
+        name: "endgame-jumps",
+        description: "Lion and tiger against a rat guarding the river",
+        layout: layout([
+            ["lion", P1, 2, 1], ["tiger", P1, 2, 5], ["cat", P1, 1, 3],
+            ["rat", P0, 4, 4], ["elephant", P0, 6, 1], ["dog", P0, 7, 3]
+        ])
+    },
+    {
+        name: "endgame-traps",
+        description: "Pieces fighting around the Blue den traps",
+        layout: layout([
+            ["wolf", P1, 6, 2], ["leopard", P1, 5, 3], ["rat", P1, 4, 5],
+            ["dog", P0, 7, 4], ["elephant", P0, 8, 2], ["cat", P0, 6, 6]
+        ])
+    },
+    {
+        name: "endgame-race",
+        description: "Few pieces racing for the dens",
+        layout: layout([
+            ["elephant", P1, 4, 0], ["rat", P1, 1, 3],
+            ["lion", P0, 4, 6], ["rat", P0, 7, 3]
+        ])
+    }
+];
+
+/** Builds the worker-style board state of a benchmark position. */
+export function benchPositionState(position) {
+    const board = new Board();
+    board.initBoard();
+    if (position.layout) {
+        board.setupPiecesFromLayout(position.layout);
+    } else {
+        board.setupStandardInitialPieces();
+    }
+    return board.getClonedStateForWorker();
+}
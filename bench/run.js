@@ -0,0 +1,97 @@
+// bench/run.js
+// Headless benchmark runner:
+//   node bench/run.js [--depth N] [--time MS] [--repeats N] [--hash MB]
+//                     [--positions start,endgame-race] [--out report.json]
+//                     [--baseline old.json] [--max-slowdown 0.1]
+//                     [--null-move on|off] [--lmr on|off] [--evaluator js|wasm]
+// Prints the JSON report to stdout (or writes it to --out). With --baseline, the
+// comparison goes to stderr and the exit code is 1 when NPS dropped more than allowed.
+
+import { readFileSync, writeFileSync } from 'node:fs';
+import { runBenchmark, compareBenchReports, DEFAULT_BENCH_OPTIONS } from './benchmark.js';
+import { createWasmEvaluator, WASM_EVALUATOR_URL } from '../js/wasmEvaluate.js';
+
+const DEFAULT_MAX_SLOWDOWN = 0.1;
+
+function parseArgs(argv) {
+    const args = {};
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        if (!arg.startsWith("--")) throw new Error(`Unexpected argument: ${arg}`);
+        const value = argv[i + 1];
+        if (value === undefined || value.startsWith("--")) throw new Error(`Missing value for ${arg}`);
+        args[arg.slice(2)] = value;
+        i++;
+    }
+    return args;
+}
+
+function toNumber(args, name, fallback) {
+    if (args[name] === undefined) return fallback;
+    const n = Number(args[name]);
+    if (!Number.isFinite(n) || n < 0) throw new Error(`--${name} expects a non-negative number`);
+    return n;
+}
+
+function toSwitch(args, name, fallback) {
+    if (args[name] === undefined) return fallback;
+    if (args[name] !== "on" && args[name] !== "off") throw new Error(`--${name} expects on or off`);
+    return args[name] === "on";
+}
+
+async function main() {
+    let args;
+    try {
+        args = parseArgs(process.argv.slice(2));
+    } catch (e) {
+        console.error(e.message);
+        process.exit(2);
+    }
+
+    let options;
+    try {
+        options = {
+            depth: toNumber(args, "depth", DEFAULT_BENCH_OPTIONS.depth),
+            timeLimitMs: toNumber(args, "time", DEFAULT_BENCH_OPTIONS.timeLimitMs),
+            repeats: toNumber(args, "repeats", DEFAULT_BENCH_OPTIONS.repeats),
+            hashSizeMb: toNumber(args, "hash", DEFAULT_BENCH_OPTIONS.hashSizeMb),
+            positions: args.positions ? args.positions.split(",") : null,
+            nullMove: toSwitch(args, "null-move", DEFAULT_BENCH_OPTIONS.nullMove),
+            lateMoveReductions: toSwitch(args, "lmr", DEFAULT_BENCH_OPTIONS.lateMoveReductions),
+            evaluator: args.evaluator ?? DEFAULT_BENCH_OPTIONS.evaluator
+        };
+        if (options.evaluator !== "js" && options.evaluator !== "wasm") throw new Error("--evaluator expects js or wasm");
+    } catch (e) {
+        console.error(e.message);
+        process.exit(2);
+    }
+
+    let evaluator = null;
+    if (options.evaluator === "wasm") {
+        try {
+            evaluator = await createWasmEvaluator(readFileSync(WASM_EVALUATOR_URL));
+        } catch (e) {
+            console.error(`[Bench] WebAssembly evaluator unavailable: ${e.message}`);
+            process.exit(2);
+        }
+    }
+
+    const report = runBenchmark(options, line => console.error(`[Bench] ${line}`), evaluator);
+    const json = JSON.stringify(report, null, 2);
+    if (args.out) {
+        writeFileSync(args.out, json + "\n");
+        console.error(`[Bench] Report written to ${args.out}`);
+    } else {
+        console.log(json);
+    }
+
+    if (args.baseline) {
+        const baseline = JSON.parse(readFileSync(args.baseline, "utf8"));
+        const { regressions, notes } = compareBenchReports(report, baseline, toNumber(args, "max-slowdown", DEFAULT_MAX_SLOWDOWN));
+        for (const note of notes) console.error(`[Bench] ${note}`);
+        for (const regression of regressions) console.error(`[Bench] REGRESSION: ${regression}`);
+        if (regressions.length > 0) process.exit(1);
+    }
+}
+
+main();
@@ -0,0 +1,206 @@
+// bench/selfPlay.js
+// Engine-vs-engine games for the tournament runner (bench/tournament.js). Both sides are
+// played by the search of js/aiSearch.js; each engine configuration keeps its own
+// transposition table and evaluation parameters, which are swapped in before it moves.
+// Games are adjudicated like the game itself: rules.getGameStatus (den entry, all
+// pieces captured), no legal move (loses), threefold repetition (draw), plus a ply cap.
+// Games can also record their positions for evaluation tuning (bench/tuningData.js).
+
+import { findBestMove, prepareSearch } from '../js/aiSearch.js';
+import { getEvalParams, setEvalParams, WIN_SCORE } from '../js/aiEvaluate.js';
+import { TranspositionTable, DEFAULT_TT_SIZE_MB } from '../js/transpositionTable.js';
+import { Position, encodeMove, toSquare, moveTo, EMPTY, NUM_SQUARES } from '../js/position.js';
+import { generateMoves, isLegalMove, getPositionStatus, MAX_MOVES } from '../js/moveGen.js';
+import { getGameStatus } from '../js/rules.js';
+import { Board } from '../js/board.js';
+import { generateSymmetricLayout } from '../js/boardLayout.js';
+import { Player, GameStatus } from '../js/constants.js';
+
+export const DEFAULT_ENGINE_CONFIG = {
+    name: null,
+    depth: 6,                // Target depth
+    timeLimitMs: 0,          // Time per move (0 = none, the depth or node budget decides)
+    nodeLimit: 0,            // Node budget per move (0 = none)
+    hashSizeMb: DEFAULT_TT_SIZE_MB,
+    nullMove: true,
+    lateMoveReductions: true,
+    timeManagement: false,   // Stop before the time per move when the best move is settled (timeManager.js)
+    evalParams: null         // Partial EVAL_PARAMS on top of the defaults (null = defaults)
+};
+
+export const DEFAULT_MAX_PLIES = 300; // Longer games are scored as draws
+
+// Recorded positions: the opening phase, positions right after a capture (usually
+// about to be recaptured) and decided ones say little about the evaluation terms
+const RECORD_SKIP_PLIES = 8;
+const RECORD_MAX_SCORE = WIN_SCORE / 2;
+
+const UNLIMITED_TIME_MS = 1e9;
+const BASE_EVAL_PARAMS = getEvalParams(); // Defaults of this build, before any engine changed them
+
+/** Deterministic PRNG (mulberry32) with numbers in [0, 1), so openings can be reproduced. */
+export function createRandom(seed) {
+    let state = seed | 0;
+    return function random() {
+        state = (state + 0x6D2B79F5) | 0;
+        let t = Math.imul(state ^ (state >>> 15), 1 | state);
+        t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+        return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+    };
+}
+
+/** Position of a layout (null = the standard one) with Player 0 to move, as in the game. */
+function layoutPosition(layout) {
+    const board = new Board();
+    board.initBoard();
+    if (layout) board.setupPiecesFromLayout(layout);
+    else board.setupStandardInitialPieces();
+    return Position.fromBoardState(board.getState(), Player.PLAYER0);
+}
+
+/**
+ * Creates `count` openings: a starting layout (randomized with 180-degree symmetry, or
+ * the standard one) followed by `randomPlies` random legal moves. Openings that end the
+ * game are drawn again.
+ * @returns {Array<{layout: Array|null, moves: number[]}>} Encoded moves per opening.
+ */
+export function createOpenings(count, { randomLayout = true, randomPlies = 0, seed = 1 } = {}) {
+    const random = createRandom(seed);
+    const buffer = new Int32Array(MAX_MOVES);
+    const openings = [];
+    while (openings.length < count) {
+        const layout = randomLayout ? generateSymmetricLayout(random) : null;
+        if (randomLayout && !layout) continue;
+        const pos = layoutPosition(layout);
+        const moves = [];
+        for (let ply = 0; ply < randomPlies; ply++) {
+            const moveCount = generateMoves(pos, pos.sideToMove, buffer);
+            if (moveCount === 0) break;
+            const move = buffer[Math.floor(random() * moveCount)];
+            pos.makeMove(move);
+            moves.push(move);
+            if (getPositionStatus(pos) !== GameStatus.ONGOING) break;
+        }
+        if (moves.length === randomPlies && getPositionStatus(pos) === GameStatus.ONGOING) {
+            openings.push({ layout, moves });
+        }
+    }
+    return openings;
+}
+
+/** Prepares an engine configuration for play: its own table and complete evaluation parameters. */
+export function createEngine(config) {
+    const options = { ...DEFAULT_ENGINE_CONFIG, ...config };
+    const params = options.evalParams || {};
+    return {
+        ...options,
+        fullEvalParams: {
+            ...BASE_EVAL_PARAMS,
+            ...params,
+            HEURISTIC_WEIGHTS: { ...BASE_EVAL_PARAMS.HEURISTIC_WEIGHTS, ...(params.HEURISTIC_WEIGHTS || {}) }
+        },
+        pruning: { nullMove: options.nullMove, lateMoveReductions: options.lateMoveReductions },
+        table: new TranspositionTable(options.hashSizeMb, TranspositionTable.createSharedBuffer(options.hashSizeMb))
+    };
+}
+
+let activeEngine = null; // Engine whose evaluation parameters are compiled
+
+/** Makes `engine` the one the next search plays with. */
+function activateEngine(engine) {
+    if (activeEngine !== engine) {
+        setEvalParams(engine.fullEvalParams);
+        activeEngine = engine;
+    }
+    // The search uses the engine's table like a parallel worker uses the pool's one
+    engine.table.newSearch();
+    prepareSearch({ hashSizeMb: engine.table.sizeMb, sharedTable: engine.table.buffer, ttGeneration: engine.table.generation });
+}
+
+function emptySideStats() {
+    return { moves: 0, depthSum: 0, nodes: 0, timeMs: 0 };
+}
+
+/**
+ * Plays one game from `opening`.
+ * @param {Array<object>} engines - Engines (from createEngine) for Player 0 and Player 1.
+ * @param {boolean} [options.record=false] - Also return the positions worth recording.
+ * @returns {{winner:number, reason:string, plies:number, stats:Array<object>, positions:Array|null}}
+ *   The winner (Player.NONE for a draw), why the game ended ('rules', 'no-moves',
+ *   'illegal-move', 'repetition' or 'max-plies'), each side's moves, depth sum, nodes
+ *   and search time, and the recorded { squares, sideToMove } (null unless recording).
+ */
+export function playGame(opening, engines, { maxPlies = DEFAULT_MAX_PLIES, record = false } = {}) {
+    let pos = layoutPosition(opening.layout);
+    for (const move of opening.moves) pos.makeMove(move);
+    pos = Position.fromSquares(pos.squares, pos.sideToMove);
+
+    for (const engine of engines) engine.table.clear();
+    prepareSearch({ newGame: true, sharedTable: engines[0].table.buffer, hashSizeMb: engines[0].table.sizeMb }); // Clears the move history
+
+    const stats = [emptySideStats(), emptySideStats()];
+    const repetitions = new Map([[pos.hashKey(), 1]]);
+    let history = []; // Keys of the positions since the last capture, before the current one
+    const positions = record ? [] : null;
+    let lastMoveCaptured = false;
+    const finish = (winner, reason, plies) => ({ winner, reason, plies, stats, positions });
+
+    for (let ply = 0; ; ply++) {
+        const status = getGameStatus(pos.toBoardState());
+        if (status === GameStatus.PLAYER0_WINS) return finish(Player.PLAYER0, 'rules', ply);
+        if (status === GameStatus.PLAYER1_WINS) return finish(Player.PLAYER1, 'rules', ply);
+        if (status === GameStatus.DRAW) return finish(Player.NONE, 'rules', ply);
+        if (ply >= maxPlies) return finish(Player.NONE, 'max-plies', ply);
+
+        const side = pos.sideToMove;
+        const engine = engines[side];
+        activateEngine(engine);
+        const start = performance.now();
+        const result = findBestMove(pos, engine.depth, engine.timeLimitMs > 0 ? engine.timeLimitMs : UNLIMITED_TIME_MS,
+                                    { nodeLimit: engine.nodeLimit, gameHistory: history, pruning: engine.pruning,
+                                      timeManagement: engine.timeManagement && engine.timeLimitMs > 0 });
+        const sideStats = stats[side];
+        sideStats.timeMs += performance.now() - start;
+        sideStats.nodes += result.nodes || 0;
+
+        if (!result.move) return finish(Player.getOpponent(side), 'no-moves', ply);
+        const m = result.move;
+        const move = encodeMove(toSquare(m.fromRow, m.fromCol), toSquare(m.toRow, m.toCol));
+        if (!isLegalMove(pos, move, side)) return finish(Player.getOpponent(side), 'illegal-move', ply);
+        sideStats.moves++;
+        sideStats.depthSum += result.depthAchieved || 0;
+        if (record && opening.moves.length + ply >= RECORD_SKIP_PLIES && !lastMoveCaptured &&
+            Math.abs(result.eval ?? WIN_SCORE) < RECORD_MAX_SCORE) {
+            positions.push({ squares: pos.squares.slice(0, NUM_SQUARES), sideToMove: side });
+        }
+
+        lastMoveCaptured = pos.squares[moveTo(move)] !== EMPTY;
+        history = lastMoveCaptured ? [] : [...history, pos.hashKey()];
+        pos.makeMove(move);
+        // A fresh position each ply: the make/unmake stack only covers a search's depth
+        pos = Position.fromSquares(pos.squares, pos.sideToMove);
+
+        const key = pos.hashKey();
+        const count = (repetitions.get(key) || 0) + 1;
+        repetitions.set(key, count);
+        if (count >= 3) return finish(Player.NONE, 'repetition', ply + 1);
+    }
+}
+
+/**
+ * Elo difference (with a 95% confidence half-width) for a score of wins, draws and
+ * losses, from the per-game score variance. Infinite when one side scored everything.
+ */
+export function computeElo(wins, draws, losses) {
+    const games = wins + draws + losses;
+    if (games === 0) return { elo: 0, error: Infinity, score: 0.5 };
+    const score = (wins + draws / 2) / games;
+    const eloOf = s => (s <= 0 ? -Infinity : s >= 1 ? Infinity : -400 * Math.log10(1 / s - 1));
+    const variance = (wins * (1 - score) ** 2 + draws * (0.5 - score) ** 2 + losses * score ** 2) / games;
+    const margin = 1.96 * Math.sqrt(variance / games);
+    return {
+        elo: eloOf(score),
+        error: (eloOf(score + margin) - eloOf(score - margin)) / 2,
+        score
+    };
+}
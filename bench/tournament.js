@@ -0,0 +1,212 @@
+// bench/tournament.js
+// Headless self-play tournament between two engine configurations:
+//   node bench/tournament.js [--a SPEC] [--b SPEC] [--games N] [--threads N]
+//                            [--openings random|standard] [--random-plies N] [--seed N]
+//                            [--max-plies N] [--tablebases DIR] [--record FILE]
+//                            [--out report.json]
+// SPEC is a comma-separated list of name=LABEL, depth=N, time=MS, nodes=N, hash=MB,
+// null-move=on|off, lmr=on|off, time-manager=on|off (with time=MS) and params=FILE (partial EVAL_PARAMS as JSON), e.g.
+//   --a depth=6,params=tuned.json --b depth=6
+// Every opening is played twice, with the colours swapped. Games run on worker threads
+// (one per core by default). Progress goes to stderr; the JSON report (Elo of A against
+// B with a 95% interval, results, average depth and NPS per engine) to stdout or --out.
+// --record appends the games' positions and results to a tuning data file for
+// tools/tuneEval.js (see bench/tuningData.js).
+
+import { readFileSync, writeFileSync } from 'node:fs';
+import { availableParallelism } from 'node:os';
+import { Worker } from 'node:worker_threads';
+import { Player } from '../js/constants.js';
+import { DEFAULT_ENGINE_CONFIG, DEFAULT_MAX_PLIES, createOpenings, computeElo } from './selfPlay.js';
+import { TuningDataWriter } from './tuningData.js';
+
+const DEFAULT_GAMES = 100;
+const DEFAULT_RANDOM_PLIES = 2;
+
+function parseArgs(argv) {
+    const args = {};
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        if (!arg.startsWith("--")) throw new Error(`Unexpected argument: ${arg}`);
+        const value = argv[i + 1];
+        if (value === undefined || value.startsWith("--")) throw new Error(`Missing value for ${arg}`);
+        args[arg.slice(2)] = value;
+        i++;
+    }
+    return args;
+}
+
+function toInteger(value, name) {
+    const n = Number(value);
+    if (!Number.isInteger(n) || n < 0) throw new Error(`${name} expects a non-negative integer`);
+    return n;
+}
+
+function toSwitch(value, name) {
+    if (value !== "on" && value !== "off") throw new Error(`${name} expects on or off`);
+    return value === "on";
+}
+
+/** Engine configuration of a SPEC (see the top of the file). */
+function parseEngineSpec(spec, fallbackName) {
+    const config = { ...DEFAULT_ENGINE_CONFIG, name: fallbackName };
+    if (!spec) return config;
+    for (const item of spec.split(",")) {
+        const [key, value] = item.split("=");
+        if (value === undefined) throw new Error(`Engine option ${item} expects key=value`);
+        switch (key) {
+            case "name": config.name = value; break;
+            case "depth": config.depth = toInteger(value, key); break;
+            case "time": config.timeLimitMs = toInteger(value, key); break;
+            case "nodes": config.nodeLimit = toInteger(value, key); break;
+            case "hash": config.hashSizeMb = toInteger(value, key); break;
+            case "null-move": config.nullMove = toSwitch(value, key); break;
+            case "lmr": config.lateMoveReductions = toSwitch(value, key); break;
+            case "time-manager": config.timeManagement = toSwitch(value, key); break;
+            case "params": config.evalParams = JSON.parse(readFileSync(value, "utf8")); break;
+            default: throw new Error(`Unknown engine option: ${key}`);
+        }
+    }
+    return config;
+}
+
+function round(value, digits = 1) {
+    if (!Number.isFinite(value)) return value;
+    const f = 10 ** digits;
+    return Math.round(value * f) / f;
+}
+
+function formatElo({ elo, error }) {
+    return `${Number.isFinite(elo) ? round(elo) : elo} +/- ${Number.isFinite(error) ? round(error) : "inf"}`;
+}
+
+/**
+ * Plays the games on `threadCount` workers, handing out the next game whenever one finishes.
+ * @returns {Promise<Array<object>>} The playGame results, in game order.
+ */
+function runGames(openings, workerData, threadCount, onResult) {
+    const jobs = [];
+    openings.forEach((opening, i) => {
+        jobs.push({ gameIndex: 2 * i, opening, firstEngine: 0 });
+        jobs.push({ gameIndex: 2 * i + 1, opening, firstEngine: 1 });
+    });
+    const results = new Array(jobs.length);
+    let next = 0;
+    let finished = 0;
+
+    return new Promise((resolve, reject) => {
+        const workers = [];
+        const stopAll = () => workers.forEach(w => w.terminate());
+        for (let t = 0; t < Math.min(threadCount, jobs.length); t++) {
+            const worker = new Worker(new URL('./tournamentWorker.js', import.meta.url), { workerData });
+            workers.push(worker);
+            worker.on('message', result => {
+                results[result.gameIndex] = result;
+                finished++;
+                onResult(result, finished, jobs.length);
+                if (next < jobs.length) {
+                    worker.postMessage(jobs[next++]);
+                } else if (finished === jobs.length) {
+                    stopAll();
+                    resolve(results);
+                }
+            });
+            worker.on('error', error => {
+                stopAll();
+                reject(error);
+            });
+            worker.postMessage(jobs[next++]);
+        }
+    });
+}
+
+function emptyEngineTotals() {
+    return { moves: 0, depthSum: 0, nodes: 0, timeMs: 0 };
+}
+
+async function main() {
+    let args, engines, gameCount, threadCount, openingOptions, maxPlies;
+    try {
+        args = parseArgs(process.argv.slice(2));
+        engines = [parseEngineSpec(args.a, "A"), parseEngineSpec(args.b, "B")];
+        gameCount = args.games === undefined ? DEFAULT_GAMES : toInteger(args.games, "--games");
+        threadCount = args.threads === undefined ? availableParallelism() : Math.max(1, toInteger(args.threads, "--threads"));
+        if (args.openings !== undefined && args.openings !== "random" && args.openings !== "standard") {
+            throw new Error("--openings expects random or standard");
+        }
+        openingOptions = {
+            randomLayout: args.openings !== "standard",
+            randomPlies: args["random-plies"] === undefined ? DEFAULT_RANDOM_PLIES : toInteger(args["random-plies"], "--random-plies"),
+            seed: args.seed === undefined ? 1 : toInteger(args.seed, "--seed")
+        };
+        maxPlies = args["max-plies"] === undefined ? DEFAULT_MAX_PLIES : toInteger(args["max-plies"], "--max-plies");
+    } catch (e) {
+        console.error(e.message);
+        process.exit(2);
+    }
+
+    const openings = createOpenings(Math.ceil(gameCount / 2), openingOptions);
+    const [nameA, nameB] = engines.map(e => e.name);
+    console.error(`[Tournament] ${nameA} vs ${nameB}: ${openings.length * 2} games on ${threadCount} thread(s).`);
+
+    // Results from engine A's view
+    let wins = 0, draws = 0, losses = 0;
+    const totals = [emptyEngineTotals(), emptyEngineTotals()];
+    const reasons = {};
+    let errors = 0;
+    const recorder = args.record ? new TuningDataWriter(args.record) : null;
+    const start = performance.now();
+
+    const workerData = { engines, maxPlies, tablebases: args.tablebases || null, record: recorder !== null };
+    const results = await runGames(openings, workerData, threadCount,
+        (result, finished, total) => {
+            if (result.error) {
+                errors++;
+                return;
+            }
+            if (recorder && result.records) recorder.append(result.records);
+            // Engine A plays Player 0 when it moves first
+            const playerOfA = result.firstEngine === 0 ? Player.PLAYER0 : Player.PLAYER1;
+            if (result.winner === Player.NONE) draws++;
+            else if (result.winner === playerOfA) wins++;
+            else losses++;
+            reasons[result.reason] = (reasons[result.reason] || 0) + 1;
+            for (let engine = 0; engine < 2; engine++) {
+                const sideStats = result.stats[engine === 0 ? playerOfA : Player.getOpponent(playerOfA)];
+                for (const key in sideStats) totals[engine][key] += sideStats[key];
+            }
+            console.error(`[Tournament] ${finished}/${total}  ${nameA}: +${wins} =${draws} -${losses}  Elo ${formatElo(computeElo(wins, draws, losses))}`);
+        });
+
+    const elo = computeElo(wins, draws, losses);
+    const report = {
+        engines: engines.map((config, i) => ({
+            ...config,
+            averageDepth: round(totals[i].depthSum / Math.max(1, totals[i].moves), 2),
+            nodesPerSecond: totals[i].timeMs > 0 ? Math.round(totals[i].nodes * 1000 / totals[i].timeMs) : 0,
+            msPerMove: round(totals[i].timeMs / Math.max(1, totals[i].moves)),
+            moves: totals[i].moves
+        })),
+        options: { ...openingOptions, games: results.length, maxPlies, threads: threadCount, tablebases: args.tablebases || null, record: args.record || null },
+        results: { wins, draws, losses, errors, reasons },
+        score: round(elo.score, 4),
+        elo: round(elo.elo),
+        eloError: round(elo.error),
+        elapsedMs: Math.round(performance.now() - start)
+    };
+    console.error(`[Tournament] ${nameA} vs ${nameB}: Elo ${formatElo(elo)} (+${wins} =${draws} -${losses})`);
+    if (recorder) {
+        recorder.close();
+        console.error(`[Tournament] ${recorder.records} positions recorded to ${args.record}`);
+    }
+
+    const json = JSON.stringify(report, null, 2);
+    if (args.out) {
+        writeFileSync(args.out, json + "\n");
+        console.error(`[Tournament] Report written to ${args.out}`);
+    } else {
+        console.log(json);
+    }
+}
+
+main();
@@ -0,0 +1,34 @@
+// bench/tournamentWorker.js
+// worker_threads side of bench/tournament.js: plays the games it is sent, one at a time,
+// with both engine configurations set up once (workerData: { engines, maxPlies, tablebases,
+// record }). Recorded positions come back as tuning records (bench/tuningData.js).
+import { parentPort, workerData } from 'node:worker_threads';
+import { readFileSync } from 'node:fs';
+import { join } from 'node:path';
+import { registerTablebasePack, TABLEBASE_PACK_FILE } from '../js/tablebase.js';
+import { createEngine, playGame } from './selfPlay.js';
+import { encodeTuningRecords } from './tuningData.js';
+
+/** Registers the endgame tables packed in `<dir>/tables.bin` (what the page hands its workers). */
+function loadTablebaseFiles(dir) {
+    const data = readFileSync(join(dir, TABLEBASE_PACK_FILE));
+    return registerTablebasePack(data.buffer.slice(data.byteOffset, data.byteOffset + data.byteLength));
+}
+
+const { engines: engineConfigs, maxPlies, tablebases, record } = workerData;
+console.log = () => {}; // The search's progress lines would flood the runner's output
+if (tablebases) loadTablebaseFiles(tablebases);
+const engines = engineConfigs.map(createEngine);
+
+// { gameIndex, opening, firstEngine }: engine `firstEngine` plays Player 0
+parentPort.on('message', ({ gameIndex, opening, firstEngine }) => {
+    try {
+        const seating = firstEngine === 0 ? [engines[0], engines[1]] : [engines[1], engines[0]];
+        const { positions, ...result } = playGame(opening, seating, { maxPlies, record });
+        const records = positions ? encodeTuningRecords(positions, result.winner) : null;
+        parentPort.postMessage({ gameIndex, firstEngine, ...result, records }, records ? [records] : []);
+    } catch (error) {
+        console.error(`[Tournament] Game ${gameIndex} failed:`, error);
+        parentPort.postMessage({ gameIndex, firstEngine, error: error.message || "Game failed" });
+    }
+});
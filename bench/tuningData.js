@@ -0,0 +1,122 @@
+// bench/tuningData.js
+// Binary format of the positions recorded by the self-play runner (bench/tournament.js
+// --record) for evaluation tuning (tools/tuneEval.js). A file is an 8-byte header
+// followed by fixed-size records, so runs can append to it and readers can stream it:
+//   header: "JCTD", u16 version, u16 record size (little-endian)
+//   record (64 bytes): the 63 piece codes of Position.squares, then one byte with the
+//     side to move in bit 0 and the game's result for that side in bits 1-2
+//     (0 = loss, 1 = draw, 2 = win).
+
+import { openSync, closeSync, readSync, writeSync, fstatSync } from 'node:fs';
+import { NUM_SQUARES } from '../js/position.js';
+import { Player } from '../js/constants.js';
+
+const MAGIC = 0x4454434A; // "JCTD" read as a little-endian u32
+const VERSION = 1;
+export const TUNING_HEADER_BYTES = 8;
+export const TUNING_RECORD_BYTES = NUM_SQUARES + 1;
+
+export const RESULT_LOSS = 0;
+export const RESULT_DRAW = 1;
+export const RESULT_WIN = 2;
+
+const READ_CHUNK_RECORDS = 16384;
+
+/**
+ * Packs positions of one finished game into records.
+ * @param {Array<{squares: Uint8Array, sideToMove: number}>} positions
+ * @param {number} winner - Player.PLAYER0, Player.PLAYER1 or Player.NONE (draw).
+ * @returns {ArrayBuffer}
+ */
+export function encodeTuningRecords(positions, winner) {
+    const bytes = new Uint8Array(positions.length * TUNING_RECORD_BYTES);
+    positions.forEach(({ squares, sideToMove }, i) => {
+        const offset = i * TUNING_RECORD_BYTES;
+        bytes.set(squares.subarray(0, NUM_SQUARES), offset);
+        const result = winner === Player.NONE ? RESULT_DRAW : winner === sideToMove ? RESULT_WIN : RESULT_LOSS;
+        bytes[offset + NUM_SQUARES] = sideToMove | (result << 1);
+    });
+    return bytes.buffer;
+}
+
+/** Side to move and result (RESULT_*) of record `index` in `bytes`. */
+export function decodeTuningRecord(bytes, index) {
+    const flags = bytes[index * TUNING_RECORD_BYTES + NUM_SQUARES];
+    return {
+        squares: bytes.subarray(index * TUNING_RECORD_BYTES, index * TUNING_RECORD_BYTES + NUM_SQUARES),
+        sideToMove: flags & 1,
+        result: (flags >> 1) & 3
+    };
+}
+
+function writeHeader(fd) {
+    const header = Buffer.alloc(TUNING_HEADER_BYTES);
+    header.writeUInt32LE(MAGIC, 0);
+    header.writeUInt16LE(VERSION, 4);
+    header.writeUInt16LE(TUNING_RECORD_BYTES, 6);
+    writeSync(fd, header);
+}
+
+function checkHeader(fd, path) {
+    const header = Buffer.alloc(TUNING_HEADER_BYTES);
+    if (readSync(fd, header, 0, TUNING_HEADER_BYTES, 0) !== TUNING_HEADER_BYTES ||
+        header.readUInt32LE(0) !== MAGIC || header.readUInt16LE(4) !== VERSION ||
+        header.readUInt16LE(6) !== TUNING_RECORD_BYTES) {
+        throw new Error(`${path} is not a tuning data file`);
+    }
+}
+
+/** Appends records to a data file, creating it (with its header) if needed. */
+export class TuningDataWriter {
+    constructor(path) {
+        this.path = path;
+        this.fd = openSync(path, 'a+');
+        if (fstatSync(this.fd).size === 0) writeHeader(this.fd);
+        else checkHeader(this.fd, path);
+        this.records = 0;
+    }
+
+    /** @param {ArrayBuffer} buffer - Records from encodeTuningRecords. */
+    append(buffer) {
+        writeSync(this.fd, new Uint8Array(buffer));
+        this.records += buffer.byteLength / TUNING_RECORD_BYTES;
+    }
+
+    close() {
+        closeSync(this.fd);
+    }
+}
+
+/** Number of records in a data file (a partly written last record is ignored). */
+export function countTuningRecords(path) {
+    const fd = openSync(path, 'r');
+    try {
+        checkHeader(fd, path);
+        return Math.floor((fstatSync(fd).size - TUNING_HEADER_BYTES) / TUNING_RECORD_BYTES);
+    } finally {
+        closeSync(fd);
+    }
+}
+
+/**
+ * Streams the records of a data file into `target` (for example a view of shared memory),
+ * chunk by chunk, starting at record `targetIndex`.
+ * @returns {number} Records read.
+ */
+export function readTuningRecords(path, target, targetIndex = 0, maxRecords = Infinity) {
+    const fd = openSync(path, 'r');
+    try {
+        checkHeader(fd, path);
+        const available = Math.floor((fstatSync(fd).size - TUNING_HEADER_BYTES) / TUNING_RECORD_BYTES);
+        const total = Math.min(available, maxRecords, target.length / TUNING_RECORD_BYTES - targetIndex);
+        for (let done = 0; done < total; ) {
+            const count = Math.min(READ_CHUNK_RECORDS, total - done);
+            readSync(fd, target, (targetIndex + done) * TUNING_RECORD_BYTES, count * TUNING_RECORD_BYTES,
+                     TUNING_HEADER_BYTES + done * TUNING_RECORD_BYTES);
+            done += count;
+        }
+        return total;
+    } finally {
+        closeSync(fd);
+    }
+}
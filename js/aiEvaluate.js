@@ -14,13 +14,22 @@ import {
   isRiver
 } from './rules.js';     // Adjust path if needed (e.g., ../rules.js)
 
+import {
+  EMPTY, NUM_SQUARES, NUM_PIECE_CODES, MAX_GAME_PLY, TERRAIN_TABLE, CODE_VALUE,
+  TYPE_RAT, TYPE_TIGER, TYPE_LION, TYPE_ELEPHANT,
+  NEIGHBORS, JUMPS_AT, JUMP_COUNT, JUMP_ORIGIN, JUMP_LANDING, JUMP_PATH, JUMP_PATH_LENGTH, JUMP_LION_ONLY, MAX_JUMP_PATH,
+  toSquare, codeType, codePlayer
+} from './position.js';
+import { getEffectiveRankPacked, canCapturePacked, getPositionStatus, jumpPathClear } from './moveGen.js';
+
 // --- Evaluation Constants (Specific to this module) ---
 // Exported so other modules (like search for early exit) can use them
 export const WIN_SCORE = 20000;
 export const LOSE_SCORE = -20000;
 export const DRAW_SCORE = 0;
 // --- Evaluation Parameters & Weights (Centralized Tuning Hub) ---
-const EVAL_PARAMS = {
+// Frozen: change weights through setEvalParams so the compiled tables are rebuilt.
+let EVAL_PARAMS = freezeEvalParams({
   HEURISTIC_WEIGHTS: { // Core weights for different factors
       MATERIAL: 1.0,        // Basic piece values
       ADVANCEMENT: 0.2,    // Encourages moving pieces forward
@@ -43,7 +52,7 @@ const EVAL_PARAMS = {
   ADJACENT_THREAT_DIVISOR: 4.0,           // How much less valuable adjacent threat is vs direct capture threat
   RAT_ELEPHANT_PROXIMITY_THRESHOLD: 2,    // Max distance for Rat/Elephant interaction bonus
   RAT_ELEPHANT_PROXIMITY_BONUS_FACTOR: 3.0 // Multiplier for Rat/Elephant proximity bonus
-};
+});
 
 // Define strategic key squares (adjust based on strategy!)
 // Format: 'row-col'
@@ -158,13 +167,21 @@ const calculateAttackThreat = (attackerPlayer, defenderPlayer, piecesByPlayer, c
 // --- Main Evaluation Function (Exported) ---
 
 /**
-* Evaluates the board state from the AI's perspective (Player.PLAYER1).
-* Higher scores are better for the AI.
+* Evaluates the board state from the view of `sideToMove`: higher scores are better
+* for that player (the terms themselves are symmetric, so the score for the other
+* player is the negation).
 * RELIES ON IMPORTED constants.js and rules.js
 * @param {Array<Array<object>>} currentBoard - The board state to evaluate.
+* @param {number} [sideToMove=Player.PLAYER1] - Player whose view the score takes.
 * @returns {number} The evaluation score.
 */
-export function evaluateBoard(currentBoard) {
+export function evaluateBoard(currentBoard, sideToMove = Player.PLAYER1) {
+  const score = evaluateBoardForPlayer1(currentBoard);
+  return sideToMove === Player.PLAYER1 ? score : -score;
+}
+
+/** evaluateBoard from Player 1's view. */
+function evaluateBoardForPlayer1(currentBoard) {
   // 1. Check for Terminal State
   const status = getGameStatus(currentBoard);
   if (status === GameStatus.PLAYER1_WINS) return WIN_SCORE; // Use constant defined above
@@ -190,7 +207,8 @@ export function evaluateBoard(currentBoard) {
           const value = PIECES[pieceKey]?.value ?? 0; // Use imported PIECES
 
           // Store piece info with position for later use
-          piecesByPlayer[player].push({ ...piece, r, c, terrain: cell.terrain });
+          // (explicit fields: spreading the long-lived search pieces is far slower than a literal)
+          piecesByPlayer[player].push({ type: piece.type, name: piece.name, rank: piece.rank, player, r, c, terrain: cell.terrain });
 
           // Get reference to the correct score variable
           let scoreRef = (player === Player.PLAYER1) ? aiScore : playerScore;
@@ -279,4 +297,439 @@ export function evaluateBoard(currentBoard) {
 
   // 6. Final Score Calculation
   return aiScore - playerScore;
-}
\ No newline at end of file
+}
+
+// --- Packed Evaluation (AI engine hot path) ---
+
+// Many scores land exactly on .5; the epsilon keeps summation-order noise from
+// rounding the same position differently in evaluatePosition and IncrementalEvaluator
+const SCORE_ROUNDING_EPSILON = 1e-6;
+
+/** Rounds a raw evaluation to the integer score used by the search and its transposition table. */
+export function roundScore(score) {
+  return Math.floor(score + 0.5 + SCORE_ROUNDING_EPSILON);
+}
+
+// Key squares as per-player lookup tables over square indices
+const KEY_SQUARE_TABLE = [new Uint8Array(NUM_SQUARES), new Uint8Array(NUM_SQUARES)];
+for (const [player, keySquares] of [[Player.PLAYER0, keySquaresPlayer0], [Player.PLAYER1, keySquaresPlayer1]]) {
+  for (const key of keySquares) {
+      const [r, c] = key.split('-').map(Number);
+      KEY_SQUARE_TABLE[player][toSquare(r, c)] = 1;
+  }
+}
+
+// --- Compiled Evaluation Tables ---
+// The per-piece terms depend only on piece code and square. They are compiled from
+// EVAL_PARAMS into flat tables (index code * NUM_SQUARES + sq) when the module loads
+// and again whenever setEvalParams changes the weights; the threat scale factors
+// are compiled alongside them.
+
+const PIECE_SQUARE_TABLE = new Float64Array(NUM_PIECE_CODES * NUM_SQUARES);        // Owner's perspective
+const SIGNED_PIECE_SQUARE_TABLE = new Float64Array(NUM_PIECE_CODES * NUM_SQUARES); // AI's perspective (Player 1 positive)
+let threatCaptureFactor = 0;  // Per unit of target value, when the attacker can capture
+let threatAdjacentFactor = 0; // Per unit of target value, when it is only adjacent
+let jumpThreatFactor = 0;     // Per unit of target value, for a river jump capture
+
+/**
+* Per-piece terms a) - f) of evaluatePosition for one piece, from its owner's perspective.
+* Only used to compile PIECE_SQUARE_TABLE.
+*/
+function pieceSquareScore(code, sq) {
+  const weights = EVAL_PARAMS.HEURISTIC_WEIGHTS;
+  const defenseRowThreshold = EVAL_PARAMS.DEFENSE_PENALTY_START_ROW_OFFSET;
+  const halfRow = Math.floor(BOARD_ROWS / 2);
+  const player = codePlayer(code);
+  const value = CODE_VALUE[code];
+  const r = (sq / BOARD_COLS) | 0;
+  const c = sq - r * BOARD_COLS;
+
+  let score = value * weights.MATERIAL;
+  const advancement = (player === Player.PLAYER1) ? r : (BOARD_ROWS - 1 - r);
+  score += advancement * weights.ADVANCEMENT * (value / EVAL_PARAMS.ADVANCEMENT_VALUE_SCALE_DIVISOR);
+  if (codeType(code) !== TYPE_RAT) {
+      if (player === Player.PLAYER1 && r < defenseRowThreshold) {
+          score += (r - defenseRowThreshold) * weights.DEFENSE_PENALTY * (value / EVAL_PARAMS.GENERAL_VALUE_SCALE_DIVISOR);
+      }
+      if (player === Player.PLAYER0 && r > (BOARD_ROWS - 1 - defenseRowThreshold)) {
+          score += ((BOARD_ROWS - 1 - r) - defenseRowThreshold) * weights.DEFENSE_PENALTY * (value / EVAL_PARAMS.GENERAL_VALUE_SCALE_DIVISOR);
+      }
+  }
+  if (getEffectiveRankPacked(code, sq) === 0) {
+      score += weights.TRAPPED_PENALTY * (value / EVAL_PARAMS.GENERAL_VALUE_SCALE_DIVISOR);
+  }
+  if (KEY_SQUARE_TABLE[player][sq]) {
+      score += weights.KEY_SQUARE * (value / EVAL_PARAMS.GENERAL_VALUE_SCALE_DIVISOR);
+  }
+  const denRow = (player === Player.PLAYER1) ? PLAYER0_DEN_ROW : PLAYER1_DEN_ROW;
+  const denCol = (player === Player.PLAYER1) ? PLAYER0_DEN_COL : PLAYER1_DEN_COL;
+  const dist = Math.abs(r - denRow) + Math.abs(c - denCol);
+  const pastHalf = (player === Player.PLAYER1) ? r >= halfRow : r <= halfRow;
+  const advancementFactor = pastHalf ? 1.0 : EVAL_PARAMS.DEN_PROXIMITY_ADV_FACTOR_THRESHOLD;
+  score += Math.max(0, EVAL_PARAMS.DEN_PROXIMITY_MAX_DISTANCE - dist) * weights.DEN_PROXIMITY * (value / EVAL_PARAMS.DEN_PROXIMITY_VALUE_SCALE_DIVISOR) * advancementFactor;
+  return score;
+}
+
+/** Rebuilds the piece-square tables and threat factors from the current EVAL_PARAMS. */
+function compileEvalTables() {
+  for (let code = 1; code < NUM_PIECE_CODES; code++) {
+      for (let sq = 0; sq < NUM_SQUARES; sq++) {
+          const score = pieceSquareScore(code, sq);
+          PIECE_SQUARE_TABLE[code * NUM_SQUARES + sq] = score;
+          SIGNED_PIECE_SQUARE_TABLE[code * NUM_SQUARES + sq] = codePlayer(code) === Player.PLAYER1 ? score : -score;
+      }
+  }
+  const weights = EVAL_PARAMS.HEURISTIC_WEIGHTS;
+  threatCaptureFactor = weights.ATTACK_THREAT / EVAL_PARAMS.THREAT_VALUE_SCALE_DIVISOR;
+  threatAdjacentFactor = (weights.ATTACK_THREAT / EVAL_PARAMS.ADJACENT_THREAT_DIVISOR) / EVAL_PARAMS.THREAT_VALUE_SCALE_DIVISOR;
+  jumpThreatFactor = weights.JUMP_THREAT / EVAL_PARAMS.THREAT_VALUE_SCALE_DIVISOR;
+}
+compileEvalTables();
+
+/**
+* The compiled tables and threat factors of the current EVAL_PARAMS, for evaluators
+* outside this module (wasmEvaluate.js). The table is rebuilt in place by setEvalParams;
+* the factors are a snapshot, so take them again after changing the parameters.
+*/
+export function getCompiledEvalTables() {
+  return { signedPieceSquareTable: SIGNED_PIECE_SQUARE_TABLE, threatCaptureFactor, threatAdjacentFactor, jumpThreatFactor };
+}
+
+/** Deep-freezes a parameter object so stray edits cannot bypass the compiled tables. */
+function freezeEvalParams(params) {
+  Object.freeze(params.HEURISTIC_WEIGHTS);
+  return Object.freeze(params);
+}
+
+/** Returns the active (frozen) evaluation parameters. */
+export function getEvalParams() {
+  return EVAL_PARAMS;
+}
+
+/**
+* Replaces evaluation parameters and recompiles the evaluation tables.
+* Unspecified parameters (and weights) keep their current values. Incremental
+* evaluators must be reset afterwards.
+* @param {object} params - Partial EVAL_PARAMS, e.g. { HEURISTIC_WEIGHTS: { MATERIAL: 1.1 } }.
+*/
+export function setEvalParams(params) {
+  EVAL_PARAMS = freezeEvalParams({
+      ...EVAL_PARAMS,
+      ...params,
+      HEURISTIC_WEIGHTS: { ...EVAL_PARAMS.HEURISTIC_WEIGHTS, ...(params.HEURISTIC_WEIGHTS || {}) }
+  });
+  compileEvalTables();
+}
+
+// Tuned weights (tools/tuneEval.js), loaded by the AI worker and the page when present
+export const EVAL_WEIGHTS_URL = new URL('../assets/eval/weights.json', import.meta.url);
+
+/**
+* Fetches evaluation parameters (a partial EVAL_PARAMS as JSON, such as the weights
+* written by tools/tuneEval.js) and applies them with setEvalParams.
+* @param {URL|string} url - Location of the JSON file.
+* @returns {Promise<boolean>} Whether they were applied; otherwise the built-in parameters stay.
+*/
+export async function loadEvalParams(url) {
+  try {
+      const response = await fetch(url);
+      if (!response.ok) throw new Error(`HTTP ${response.status}`);
+      const params = await response.json();
+      const weights = params?.HEURISTIC_WEIGHTS || {};
+      for (const name in weights) {
+          if (!(name in EVAL_PARAMS.HEURISTIC_WEIGHTS) || !Number.isFinite(weights[name])) {
+              throw new Error(`invalid weight ${name}`);
+          }
+      }
+      setEvalParams(params);
+      console.log(`[Eval] Loaded evaluation weights from ${url}.`);
+      return true;
+  } catch (e) {
+      console.log(`[Eval] Built-in evaluation weights (${e.message}).`);
+      return false;
+  }
+}
+
+
+/**
+* Value of a defender piece threatened by river jump j of the piece attCode.
+* Packed equivalent of checkJumpThreat.
+*/
+function jumpThreatPacked(squares, attCode, j, defenderPlayer) {
+  if (!jumpPathClear(squares, j)) return 0; // Path blocked by a Rat
+  const targetSq = JUMP_LANDING[j];
+  const targetCode = squares[targetSq];
+  if (targetCode !== EMPTY && codePlayer(targetCode) === defenderPlayer &&
+      canCapturePacked(attCode, targetCode, JUMP_ORIGIN[j], targetSq)) {
+      return CODE_VALUE[targetCode];
+  }
+  return 0;
+}
+
+/**
+* Packed equivalent of calculateAttackThreat.
+*/
+function attackThreatPacked(pos, attackerPlayer, defenderPlayer) {
+  const squares = pos.squares;
+  let threatBonus = 0;
+  let jumpThreatBonus = 0;
+
+  const n = pos.pieceCount[attackerPlayer];
+  for (let i = 0; i < n; i++) {
+      const sq = pos.pieceSquare(attackerPlayer, i);
+      const code = squares[sq];
+
+      // --- Regular orthogonal threats (up, down, left, right) ---
+      for (let d = sq * 4; d < sq * 4 + 4; d++) {
+          const target = NEIGHBORS[d];
+          if (target < 0) continue;
+          const targetCode = squares[target];
+          if (targetCode !== EMPTY && codePlayer(targetCode) === defenderPlayer) {
+              const targetValue = CODE_VALUE[targetCode];
+              threatBonus += targetValue * (canCapturePacked(code, targetCode, sq, target) ? threatCaptureFactor : threatAdjacentFactor);
+          }
+      }
+
+      // --- Jump Threats (Lion, Tiger) ---
+      const type = codeType(code);
+      if (type === TYPE_LION || type === TYPE_TIGER) {
+          for (let j = JUMPS_AT[sq]; j < JUMPS_AT[sq + 1]; j++) {
+              if (JUMP_LION_ONLY[j] && type !== TYPE_LION) continue;
+              jumpThreatBonus += jumpThreatPacked(squares, code, j, defenderPlayer);
+          }
+      }
+  }
+  return threatBonus + jumpThreatBonus * jumpThreatFactor;
+}
+
+/** Square of the first piece of a given type owned by player, or -1. */
+function findPieceSquare(pos, player, type) {
+  const n = pos.pieceCount[player];
+  for (let i = 0; i < n; i++) {
+      const sq = pos.pieceSquare(player, i);
+      if (codeType(pos.squares[sq]) === type) return sq;
+  }
+  return -1;
+}
+
+/** Rat vs Elephant proximity bonus for a Rat on land near the enemy Elephant. */
+function ratElephantBonus(ratSq, elephantSq) {
+  if (ratSq < 0 || elephantSq < 0 || TERRAIN_TABLE[ratSq] === TERRAIN_WATER) return 0;
+  const threshold = EVAL_PARAMS.RAT_ELEPHANT_PROXIMITY_THRESHOLD;
+  const dist = Math.abs(((ratSq / BOARD_COLS) | 0) - ((elephantSq / BOARD_COLS) | 0)) +
+               Math.abs((ratSq % BOARD_COLS) - (elephantSq % BOARD_COLS));
+  return dist <= threshold ? (threshold + 1 - dist) * EVAL_PARAMS.RAT_ELEPHANT_PROXIMITY_BONUS_FACTOR : 0;
+}
+
+/** Both Rat vs Elephant proximity bonuses, from Player 1's view. */
+export function ratElephantScore(pos) {
+  return ratElephantBonus(findPieceSquare(pos, Player.PLAYER1, TYPE_RAT), findPieceSquare(pos, Player.PLAYER0, TYPE_ELEPHANT)) -
+         ratElephantBonus(findPieceSquare(pos, Player.PLAYER0, TYPE_RAT), findPieceSquare(pos, Player.PLAYER1, TYPE_ELEPHANT));
+}
+
+/**
+* Evaluates a packed Position from the view of its side to move (the negamax
+* convention of the search).
+* Same terms and weights as evaluateBoard, without any allocation.
+* @param {Position} pos - The position to evaluate.
+* @returns {number} The evaluation score, rounded to an integer for the transposition table.
+*/
+export function evaluatePosition(pos) {
+  const score = evaluatePositionForPlayer1(pos);
+  return pos.sideToMove === Player.PLAYER1 ? score : -score;
+}
+
+/** evaluatePosition from Player 1's view. */
+function evaluatePositionForPlayer1(pos) {
+  // 1. Check for Terminal State
+  const status = getPositionStatus(pos);
+  if (status === GameStatus.PLAYER1_WINS) return WIN_SCORE;
+  if (status === GameStatus.PLAYER0_WINS) return LOSE_SCORE;
+  if (status === GameStatus.DRAW) return 0;
+
+  const squares = pos.squares;
+  let aiScore = 0;
+  let playerScore = 0;
+
+  // 2. Per-piece heuristics (material, advancement, defense, trap, key squares, den proximity)
+  for (let player = Player.PLAYER0; player <= Player.PLAYER1; player++) {
+      const n = pos.pieceCount[player];
+      let score = 0;
+      for (let i = 0; i < n; i++) {
+          const sq = pos.pieceSquare(player, i);
+          score += PIECE_SQUARE_TABLE[squares[sq] * NUM_SQUARES + sq];
+      }
+      if (player === Player.PLAYER1) aiScore = score; else playerScore = score;
+  }
+
+  // 3. Attack Threat Bonus
+  aiScore += attackThreatPacked(pos, Player.PLAYER1, Player.PLAYER0);
+  playerScore += attackThreatPacked(pos, Player.PLAYER0, Player.PLAYER1);
+
+  // 4. Rat vs Elephant proximity
+  aiScore += ratElephantBonus(findPieceSquare(pos, Player.PLAYER1, TYPE_RAT), findPieceSquare(pos, Player.PLAYER0, TYPE_ELEPHANT));
+  playerScore += ratElephantBonus(findPieceSquare(pos, Player.PLAYER0, TYPE_RAT), findPieceSquare(pos, Player.PLAYER1, TYPE_ELEPHANT));
+
+  return roundScore(aiScore - playerScore);
+}
+
+// --- Incremental Evaluation (search hot path) ---
+// The per-piece terms (material, advancement, defense, trap, key squares, den
+// proximity) come from SIGNED_PIECE_SQUARE_TABLE, so their sum is updated on
+// make/unmake from the squares a move touches. The threat terms are sums over
+// attacker/target relations (adjacent pairs and river jumps); only the relations
+// touching the move's squares are recomputed. evaluatePosition (and evaluateBoard)
+// remain the reference implementations used to cross-check this evaluator.
+
+// JUMP_TOUCHES[j * NUM_SQUARES + sq] = 1 if sq is jump j's origin, landing or a crossed square;
+// the jumps touching sq are JUMPS_TOUCHING[JUMPS_TOUCHING_AT[sq] .. JUMPS_TOUCHING_AT[sq + 1] - 1]
+const JUMP_TOUCHES = new Uint8Array(JUMP_COUNT * NUM_SQUARES);
+for (let j = 0; j < JUMP_COUNT; j++) {
+  JUMP_TOUCHES[j * NUM_SQUARES + JUMP_ORIGIN[j]] = 1;
+  JUMP_TOUCHES[j * NUM_SQUARES + JUMP_LANDING[j]] = 1;
+  for (let k = 0; k < JUMP_PATH_LENGTH[j]; k++) JUMP_TOUCHES[j * NUM_SQUARES + JUMP_PATH[j * MAX_JUMP_PATH + k]] = 1;
+}
+const JUMPS_TOUCHING_AT = new Uint16Array(NUM_SQUARES + 1);
+const jumpsTouching = [];
+for (let sq = 0; sq < NUM_SQUARES; sq++) {
+  JUMPS_TOUCHING_AT[sq] = jumpsTouching.length;
+  for (let j = 0; j < JUMP_COUNT; j++) {
+      if (JUMP_TOUCHES[j * NUM_SQUARES + sq]) jumpsTouching.push(j);
+  }
+}
+JUMPS_TOUCHING_AT[NUM_SQUARES] = jumpsTouching.length;
+const JUMPS_TOUCHING = Uint8Array.from(jumpsTouching);
+
+/** Signed threat of the piece on att against an adjacent piece on def (0 if none). */
+function adjacentThreatScore(squares, att, def) {
+  const attCode = squares[att];
+  const defCode = squares[def];
+  if (attCode === EMPTY || defCode === EMPTY || codePlayer(attCode) === codePlayer(defCode)) return 0;
+  const score = CODE_VALUE[defCode] * (canCapturePacked(attCode, defCode, att, def) ? threatCaptureFactor : threatAdjacentFactor);
+  return codePlayer(attCode) === Player.PLAYER1 ? score : -score;
+}
+
+/** Signed threat along river jump j (0 if no Lion/Tiger can capture along it). */
+function jumpLineThreatScore(squares, j) {
+  const attCode = squares[JUMP_ORIGIN[j]];
+  if (attCode === EMPTY) return 0;
+  const type = codeType(attCode);
+  if (type !== TYPE_LION && (JUMP_LION_ONLY[j] || type !== TYPE_TIGER)) return 0;
+  const attacker = codePlayer(attCode);
+  const value = jumpThreatPacked(squares, attCode, j, attacker ^ 1);
+  if (value === 0) return 0;
+  const score = value * jumpThreatFactor;
+  return attacker === Player.PLAYER1 ? score : -score;
+}
+
+/** Sum of adjacentThreatScore over both directions of every pair involving sq, skipping pairs with `exclude`. */
+function adjacentThreatsAround(squares, sq, exclude) {
+  if (squares[sq] === EMPTY) return 0; // Every pair needs a piece on both squares
+  let total = 0;
+  for (let d = sq * 4; d < sq * 4 + 4; d++) {
+      const n = NEIGHBORS[d];
+      if (n >= 0 && n !== exclude) total += adjacentThreatScore(squares, sq, n) + adjacentThreatScore(squares, n, sq);
+  }
+  return total;
+}
+
+/** Signed threat score of every relation (adjacent pair or jump line) that involves square a or b. */
+function threatsTouching(squares, a, b) {
+  let total = adjacentThreatsAround(squares, a, -1) + adjacentThreatsAround(squares, b, a);
+  for (let i = JUMPS_TOUCHING_AT[a]; i < JUMPS_TOUCHING_AT[a + 1]; i++) {
+      total += jumpLineThreatScore(squares, JUMPS_TOUCHING[i]);
+  }
+  for (let i = JUMPS_TOUCHING_AT[b]; i < JUMPS_TOUCHING_AT[b + 1]; i++) {
+      const j = JUMPS_TOUCHING[i];
+      if (!JUMP_TOUCHES[j * NUM_SQUARES + a]) total += jumpLineThreatScore(squares, j); // Not counted for a
+  }
+  return total;
+}
+
+export class IncrementalEvaluator {
+  constructor() {
+      this.pieceSquareTotal = 0; // Sum of signed per-piece terms
+      this.threatTotal = 0;      // Signed attack + jump threat terms
+      this.pieceSquareStack = new Float64Array(MAX_GAME_PLY);
+      this.threatStack = new Float64Array(MAX_GAME_PLY);
+  }
+
+  /** Computes every term from scratch for a position (call before searching it). */
+  reset(pos) {
+      const squares = pos.squares;
+      let pieceSquareTotal = 0;
+      let threatTotal = 0;
+      for (let player = Player.PLAYER0; player <= Player.PLAYER1; player++) {
+          const n = pos.pieceCount[player];
+          for (let i = 0; i < n; i++) {
+              const sq = pos.pieceSquare(player, i);
+              pieceSquareTotal += SIGNED_PIECE_SQUARE_TABLE[squares[sq] * NUM_SQUARES + sq];
+              // Each ordered adjacent pair once: the piece on sq attacking its neighbours
+              for (let d = sq * 4; d < sq * 4 + 4; d++) {
+                  if (NEIGHBORS[d] >= 0) threatTotal += adjacentThreatScore(squares, sq, NEIGHBORS[d]);
+              }
+          }
+      }
+      for (let j = 0; j < JUMP_COUNT; j++) threatTotal += jumpLineThreatScore(squares, j);
+      this.pieceSquareTotal = pieceSquareTotal;
+      this.threatTotal = threatTotal;
+  }
+
+  /** Plays a move on pos (pos.makeMove) and updates the evaluation terms. */
+  makeMove(pos, move) {
+      const squares = pos.squares;
+      const from = move & 63;
+      const to = (move >> 6) & 63;
+      const code = squares[from];
+      const captured = squares[to];
+      const ply = pos.ply;
+      this.pieceSquareStack[ply] = this.pieceSquareTotal;
+      this.threatStack[ply] = this.threatTotal;
+
+      let pieceSquareDelta = SIGNED_PIECE_SQUARE_TABLE[code * NUM_SQUARES + to] - SIGNED_PIECE_SQUARE_TABLE[code * NUM_SQUARES + from];
+      if (captured !== EMPTY) pieceSquareDelta -= SIGNED_PIECE_SQUARE_TABLE[captured * NUM_SQUARES + to];
+      const threatsBefore = threatsTouching(squares, from, to);
+
+      pos.makeMove(move);
+
+      this.pieceSquareTotal += pieceSquareDelta;
+      this.threatTotal += threatsTouching(squares, from, to) - threatsBefore;
+  }
+
+  /** Takes back a move (pos.unmakeMove) and restores the evaluation terms. */
+  unmakeMove(pos, move) {
+      pos.unmakeMove(move);
+      this.pieceSquareTotal = this.pieceSquareStack[pos.ply];
+      this.threatTotal = this.threatStack[pos.ply];
+  }
+
+  /** Passes the turn (pos.makeNullMove); the evaluation terms do not change. */
+  makeNullMove(pos) {
+      this.pieceSquareStack[pos.ply] = this.pieceSquareTotal;
+      this.threatStack[pos.ply] = this.threatTotal;
+      pos.makeNullMove();
+  }
+
+  /** Takes back a null move (pos.unmakeNullMove). */
+  unmakeNullMove(pos) {
+      pos.unmakeNullMove();
+  }
+
+  /**
+  * Evaluates pos from the view of its side to move; same result as evaluatePosition(pos)
+  * provided every move since reset() went through makeMove/unmakeMove.
+  * @returns {number} The evaluation score, rounded to an integer.
+  */
+  evaluate(pos) {
+      const status = getPositionStatus(pos);
+      if (status === GameStatus.DRAW) return 0;
+      if (status !== GameStatus.ONGOING) {
+          const winner = status === GameStatus.PLAYER1_WINS ? Player.PLAYER1 : Player.PLAYER0;
+          return winner === pos.sideToMove ? WIN_SCORE : LOSE_SCORE;
+      }
+
+      // The terms are summed from Player 1's view
+      const score = roundScore(this.pieceSquareTotal + this.threatTotal + ratElephantScore(pos));
+      return pos.sideToMove === Player.PLAYER1 ? score : -score;
+  }
+}
@@ -0,0 +1,322 @@
+// js/aiMessages.js
+// Binary messages between the main thread (aiSearchPool.js) and the AI workers.
+// A request or result is one ArrayBuffer, posted as a transferable, so neither side
+// structured-clones the nested board format and the worker gets the packed squares
+// position.js searches on.
+//
+// Request (little-endian):
+//   0  kind (uint8)           - REQUEST_SEARCH / REQUEST_PONDER / REQUEST_STOP_PONDER
+//   1  side to move (uint8)
+//   2  flags (uint8)          - REQUEST_FLAG_* below
+//   3  target depth (uint8)
+//   4  worker index (uint8)
+//   6  hash size in MB (uint16, 0 = keep the current table)
+//   8  search id (uint32)
+//   12 shared table generation (uint32)
+//   16 time limit in ms (float64; Infinity for none; the ponder time for REQUEST_PONDER)
+//   24 node limit (uint32, 0 = none)
+//   28 expected reply (uint16, encoded move; REQUEST_PONDER only)
+//   30 history length (uint16)
+//   32 squares (NUM_SQUARES piece codes, int8)
+//   96 repetition history: positions since the last capture, as 53-bit keys (float64 each)
+//
+// Result:
+//   0  flags (uint8)          - RESULT_FLAG_* below
+//   1  worker index (uint8)
+//   2  depth achieved (uint8)
+//   3  pv length (uint8)
+//   4  search id (uint32)
+//   8  nodes (float64)
+//   16 eval (float64, NaN for none)
+//   24 TT hit rate, TT fill (float32 each)
+//   32 tablebase hits (uint32)
+//   36 best move (uint32, packed move data, 0 for none)
+//   40 iteration count (uint16)
+//   42 error message length (uint16, UTF-8 bytes)
+//   44 cutoff rate, first-move cutoff rate (float32 each)
+//   52 search time in ms (float64)
+//   60 pv (uint32 packed move data each), then the iterations (ITERATION_BYTES each:
+//      time in ms, eval (float64); nodes, move, depth (uint32)), then the error message
+//
+// A progress report (RESULT_FLAG_PROGRESS), sent by the worker after a completed
+// iteration while it keeps searching, has the result layout without iterations: the
+// iteration's depth, eval, move and pv, the nodes and time so far, and the statistics
+// of the search so far.
+//
+// Packed move data is from | to << 6 | piece type << 12 (see position.js), which is
+// enough to rebuild the { pieceName, fromRow, fromCol, toRow, toCol } objects of the
+// search without the position they were played in.
+
+import { PIECES, getPieceKey } from './constants.js';
+import { NUM_SQUARES, PIECE_TYPES, toSquare, squareRow, squareCol, encodeMove } from './position.js';
+
+export const REQUEST_SEARCH = 1;
+export const REQUEST_PONDER = 2;
+export const REQUEST_STOP_PONDER = 3;
+
+const REQUEST_FLAG_NEW_GAME = 1;
+const REQUEST_FLAG_USE_BOOK = 2;
+const REQUEST_FLAG_NO_NULL_MOVE = 4;
+const REQUEST_FLAG_NO_LMR = 8;
+const REQUEST_FLAG_TIME_MANAGEMENT = 16;
+const REQUEST_FLAG_KEEP_PONDER = 32;
+
+const RESULT_FLAG_HAS_EVAL = 1;
+const RESULT_FLAG_BOOK_MOVE = 2;
+const RESULT_FLAG_PONDER_HIT = 4;
+const RESULT_FLAG_ERROR = 8;
+const RESULT_FLAG_PROGRESS = 16;
+
+const REQUEST_SQUARES_OFFSET = 32;
+const REQUEST_HISTORY_OFFSET = 96;
+const RESULT_PV_OFFSET = 60;
+const ITERATION_BYTES = 28;
+
+const textEncoder = new TextEncoder();
+const textDecoder = new TextDecoder();
+
+// --- Moves ---
+
+/** Packs a move data object ({ pieceName, fromRow, fromCol, toRow, toCol }); 0 for none. */
+export function packMoveData(moveData) {
+    if (!moveData) return 0;
+    const type = Math.max(0, PIECE_TYPES.indexOf(getPieceKey(moveData.pieceName)));
+    const move = encodeMove(toSquare(moveData.fromRow, moveData.fromCol), toSquare(moveData.toRow, moveData.toCol));
+    return (move | (type << 12)) >>> 0;
+}
+
+/** Inverse of packMoveData; null for 0. */
+export function unpackMoveData(packed) {
+    if (!packed) return null;
+    const from = packed & 63;
+    const to = (packed >> 6) & 63;
+    return {
+        pieceName: PIECES[PIECE_TYPES[(packed >> 12) & 7]].name,
+        fromRow: squareRow(from), fromCol: squareCol(from),
+        toRow: squareRow(to), toCol: squareCol(to)
+    };
+}
+
+// --- Requests ---
+
+/**
+ * Encodes a request for the worker.
+ * @param {number} kind - REQUEST_SEARCH, REQUEST_PONDER or REQUEST_STOP_PONDER.
+ * @param {object} request
+ * @param {ArrayLike<number>} request.squares - Piece code per square (Position.squares).
+ * @param {number} request.sideToMove
+ * @param {number} [request.targetDepth]
+ * @param {number} [request.timeLimit] - Search time, or the ponder time (REQUEST_PONDER).
+ * @param {number} [request.nodeLimit]
+ * @param {number[]} [request.gameHistory] - Repetition keys (see game.js getRepetitionHistory).
+ * @param {{nullMove?:boolean, lateMoveReductions?:boolean}} [request.pruning]
+ * @param {number} [request.hashSizeMb]
+ * @param {boolean} [request.newGame]
+ * @param {boolean} [request.useBook]
+ * @param {boolean} [request.timeManagement] - The time limit is a hard limit (see timeManager.js).
+ * @param {boolean} [request.keepPonder] - A search aside (a hint): pondering goes on after it.
+ * @param {number} [request.reply] - Expected reply to ponder on (encoded move).
+ * @param {number} [request.workerIndex]
+ * @param {number} [request.searchId]
+ * @param {number} [request.ttGeneration]
+ * @returns {ArrayBuffer}
+ */
+export function encodeRequest(kind, {
+    squares = null, sideToMove = 0, targetDepth = 0, timeLimit = 0, nodeLimit = 0, gameHistory = [],
+    pruning, hashSizeMb = 0, newGame = false, useBook = false, timeManagement = false, keepPonder = false, reply = 0,
+    workerIndex = 0, searchId = 0, ttGeneration = 0
+} = {}) {
+    const buffer = new ArrayBuffer(REQUEST_HISTORY_OFFSET + gameHistory.length * Float64Array.BYTES_PER_ELEMENT);
+    const view = new DataView(buffer);
+    let flags = 0;
+    if (newGame) flags |= REQUEST_FLAG_NEW_GAME;
+    if (useBook) flags |= REQUEST_FLAG_USE_BOOK;
+    if (timeManagement) flags |= REQUEST_FLAG_TIME_MANAGEMENT;
+    if (keepPonder) flags |= REQUEST_FLAG_KEEP_PONDER;
+    if (pruning?.nullMove === false) flags |= REQUEST_FLAG_NO_NULL_MOVE;
+    if (pruning?.lateMoveReductions === false) flags |= REQUEST_FLAG_NO_LMR;
+
+    view.setUint8(0, kind);
+    view.setUint8(1, sideToMove);
+    view.setUint8(2, flags);
+    view.setUint8(3, targetDepth);
+    view.setUint8(4, workerIndex);
+    view.setUint16(6, hashSizeMb || 0, true);
+    view.setUint32(8, searchId, true);
+    view.setUint32(12, ttGeneration, true);
+    view.setFloat64(16, timeLimit, true);
+    view.setUint32(24, nodeLimit > 0 ? Math.min(nodeLimit, 0xFFFFFFFF) : 0, true);
+    view.setUint16(28, reply, true);
+    view.setUint16(30, gameHistory.length, true);
+    if (squares) new Int8Array(buffer, REQUEST_SQUARES_OFFSET, NUM_SQUARES).set(squares);
+    gameHistory.forEach((key, i) => view.setFloat64(REQUEST_HISTORY_OFFSET + i * 8, key, true));
+    return buffer;
+}
+
+/**
+ * Decodes a request.
+ * @param {ArrayBuffer} buffer
+ * @returns {object} The fields of encodeRequest plus `kind`; `squares` is an Int8Array view.
+ * @throws {Error} If the buffer is too short for its history.
+ */
+export function decodeRequest(buffer) {
+    if (!(buffer instanceof ArrayBuffer) || buffer.byteLength < REQUEST_HISTORY_OFFSET) throw new Error("Malformed request");
+    const view = new DataView(buffer);
+    const flags = view.getUint8(2);
+    const historyLength = view.getUint16(30, true);
+    if (buffer.byteLength < REQUEST_HISTORY_OFFSET + historyLength * 8) throw new Error("Malformed request");
+    const gameHistory = new Array(historyLength);
+    for (let i = 0; i < historyLength; i++) gameHistory[i] = view.getFloat64(REQUEST_HISTORY_OFFSET + i * 8, true);
+    const hashSizeMb = view.getUint16(6, true);
+    return {
+        kind: view.getUint8(0),
+        sideToMove: view.getUint8(1),
+        targetDepth: view.getUint8(3),
+        workerIndex: view.getUint8(4),
+        hashSizeMb: hashSizeMb > 0 ? hashSizeMb : undefined,
+        searchId: view.getUint32(8, true),
+        ttGeneration: view.getUint32(12, true),
+        timeLimit: view.getFloat64(16, true),
+        nodeLimit: view.getUint32(24, true),
+        reply: view.getUint16(28, true),
+        squares: new Int8Array(buffer, REQUEST_SQUARES_OFFSET, NUM_SQUARES),
+        gameHistory,
+        pruning: { nullMove: !(flags & REQUEST_FLAG_NO_NULL_MOVE), lateMoveReductions: !(flags & REQUEST_FLAG_NO_LMR) },
+        newGame: (flags & REQUEST_FLAG_NEW_GAME) !== 0,
+        useBook: (flags & REQUEST_FLAG_USE_BOOK) !== 0,
+        timeManagement: (flags & REQUEST_FLAG_TIME_MANAGEMENT) !== 0,
+        keepPonder: (flags & REQUEST_FLAG_KEEP_PONDER) !== 0
+    };
+}
+
+/**
+ * Reads the workerIndex and searchId of a request that may not decode, so that the
+ * error answering it reaches the search that sent it.
+ * @returns {{ workerIndex: number, searchId: number }} Zeros where the header is missing.
+ */
+export function peekRequestIds(buffer) {
+    if (!(buffer instanceof ArrayBuffer) || buffer.byteLength < 12) return { workerIndex: 0, searchId: 0 };
+    const view = new DataView(buffer);
+    return { workerIndex: view.getUint8(4), searchId: view.getUint32(8, true) };
+}
+
+// --- Results ---
+
+/**
+ * Encodes a findBestMove result (plus workerIndex, searchId, bookMove, ponderHit), or a
+ * progress report ({ progress: true, ... }, see encodeProgress).
+ * Iterations keep their depth, time, nodes, eval and move; their PVs are dropped.
+ * @returns {ArrayBuffer}
+ */
+export function encodeResult(result) {
+    const pv = result.pv || [];
+    const iterations = result.iterations || [];
+    const error = result.error ? textEncoder.encode(String(result.error)).subarray(0, 0xFFFF) : null;
+    const pvLength = Math.min(pv.length, 255);
+    const iterationsOffset = RESULT_PV_OFFSET + pvLength * 4;
+    const errorOffset = iterationsOffset + iterations.length * ITERATION_BYTES;
+    const buffer = new ArrayBuffer(errorOffset + (error ? error.length : 0));
+    const view = new DataView(buffer);
+    const hasEval = typeof result.eval === 'number' && isFinite(result.eval);
+    let flags = 0;
+    if (hasEval) flags |= RESULT_FLAG_HAS_EVAL;
+    if (result.bookMove) flags |= RESULT_FLAG_BOOK_MOVE;
+    if (result.ponderHit) flags |= RESULT_FLAG_PONDER_HIT;
+    if (error) flags |= RESULT_FLAG_ERROR;
+    if (result.progress) flags |= RESULT_FLAG_PROGRESS;
+
+    view.setUint8(0, flags);
+    view.setUint8(1, result.workerIndex || 0);
+    view.setUint8(2, Math.min(result.depthAchieved || 0, 255));
+    view.setUint8(3, pvLength);
+    view.setUint32(4, result.searchId || 0, true);
+    view.setFloat64(8, result.nodes || 0, true);
+    view.setFloat64(16, hasEval ? result.eval : NaN, true);
+    view.setFloat32(24, result.ttHitRate || 0, true);
+    view.setFloat32(28, result.ttFill || 0, true);
+    view.setUint32(32, result.tablebaseHits || 0, true);
+    view.setUint32(36, packMoveData(result.move), true);
+    view.setUint16(40, iterations.length, true);
+    view.setUint16(42, error ? error.length : 0, true);
+    view.setFloat32(44, result.cutoffRate || 0, true);
+    view.setFloat32(48, result.firstMoveCutoffRate || 0, true);
+    view.setFloat64(52, result.timeMs || 0, true);
+    for (let i = 0; i < pvLength; i++) view.setUint32(RESULT_PV_OFFSET + i * 4, packMoveData(pv[i]), true);
+    iterations.forEach((it, i) => {
+        const offset = iterationsOffset + i * ITERATION_BYTES;
+        view.setFloat64(offset, it.timeMs, true);
+        view.setFloat64(offset + 8, it.eval, true);
+        view.setUint32(offset + 16, it.nodes, true);
+        view.setUint32(offset + 20, packMoveData(it.move), true);
+        view.setUint32(offset + 24, it.depth, true);
+    });
+    if (error) new Uint8Array(buffer, errorOffset).set(error);
+    return buffer;
+}
+
+/**
+ * Encodes a progress report from findBestMove's onIteration entry.
+ * @param {object} iteration - { depth, timeMs, nodes, eval, move, pv, ttHitRate, cutoffRate, firstMoveCutoffRate }.
+ * @param {number} workerIndex
+ * @param {number} searchId
+ * @returns {ArrayBuffer}
+ */
+export function encodeProgress(iteration, workerIndex, searchId) {
+    return encodeResult({
+        ...iteration,
+        depthAchieved: iteration.depth,
+        iterations: null,
+        progress: true,
+        workerIndex, searchId
+    });
+}
+
+/**
+ * Decodes a result into the findBestMove form ({ move, depthAchieved, nodes, eval, pv, ... });
+ * progress reports have `progress: true`.
+ * @param {ArrayBuffer} buffer
+ */
+export function decodeResult(buffer) {
+    const view = new DataView(buffer);
+    const flags = view.getUint8(0);
+    const pvLength = view.getUint8(3);
+    const iterationCount = view.getUint16(40, true);
+    const errorLength = view.getUint16(42, true);
+    const iterationsOffset = RESULT_PV_OFFSET + pvLength * 4;
+    const errorOffset = iterationsOffset + iterationCount * ITERATION_BYTES;
+
+    const pv = [];
+    for (let i = 0; i < pvLength; i++) pv.push(unpackMoveData(view.getUint32(RESULT_PV_OFFSET + i * 4, true)));
+    const iterations = [];
+    for (let i = 0; i < iterationCount; i++) {
+        const offset = iterationsOffset + i * ITERATION_BYTES;
+        iterations.push({
+            depth: view.getUint32(offset + 24, true),
+            timeMs: view.getFloat64(offset, true),
+            nodes: view.getUint32(offset + 16, true),
+            eval: view.getFloat64(offset + 8, true),
+            move: unpackMoveData(view.getUint32(offset + 20, true))
+        });
+    }
+    const result = {
+        move: unpackMoveData(view.getUint32(36, true)),
+        depthAchieved: view.getUint8(2),
+        nodes: view.getFloat64(8, true),
+        eval: flags & RESULT_FLAG_HAS_EVAL ? view.getFloat64(16, true) : null,
+        ttHitRate: view.getFloat32(24, true),
+        ttFill: view.getFloat32(28, true),
+        pv,
+        iterations,
+        tablebaseHits: view.getUint32(32, true),
+        cutoffRate: view.getFloat32(44, true),
+        firstMoveCutoffRate: view.getFloat32(48, true),
+        timeMs: view.getFloat64(52, true),
+        workerIndex: view.getUint8(1),
+        searchId: view.getUint32(4, true)
+    };
+    if (flags & RESULT_FLAG_BOOK_MOVE) result.bookMove = true;
+    if (flags & RESULT_FLAG_PONDER_HIT) result.ponderHit = true;
+    if (flags & RESULT_FLAG_PROGRESS) result.progress = true;
+    if (flags & RESULT_FLAG_ERROR) result.error = textDecoder.decode(new Uint8Array(buffer, errorOffset, errorLength));
+    return result;
+}
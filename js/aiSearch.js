@@ -0,0 +1,861 @@
+// js/aiSearch.js
+// The AI search itself: iterative deepening alpha-beta over a packed Position.
+// It has no worker or DOM dependencies, so the worker (aiWorker.js) and headless
+// tools (bench/) drive the same code.
+import { PLAYER0_DEN_ROW, PLAYER1_DEN_ROW, Player, PIECES, GameStatus } from './constants.js';
+import { IncrementalEvaluator, WIN_SCORE, LOSE_SCORE, DRAW_SCORE } from './aiEvaluate.js';
+import {
+    Position, EMPTY, NO_MOVE, PIECE_TYPES, CODE_VALUE, NEIGHBORS, PLAYER0_DEN_SQ, PLAYER1_DEN_SQ,
+    codeType, codePlayer, moveFrom, moveTo, squareRow, squareCol
+} from './position.js';
+import { generateMoves, getPositionStatus, isLegalMove, MAX_MOVES } from './moveGen.js';
+import { MovePicker } from './movePicker.js';
+import { MoveHistory } from './moveHistory.js';
+import { TimeManager } from './timeManager.js';
+import { probeTablebase, tablebasePieceLimit, TB_DRAW, TB_LOSS } from './tablebase.js';
+import {
+    TranspositionTable, TT_EXACT, TT_LOWERBOUND, TT_UPPERBOUND,
+    DEFAULT_TT_SIZE_MB, normalizeTableSizeMb
+} from './transpositionTable.js';
+
+
+// --- Constants ---
+
+// Killer Move constants
+const MAX_PLY_FOR_KILLERS = 20;
+
+// Search stack constants
+const MAX_SEARCH_PLY = 64; // Number of per-ply move pickers
+
+// Search limits: the clock and the stop flag are only read every TIME_CHECK_INTERVAL nodes
+const TIME_CHECK_INTERVAL = 1024; // Power of two
+const ABORTED_SCORE = 0; // Returned by an aborted alphaBeta call; callers discard it
+
+// Aspiration windows: iterations after the first search a window around the previous
+// score, widened by ASPIRATION_GROWTH on every fail until it is dropped altogether
+const ASPIRATION_WINDOW = 50;
+const ASPIRATION_GROWTH = 4;
+const MAX_ASPIRATION_WINDOW = 1000;
+const DECISIVE_SCORE = WIN_SCORE * 0.9; // Win/loss scores: searched with a full window
+
+// Null-move pruning: at non-PV nodes, pass the turn and search with a reduced depth;
+// if the side to move still beats its bound, a real move would too
+const NULL_MOVE_MIN_DEPTH = 4;
+const NULL_MOVE_REDUCTION = 2;
+const NULL_MOVE_MIN_PIECES = 3; // Zugzwang guard: with fewer pieces passing is too optimistic
+
+// Late-move reductions: at non-PV nodes, quiet moves ordered late are first searched
+// LMR_REDUCTION plies shallower, and again at full depth only if they beat the bound
+const LMR_MIN_DEPTH = 3;
+const LMR_FULL_DEPTH_MOVES = 3; // Moves searched at full depth before reductions start
+const LMR_REDUCTION = 1;
+
+// Forward pruning used when findBestMove is not given a `pruning` option
+export const DEFAULT_PRUNING = { nullMove: true, lateMoveReductions: true };
+
+// Endgame tablebase results: decisive, but below wins the search actually sees, and a
+// win at a lower ply (from the root) scores higher
+const TABLEBASE_WIN_SCORE = WIN_SCORE - 1000;
+
+// Repetition detection
+const MAX_GAME_HISTORY = 256; // Earlier game positions kept (the most recent ones)
+const REPETITION_DRAW_COUNT = 3; // Same rule as game.js: the third occurrence is a draw
+
+// --- Worker-Scoped State ---
+let aiRunCounter = 0; // Counter for nodes visited during a search
+const killerMoves = new Int32Array(MAX_PLY_FOR_KILLERS * 2); // Encoded killer moves, [ply * 2 + 0/1]
+// Kept across requests so later turns reuse earlier work; replaced only when the size changes
+// or when the controller hands over a shared table (parallel search, see aiSearchPool.js)
+let transpositionTable = new TranspositionTable(DEFAULT_TT_SIZE_MB);
+let stopSignal = null; // Int32Array on a SharedArrayBuffer; non-zero asks a parallel search to stop
+let searchDeadline = Infinity; // performance.now() value at which the current search stops
+let searchNodeLimit = 0; // Node budget of the current search (0 = none)
+let searchAborted = false; // Set once a limit is hit; every alphaBeta frame then returns at once
+let useNullMove = DEFAULT_PRUNING.nullMove; // Forward pruning of the current search
+let useLateMoveReductions = DEFAULT_PRUNING.lateMoveReductions;
+const nullMoveAtPly = new Uint8Array(MAX_SEARCH_PLY); // 1 while the move at ply is a null move
+let tablebasePieces = 0; // Piece count up to which the loaded tablebases are probed
+let tablebaseHits = 0; // Tablebase probes that answered a node in the current search
+// Move ordering statistics of the current search (alphaBeta nodes whose moves were searched)
+let expandedNodes = 0;
+let betaCutoffs = 0;
+let firstMoveCutoffs = 0; // Cutoffs by the first move searched: the ordering guessed right
+
+// Evaluation terms of the search position, updated on every make/unmake
+// (IncrementalEvaluator, or the WebAssembly one of wasmEvaluate.js once installed)
+let searchEvaluator = new IncrementalEvaluator();
+
+// History and countermove tables; kept across iterations and turns, cleared for a new game
+const moveHistory = new MoveHistory();
+
+// Reusable per-ply staged move generators (see movePicker.js)
+const movePickers = Array.from({ length: MAX_SEARCH_PLY }, () => new MovePicker(moveHistory));
+// Quiet moves searched so far at each ply (penalized in the history when another one cuts off)
+const triedQuiets = Array.from({ length: MAX_SEARCH_PLY }, () => new Int32Array(MAX_MOVES));
+// searchMoves[p] is the move that led to the node at ply p (NO_MOVE after a null move)
+const searchMoves = new Int32Array(MAX_SEARCH_PLY + 1);
+
+// Repetition stack: Zobrist keys (53-bit, as in game.js) of the game's earlier positions,
+// then the root at rootKeyIndex, then the search path (ply p at rootKeyIndex + 1 + p).
+// repetitionStart[i] is the first index since the last capture: positions before a
+// capture have more pieces and can never repeat after it.
+const repetitionKeys = new Float64Array(MAX_GAME_HISTORY + 1 + MAX_SEARCH_PLY);
+const repetitionStart = new Int16Array(MAX_GAME_HISTORY + 1 + MAX_SEARCH_PLY);
+let rootKeyIndex = 0;
+
+// Triangular principal variation table: row p holds the best line found from ply p
+const pvMoves = new Int32Array(MAX_SEARCH_PLY * MAX_SEARCH_PLY);
+const pvLength = new Uint8Array(MAX_SEARCH_PLY + 1);
+// Principal variation of the root (root move first)
+const rootPvMoves = new Int32Array(MAX_SEARCH_PLY + 1);
+let rootPvLength = 0;
+
+// --- Utility Functions ---
+
+/**
+ * Counts a node and checks the search limits. The node budget is exact; the
+ * clock and the stop flag are polled every TIME_CHECK_INTERVAL nodes.
+ * @returns {boolean} True if the search must stop.
+ */
+function countNodeAndCheckLimits() {
+    aiRunCounter++;
+    if (searchNodeLimit > 0 && aiRunCounter >= searchNodeLimit) {
+        searchAborted = true;
+    } else if ((aiRunCounter & (TIME_CHECK_INTERVAL - 1)) === 0) {
+        if (performance.now() > searchDeadline || (stopSignal !== null && Atomics.load(stopSignal, 0) !== 0)) {
+            searchAborted = true;
+        }
+    }
+    return searchAborted;
+}
+
+/**
+ * Loads the game history and the root into the repetition stack.
+ * @param {number[]} gameHistory - Keys of the positions before the root, oldest first,
+ *   with alternating sides to move (see findBestMove).
+ * @param {number} rootKey - Key of the root position.
+ */
+function resetRepetitionStack(gameHistory, rootKey) {
+    const count = Math.min(gameHistory.length, MAX_GAME_HISTORY);
+    const first = gameHistory.length - count;
+    for (let i = 0; i < count; i++) {
+        repetitionKeys[i] = gameHistory[first + i];
+        repetitionStart[i] = 0;
+    }
+    rootKeyIndex = count;
+    repetitionKeys[rootKeyIndex] = rootKey;
+    repetitionStart[rootKeyIndex] = 0;
+}
+
+/**
+ * Pushes the position at `ply` onto the repetition stack and counts its occurrences
+ * (itself included) since the last capture. Only every second entry can match: the
+ * key includes the side to move.
+ */
+function countRepetitions(pos, ply) {
+    const index = rootKeyIndex + 1 + ply;
+    const key = pos.hashKey();
+    const start = pos.lastCapturedCode() !== EMPTY ? index : repetitionStart[index - 1];
+    repetitionKeys[index] = key;
+    repetitionStart[index] = start;
+    let count = 1;
+    for (let i = index - 2; i >= start; i -= 2) {
+        if (repetitionKeys[i] === key) count++;
+    }
+    return count;
+}
+
+/** Makes `move` followed by the line at ply + 1 the principal variation at `ply`. */
+function updatePv(ply, move) {
+    const row = ply * MAX_SEARCH_PLY;
+    const childLength = ply + 1 < MAX_SEARCH_PLY ? pvLength[ply + 1] : 0;
+    const childRow = row + MAX_SEARCH_PLY;
+    pvMoves[row] = move;
+    for (let i = 0; i < childLength && i + 1 < MAX_SEARCH_PLY; i++) pvMoves[row + 1 + i] = pvMoves[childRow + i];
+    pvLength[ply] = Math.min(MAX_SEARCH_PLY, childLength + 1);
+}
+
+/** Stores a root move and the line below it (PV row 0) as the root principal variation. */
+function updateRootPv(move) {
+    rootPvMoves[0] = move;
+    const length = pvLength[0];
+    for (let i = 0; i < length; i++) rootPvMoves[1 + i] = pvMoves[i];
+    rootPvLength = length + 1;
+}
+
+/**
+ * Converts the root principal variation into move objects, replaying it to name the
+ * pieces. A line cut short by a table cutoff is continued with table moves up to
+ * `depth` moves. Stops at the first move that is not legal (or not found).
+ */
+function rootPvToMoveData(pos, depth) {
+    const line = [];
+    const played = [];
+    while (played.length < depth && getPositionStatus(pos) === GameStatus.ONGOING) {
+        let move = NO_MOVE;
+        if (played.length < rootPvLength) {
+            move = rootPvMoves[played.length];
+        } else if (transpositionTable.probe(pos.hashLo, pos.hashHi)) {
+            move = transpositionTable.hitMove;
+        }
+        if (move === NO_MOVE || !isLegalMove(pos, move, pos.sideToMove)) break;
+        line.push(toMoveData(pos, move));
+        pos.makeMove(move);
+        played.push(move);
+    }
+    while (played.length > 0) pos.unmakeMove(played.pop());
+    return line;
+}
+
+/** Converts an encoded move into the move object sent back to the main thread. */
+export function toMoveData(pos, move) {
+    const from = moveFrom(move);
+    const to = moveTo(move);
+    return {
+        pieceName: PIECES[PIECE_TYPES[codeType(pos.squares[from])]].name,
+        fromRow: squareRow(from), fromCol: squareCol(from),
+        toRow: squareRow(to), toCol: squareCol(to)
+    };
+}
+
+/**
+ * Converts a tablebase value (win/loss at a ply distance, for the side to move) into a
+ * search score for the side to move.
+ */
+function tablebaseScore(value, ply) {
+    if (value === TB_DRAW) return DRAW_SCORE;
+    return value >= TB_LOSS
+        ? -(TABLEBASE_WIN_SCORE - ply - (value - TB_LOSS))
+        : TABLEBASE_WIN_SCORE - ply - value;
+}
+
+/** Records a killer move (a quiet move that caused a beta cutoff). */
+function recordKillerMove(ply, move) {
+    if (ply < 0 || ply >= MAX_PLY_FOR_KILLERS || move === NO_MOVE) return;
+
+    // Avoid recording the same move twice in a row
+    if (killerMoves[ply * 2] === move) return;
+
+    // Shift the previous best killer move to the second slot
+    killerMoves[ply * 2 + 1] = killerMoves[ply * 2];
+    // Store the new killer move in the first slot
+    killerMoves[ply * 2] = move;
+}
+
+
+/** True if an opponent piece stands next to `player`'s den (it can enter it next move). */
+function isDenThreatened(pos, player) {
+    const den = player === Player.PLAYER0 ? PLAYER0_DEN_SQ : PLAYER1_DEN_SQ;
+    const squares = pos.squares;
+    for (let d = den * 4; d < den * 4 + 4; d++) {
+        const sq = NEIGHBORS[d];
+        if (sq >= 0 && squares[sq] !== EMPTY && codePlayer(squares[sq]) !== player) return true;
+    }
+    return false;
+}
+
+
+/** Updates the killers, history and countermove tables after a quiet move cut off. */
+function recordQuietCutoff(squares, ply, depth, move, tried, triedCount) {
+    recordKillerMove(ply, move);
+    moveHistory.recordCutoff(squares, move, depth, searchMoves[ply], tried, triedCount);
+}
+
+
+// --- Quiescence Search ---
+
+/**
+ * Searches captures and den entries below the horizon until the position is quiet,
+ * so the static evaluation is not trusted in the middle of an exchange or a den attack.
+ * The side to move may "stand pat" (keep the static score) instead of capturing,
+ * except when an opponent piece is next to its den: then only a capture of the
+ * intruder (or entering the other den first) avoids losing on the next move.
+ * The caller counts the node (countNodeAndCheckLimits).
+ * @param {Position} pos - Current position (mutated in place, restored on return).
+ * @param {number} alpha - Lower bound for the side to move.
+ * @param {number} beta - Upper bound for the side to move.
+ * @param {number} ply - Current ply depth from the root.
+ * @returns {number} The score for the side to move, or ABORTED_SCORE once searchAborted is set.
+ */
+function quiescence(pos, alpha, beta, ply) {
+    pvLength[ply] = 0; // Quiescence moves are not part of the principal variation
+    if (getPositionStatus(pos) !== GameStatus.ONGOING || ply >= MAX_SEARCH_PLY - 1) {
+        return searchEvaluator.evaluate(pos);
+    }
+
+    const playerToMove = pos.sideToMove;
+    let bestScore;
+    if (isDenThreatened(pos, playerToMove)) {
+        // No stand-pat: a quiet move lets the intruder in
+        bestScore = LOSE_SCORE;
+    } else {
+        bestScore = searchEvaluator.evaluate(pos);
+        if (bestScore >= beta) return bestScore;
+        alpha = Math.max(alpha, bestScore);
+    }
+
+    const picker = movePickers[ply];
+    picker.initQuiescence(pos, playerToMove);
+    for (let move = picker.next(pos); move !== NO_MOVE; move = picker.next(pos)) {
+        searchEvaluator.makeMove(pos, move);
+        const score = countNodeAndCheckLimits()
+            ? ABORTED_SCORE
+            : -quiescence(pos, -beta, -alpha, ply + 1);
+        searchEvaluator.unmakeMove(pos, move);
+        if (searchAborted) return ABORTED_SCORE;
+
+        if (score > bestScore) bestScore = score;
+        alpha = Math.max(alpha, bestScore);
+        if (alpha >= beta) break;
+    }
+    return bestScore;
+}
+
+
+// --- AlphaBeta Search ---
+
+/**
+ * Performs Alpha-Beta search for the best move score (negamax: every score is from
+ * the view of the side to move at that node, and a child's score is negated).
+ * @param {Position} pos - Current position (mutated in place, restored on return).
+ * @param {number} depth - Remaining search depth.
+ * @param {number} alpha - Score the side to move is already sure of.
+ * @param {number} beta - Score the opponent is already sure of (negated).
+ * @param {number} ply - Current ply depth from the root (for killer moves, move pickers
+ *   and the repetition stack).
+ * @returns {number} The evaluated score for the side to move, or ABORTED_SCORE once
+ *   searchAborted is set (the time limit, node budget or stop flag was hit).
+ */
+function alphaBeta(pos, depth, alpha, beta, ply) {
+    if (countNodeAndCheckLimits()) return ABORTED_SCORE;
+
+    const originalAlpha = alpha;
+    const originalBeta = beta;
+    pvLength[ply] = 0;
+
+    // --- Repetition Check (3-fold repetition over the game history and the search path) ---
+    if (countRepetitions(pos, ply) >= REPETITION_DRAW_COUNT) {
+        return DRAW_SCORE;
+    }
+
+    // 1. Transposition Table Lookup
+    const tt = transpositionTable;
+    const ttHit = tt.probe(pos.hashLo, pos.hashHi);
+    const ttDepth = ttHit ? tt.hitDepth : -1;
+    const hashMove = ttHit ? tt.hitMove : NO_MOVE;
+    if (ttHit && ttDepth >= depth) {
+        const ttScore = tt.hitScore;
+        const ttFlag = tt.hitFlag;
+        if (ttFlag === TT_EXACT) return ttScore;
+        if (ttFlag === TT_LOWERBOUND) alpha = Math.max(alpha, ttScore);
+        if (ttFlag === TT_UPPERBOUND) beta = Math.min(beta, ttScore);
+        if (alpha >= beta) return ttScore;
+    }
+
+    // 2. Terminal State Check & Base Case (Depth 0: quiescence search)
+    const status = getPositionStatus(pos);
+    if (status !== GameStatus.ONGOING) {
+        let baseScore = DRAW_SCORE;
+        if (status !== GameStatus.DRAW) {
+            // Wins found with more depth left (sooner) score further from zero
+            const MATE_DEPTH_BONUS = 10;
+            baseScore = searchEvaluator.evaluate(pos);
+            baseScore += baseScore > 0 ? depth * MATE_DEPTH_BONUS : -depth * MATE_DEPTH_BONUS;
+        }
+        // Store leaf node evaluation in TT
+        if (ttDepth < depth) {
+             tt.store(pos.hashLo, pos.hashHi, depth, TT_EXACT, baseScore, NO_MOVE);
+        }
+        return baseScore;
+    }
+    // Endgame tablebase: the exact result once few pieces are left
+    if (pos.pieceCount[Player.PLAYER0] + pos.pieceCount[Player.PLAYER1] <= tablebasePieces) {
+        const tablebaseValue = probeTablebase(pos);
+        if (tablebaseValue >= 0) {
+            tablebaseHits++;
+            return tablebaseScore(tablebaseValue, ply);
+        }
+    }
+    // At the end of the per-ply stacks the line ends here as well (TT hits can carry
+    // the iterations that deep in small endgames)
+    if (depth === 0 || ply >= MAX_SEARCH_PLY - 1) {
+        return quiescence(pos, alpha, beta, ply);
+    }
+
+    const playerToMove = pos.sideToMove;
+    const isPvNode = beta - alpha > 1; // Null-window nodes only have to prove a bound
+    const denThreatened = isDenThreatened(pos, playerToMove);
+
+    // 3. Null-Move Pruning. Not when passing loses at once (den threatened), right after
+    // another null move, or with few pieces left, where being forced to move can hurt (zugzwang)
+    if (useNullMove && !isPvNode && depth >= NULL_MOVE_MIN_DEPTH && !denThreatened &&
+        !(ply > 0 && nullMoveAtPly[ply - 1]) && pos.pieceCount[playerToMove] >= NULL_MOVE_MIN_PIECES) {
+        const staticScore = searchEvaluator.evaluate(pos);
+        if (staticScore >= beta && beta < DECISIVE_SCORE) {
+            // Positions after a pass can never repeat the ones before it
+            const nodeIndex = rootKeyIndex + 1 + ply;
+            const savedStart = repetitionStart[nodeIndex];
+            repetitionStart[nodeIndex] = nodeIndex + 1;
+            nullMoveAtPly[ply] = 1;
+            searchMoves[ply + 1] = NO_MOVE;
+            searchEvaluator.makeNullMove(pos);
+            const nullScore = -alphaBeta(pos, depth - 1 - NULL_MOVE_REDUCTION, -beta, -beta + 1, ply + 1);
+            searchEvaluator.unmakeNullMove(pos);
+            nullMoveAtPly[ply] = 0;
+            repetitionStart[nodeIndex] = savedStart;
+            if (searchAborted) return ABORTED_SCORE;
+            // Fail hard: a pass proves the bound, not the score
+            if (nullScore >= beta) return beta;
+        }
+    }
+
+    // 4. Pick Moves Stage by Stage: TT move, captures, killers, countermove, quiets
+    const squares = pos.squares;
+    const killerMove1 = (ply < MAX_PLY_FOR_KILLERS) ? killerMoves[ply * 2] : NO_MOVE;
+    const killerMove2 = (ply < MAX_PLY_FOR_KILLERS) ? killerMoves[ply * 2 + 1] : NO_MOVE;
+    const counterMove = moveHistory.countermove(squares, searchMoves[ply]);
+    const picker = movePickers[ply];
+    picker.init(pos, playerToMove, hashMove, killerMove1, killerMove2, counterMove);
+    const tried = triedQuiets[ply];
+    let triedCount = 0;
+
+    // 5. Iterate Through Moves and Recurse (Principal Variation Search)
+    let bestMoveForNode = NO_MOVE;
+    let bestScore = -Infinity;
+    let movesSearched = 0;
+
+    for (let move = picker.next(pos); move !== NO_MOVE; move = picker.next(pos)) {
+        movesSearched++;
+        const isCapture = squares[moveTo(move)] !== EMPTY;
+        searchEvaluator.makeMove(pos, move);
+        searchMoves[ply + 1] = move;
+
+        // Late-move reduction of quiet moves after the first few: not killers, and not while
+        // either den is threatened (defending it, or the move itself threatens a den entry)
+        const reduction = (useLateMoveReductions && !isPvNode && depth >= LMR_MIN_DEPTH &&
+            movesSearched > LMR_FULL_DEPTH_MOVES && !isCapture && !denThreatened &&
+            move !== killerMove1 && move !== killerMove2 && !isDenThreatened(pos, pos.sideToMove))
+            ? LMR_REDUCTION : 0;
+
+        let evalScore;
+        if (movesSearched === 1) {
+            // The first move is expected to be best: full window
+            evalScore = -alphaBeta(pos, depth - 1, -beta, -alpha, ply + 1);
+        } else {
+            // Null window: only prove the move is no better than alpha; re-search if it is
+            evalScore = -alphaBeta(pos, depth - 1 - reduction, -alpha - 1, -alpha, ply + 1);
+            if (!searchAborted && reduction > 0 && evalScore > alpha) {
+                evalScore = -alphaBeta(pos, depth - 1, -alpha - 1, -alpha, ply + 1);
+            }
+            if (!searchAborted && evalScore > alpha && evalScore < beta) {
+                evalScore = -alphaBeta(pos, depth - 1, -beta, -alpha, ply + 1);
+            }
+        }
+        searchEvaluator.unmakeMove(pos, move);
+        if (searchAborted) return ABORTED_SCORE; // Unwind without storing partial results
+
+        if (evalScore > bestScore) { bestScore = evalScore; bestMoveForNode = move; }
+        if (evalScore > alpha) updatePv(ply, move);
+        alpha = Math.max(alpha, bestScore);
+        if (alpha >= beta) { // Beta cutoff
+            betaCutoffs++;
+            if (movesSearched === 1) firstMoveCutoffs++;
+            if (!isCapture) recordQuietCutoff(squares, ply, depth, move, tried, triedCount);
+            break;
+        }
+        if (!isCapture) tried[triedCount++] = move;
+    } // End move loop
+
+    // If no moves available, it's a stalemate/loss for the current player
+    if (movesSearched === 0) {
+        return searchEvaluator.evaluate(pos);
+    }
+    expandedNodes++;
+
+    // 6. Store Result in Transposition Table
+    let flag;
+    if (bestScore <= originalAlpha) flag = TT_UPPERBOUND;
+    else if (bestScore >= originalBeta) flag = TT_LOWERBOUND;
+    else flag = TT_EXACT;
+
+    if (isFinite(bestScore)) {
+        tt.store(pos.hashLo, pos.hashHi, depth, flag, bestScore, bestMoveForNode);
+    }
+
+    return bestScore;
+}
+
+
+// --- Iterative Deepening Driver ---
+
+/**
+ * Search statistics so far: fraction of expanded nodes that failed high, and of those
+ * cutoffs the share produced by the first move searched.
+ */
+function cutoffStats() {
+    return {
+        cutoffRate: expandedNodes > 0 ? betaCutoffs / expandedNodes : 0,
+        firstMoveCutoffRate: betaCutoffs > 0 ? firstMoveCutoffs / betaCutoffs : 0
+    };
+}
+
+/**
+ * Searches the root moves (for the side to move) inside the window (alpha, beta) with
+ * Principal Variation Search: the first move gets the full window, the others a null
+ * window around alpha and a full re-search only if they beat it. Stops at the first
+ * move that fails high (score >= beta). Updates the root principal variation.
+ * @returns {{ score: number, index: number }} Best score and its index in rootMoves
+ *   (index -1 if the search was aborted before the first move finished).
+ */
+function searchRootMoves(pos, rootMoves, depth, alpha, beta) {
+    let bestScore = -Infinity;
+    let bestIndex = -1;
+    rootPvLength = 0;
+
+    for (let i = 0; i < rootMoves.length; i++) {
+        const move = rootMoves[i];
+        searchEvaluator.makeMove(pos, move);
+        searchMoves[0] = move;
+        // Children are searched for the opponent at ply 0
+        let score;
+        if (i === 0) {
+            score = -alphaBeta(pos, depth - 1, -beta, -alpha, 0);
+        } else {
+            score = -alphaBeta(pos, depth - 1, -alpha - 1, -alpha, 0);
+            if (!searchAborted && score > alpha && score < beta) {
+                score = -alphaBeta(pos, depth - 1, -beta, -alpha, 0);
+            }
+        }
+        searchEvaluator.unmakeMove(pos, move);
+        if (searchAborted) break; // The unfinished iteration is discarded
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestIndex = i;
+            if (score > alpha) updateRootPv(move);
+        }
+        alpha = Math.max(alpha, score);
+        if (alpha >= beta) break; // Fail high: the aspiration window has to be widened
+    }
+    return { score: bestScore, index: bestIndex };
+}
+
+/**
+ * Finds the best move using Iterative Deepening Alpha-Beta search.
+ * @param {Array<Array<object>>|Position} boardState - The current board state, nested or packed
+ *   (a Position, e.g. from a worker message, with its own side to move); not modified.
+ * @param {number} maxDepth - The maximum target search depth.
+ * @param {number} timeLimit - The maximum time allowed in milliseconds.
+ * @param {object} [options]
+ * @param {number} [options.sideToMove=Player.PLAYER1] - Player to find a move for (nested board
+ *   states only).
+ * @param {number} [options.workerIndex=0] - 0 for the main search; helpers in a parallel search (> 0)
+ *   search one ply deeper (odd indices) and try root moves in a rotated order.
+ * @param {number} [options.nodeLimit=0] - Node budget (0 = none). Unlike the time limit it makes
+ *   the search independent of hardware speed: the same position gives the same move everywhere.
+ * @param {number[]} [options.gameHistory=[]] - Zobrist keys (computeZobristKey) of the game's
+ *   positions before this one, oldest first, so repetitions of real game positions are seen.
+ * @param {object} [options.pruning=DEFAULT_PRUNING] - Forward pruning: { nullMove, lateMoveReductions }
+ *   (booleans; a missing field counts as enabled).
+ * @param {boolean} [options.continued=false] - The call resumes an earlier search of the same
+ *   position (pondering in time slices): the move history is not aged again and the
+ *   per-call log lines are left out.
+ * @param {boolean} [options.timeManagement=false] - Treat timeLimit as a hard limit and stop
+ *   sooner when the position looks settled (see timeManager.js); otherwise iterations
+ *   go on until the time limit, the node budget or maxDepth.
+ * @param {function(object): void} [options.onIteration] - Called after every completed
+ *   iteration with its entry of `iterations` plus nps, ttHitRate, cutoffRate and
+ *   firstMoveCutoffRate (the whole search so far), for live progress reports.
+ * @returns {object} Result object: { move, depthAchieved, nodes, eval, pv, iterations, tablebaseHits, timeMs,
+ *   ttHitRate, ttFill, cutoffRate, firstMoveCutoffRate, error? }
+ *   `eval` is from the view of the side to move.
+ *   `pv` is the principal variation (the move, then the expected replies) as move objects.
+ *   `iterations` lists every completed depth as { depth, timeMs, nodes, eval, move, pv }.
+ */
+export function findBestMove(boardState, maxDepth, timeLimit,
+                             { sideToMove = Player.PLAYER1, workerIndex = 0, nodeLimit = 0, gameHistory = [], pruning = DEFAULT_PRUNING,
+                               continued = false, timeManagement = false, onIteration = null } = {}) {
+    const startTime = performance.now();
+    maxDepth = Math.min(maxDepth, MAX_SEARCH_PLY - 1); // Deeper would run past the per-ply stacks
+    searchDeadline = startTime + timeLimit;
+    searchNodeLimit = nodeLimit > 0 ? nodeLimit : 0;
+    searchAborted = false;
+    useNullMove = pruning?.nullMove !== false;
+    useLateMoveReductions = pruning?.lateMoveReductions !== false;
+    nullMoveAtPly.fill(0);
+    // Shared search position, modified via make/unmake
+    const pos = boardState instanceof Position
+        ? Position.fromSquares(boardState.squares, boardState.sideToMove)
+        : Position.fromBoardState(boardState, sideToMove);
+    const rootPlayer = pos.sideToMove;
+    searchEvaluator.reset(pos);
+    aiRunCounter = 0; // Reset node counter for this search
+    tablebasePieces = tablebasePieceLimit();
+    tablebaseHits = 0;
+    expandedNodes = betaCutoffs = firstMoveCutoffs = 0;
+    killerMoves.fill(NO_MOVE); // Clear killer moves
+    if (!continued) moveHistory.age(); // Earlier turns still order quiet moves, with half the weight
+    const depthOffset = workerIndex % 2; // Odd helpers stay one ply ahead of the main search
+
+    let bestMoveOverall = null;
+    let lastCompletedDepth = 0;
+    let bestScoreOverall = -Infinity; // From the root side's view
+    let principalVariation = []; // Expected line of play of the last completed iteration
+    const iterations = []; // Completed iterations, for time-to-depth and best-move stability
+
+    // Get initial possible moves for the root node
+    const rootMoveBuffer = new Int32Array(MAX_MOVES);
+    const rootMoveCount = generateMoves(pos, rootPlayer, rootMoveBuffer);
+    let rootMoves = Array.from(rootMoveBuffer.subarray(0, rootMoveCount));
+
+    if (rootMoves.length === 0) {
+        console.warn("[Worker] No moves available for AI.");
+        return { move: null, depthAchieved: 0, nodes: aiRunCounter, eval: null, iterations, error: "No moves available" };
+    }
+
+    resetRepetitionStack(gameHistory, pos.hashKey());
+    const timeManager = timeManagement && isFinite(timeLimit) ? new TimeManager(timeLimit, rootMoves.length) : null;
+
+    // Set a default best move (the first legal one)
+    bestMoveOverall = toMoveData(pos, rootMoves[0]);
+
+    try {
+        // Iterative Deepening Loop
+        for (let iteration = 1; iteration <= maxDepth; iteration++) {
+            const currentDepth = Math.min(maxDepth, iteration + depthOffset);
+
+            // Check the limits before starting the iteration
+            if (performance.now() > searchDeadline || (searchNodeLimit > 0 && aiRunCounter >= searchNodeLimit)) {
+                if (!continued) console.log(`[Worker IDS] Limit reached BEFORE starting Depth ${currentDepth}`);
+                break;
+            }
+            if (timeManager && lastCompletedDepth > 0 && !timeManager.shouldStartIteration(performance.now() - startTime)) {
+                if (!continued) console.log(`[Worker IDS] Time manager stops before Depth ${currentDepth}: ${timeManager.stopReason}.`);
+                break;
+            }
+
+            let bestScoreThisIteration = -Infinity;
+            let bestMoveThisIteration = null;
+            let bestRootMoveThisIteration = NO_MOVE;
+
+            // --- Root Move Ordering ---
+             const hashMoveRoot = transpositionTable.probe(pos.hashLo, pos.hashHi) ? transpositionTable.hitMove : NO_MOVE;
+
+             if (hashMoveRoot !== NO_MOVE) {
+                 // Prioritize the move from the Transposition Table
+                 const idx = rootMoves.indexOf(hashMoveRoot);
+                 if (idx > 0) {
+                     // Move the hash move to the front
+                     rootMoves.unshift(rootMoves.splice(idx, 1)[0]);
+                 }
+             } else {
+                 // If no hash move, apply simple ordering: Captures > Advancement towards den
+                 const opponentDenRow = rootPlayer === Player.PLAYER1 ? PLAYER0_DEN_ROW : PLAYER1_DEN_ROW;
+                 const rootOrderScore = (move) => {
+                     const from = moveFrom(move);
+                     const to = moveTo(move);
+                     const targetCode = pos.squares[to];
+                     let orderScore = 0;
+
+                     // 1. Capture Bonus (MVV-LVA style)
+                     if (targetCode !== EMPTY) {
+                         orderScore += 10000 + CODE_VALUE[targetCode] - CODE_VALUE[pos.squares[from]]; // High base score for captures
+                     }
+
+                     // 2. Advancement Bonus (Getting closer to opponent den)
+                     const currentDist = Math.abs(squareRow(from) - opponentDenRow);
+                     const newDist = Math.abs(squareRow(to) - opponentDenRow);
+                     if (newDist < currentDist) {
+                         orderScore += 10; // Add a small bonus for getting closer
+                     }
+                     return orderScore;
+                 };
+                 // Sort moves based on calculated orderScore (descending, stable)
+                 rootMoves = rootMoves
+                     .map(move => ({ move, orderScore: rootOrderScore(move) }))
+                     .sort((a, b) => b.orderScore - a.orderScore)
+                     .map(entry => entry.move);
+             } // End simple ordering
+
+            // Helpers try the remaining root moves in a different order than the main search
+            if (workerIndex > 0 && rootMoves.length > 2) {
+                const shift = (workerIndex + iteration) % (rootMoves.length - 1);
+                rootMoves = [rootMoves[0], ...rootMoves.slice(1 + shift), ...rootMoves.slice(1, 1 + shift)];
+            }
+
+            // Aspiration window around the previous score; decisive scores use the full window
+            let window = ASPIRATION_WINDOW;
+            let alpha = -Infinity, beta = Infinity;
+            if (lastCompletedDepth > 0 && Math.abs(bestScoreOverall) < DECISIVE_SCORE) {
+                alpha = bestScoreOverall - window;
+                beta = bestScoreOverall + window;
+            }
+
+            let rootResult;
+            for (;;) {
+                rootResult = searchRootMoves(pos, rootMoves, currentDepth, alpha, beta);
+                if (searchAborted) break;
+                if (rootResult.score <= alpha) {
+                    // Fail low: every move is worse than expected, widen downwards
+                    window *= ASPIRATION_GROWTH;
+                    alpha = window > MAX_ASPIRATION_WINDOW ? -Infinity : bestScoreOverall - window;
+                } else if (rootResult.score >= beta) {
+                    // Fail high: widen upwards and search the refuting move first
+                    window *= ASPIRATION_GROWTH;
+                    beta = window > MAX_ASPIRATION_WINDOW ? Infinity : bestScoreOverall + window;
+                    if (rootResult.index > 0) rootMoves.unshift(rootMoves.splice(rootResult.index, 1)[0]);
+                } else {
+                    break;
+                }
+            }
+
+            if (!searchAborted) {
+                bestScoreThisIteration = rootResult.score;
+                bestRootMoveThisIteration = rootMoves[rootResult.index];
+                bestMoveThisIteration = toMoveData(pos, bestRootMoveThisIteration);
+            }
+
+            if (searchAborted) {
+                if (!continued) console.log(`[Worker IDS] Limit reached during Depth ${currentDepth}, returning best move found so far.`);
+                break; // Exit IDS loop
+            }
+            const totalTimeElapsed = performance.now() - startTime;
+
+            // The iteration completed (limits are polled, so possibly just past the deadline)
+            lastCompletedDepth = currentDepth;
+            if (bestMoveThisIteration) { // Ensure a valid move was found in this iteration
+                bestMoveOverall = bestMoveThisIteration;
+            }
+            bestScoreOverall = bestScoreThisIteration;
+            principalVariation = rootPvToMoveData(pos, currentDepth);
+            const iterationEntry = {
+                depth: currentDepth,
+                timeMs: totalTimeElapsed,
+                nodes: aiRunCounter,
+                eval: bestScoreThisIteration,
+                move: bestMoveOverall,
+                pv: principalVariation
+            };
+            iterations.push(iterationEntry);
+            if (timeManager) timeManager.recordIteration(totalTimeElapsed, currentDepth, bestRootMoveThisIteration, bestScoreThisIteration);
+            if (onIteration) {
+                onIteration({
+                    ...iterationEntry,
+                    nps: totalTimeElapsed > 0 ? aiRunCounter / (totalTimeElapsed / 1000) : 0,
+                    ttHitRate: transpositionTable.hitRate(),
+                    ...cutoffStats()
+                });
+            }
+
+            // Remember the root result so the next iteration (and the next turn) tries its move first
+            if (bestRootMoveThisIteration !== NO_MOVE && isFinite(bestScoreThisIteration)) {
+                transpositionTable.store(pos.hashLo, pos.hashHi, currentDepth, TT_EXACT, bestScoreThisIteration, bestRootMoveThisIteration);
+            }
+
+
+            // Check for early exit if a winning/losing score is found reliably
+             if (bestScoreOverall > LOSE_SCORE * 0.9 && (bestScoreOverall >= WIN_SCORE * 0.9 || bestScoreOverall <= LOSE_SCORE * 0.9)) {
+                 console.log(`[Worker IDS] Early exit: Score ${bestScoreOverall.toFixed(0)} indicates win/loss at Depth ${currentDepth}.`);
+                 break; // Exit IDS loop
+             }
+             // Also check for definite draw score if that's useful
+             if (bestScoreOverall === DRAW_SCORE) {
+                 console.log(`[Worker IDS] Early exit: Score ${bestScoreOverall} indicates forced draw at Depth ${currentDepth}.`);
+                 // Decide whether to break here or keep searching for a potential win/loss at deeper levels
+                 // break; // Optional: break on finding a certain draw
+             }
+
+            if (currentDepth >= maxDepth) break; // Helpers ahead by one ply reach maxDepth early
+
+        } // End Iterative Deepening Loop
+
+    } catch (error) {
+        console.error("[Worker IDS] Unexpected search error:", error);
+        // Return previous best move if available, along with error message
+        return {
+            move: bestMoveOverall, // Send previous best if possible
+            depthAchieved: lastCompletedDepth,
+            nodes: aiRunCounter,
+            eval: bestScoreOverall,
+            pv: principalVariation,
+            iterations,
+            error: error.message || "IDS Error"
+        };
+    }
+
+     const finalDuration = performance.now() - startTime;
+     const ttHitRate = transpositionTable.hitRate();
+     const ttFill = transpositionTable.fillLevel();
+     if (!continued) console.log(`[Worker] findBestMove finished. Depth: ${lastCompletedDepth}. Nodes: ${aiRunCounter}. Time: ${finalDuration.toFixed(0)}ms. Eval: ${bestScoreOverall?.toFixed(2)}. TT hits: ${(ttHitRate * 100).toFixed(1)}%, fill: ${(ttFill * 100).toFixed(1)}%`);
+
+    // Return the result object
+    return {
+        move: bestMoveOverall,
+        depthAchieved: lastCompletedDepth,
+        nodes: aiRunCounter, // Return node count
+        eval: bestScoreOverall === -Infinity ? null : bestScoreOverall, // Return null eval if search didn't complete depth 1
+        ttHitRate: ttHitRate, // Fraction of TT probes that found an entry during this search
+        ttFill: ttFill,       // Estimated fraction of the TT used by this search
+        pv: principalVariation, // Best move followed by the expected replies
+        iterations: iterations,
+        tablebaseHits: tablebaseHits, // Nodes answered by the endgame tablebases
+        timeMs: finalDuration,
+        ...cutoffStats()
+    };
+}
+
+// --- Search Setup ---
+
+/**
+ * Prepares the worker-scoped search state for the next findBestMove call.
+ * The TT and the move history persist between requests; they are only rebuilt or
+ * emptied when asked to.
+ * @param {object} options
+ * @param {number} [options.hashSizeMb] - Size of the private table.
+ * @param {boolean} [options.newGame] - Empty the move history and the private table first.
+ * @param {SharedArrayBuffer} [options.sharedTable] - Table storage shared by a parallel search.
+ * @param {number} [options.ttGeneration] - Generation of the shared table for this search.
+ * @param {SharedArrayBuffer} [options.stopBuffer] - Stop flag shared by a parallel search.
+ */
+export function prepareSearch({ hashSizeMb, newGame = false, sharedTable = null, ttGeneration = 0, stopBuffer = null } = {}) {
+    if (newGame) moveHistory.clear();
+    if (sharedTable) {
+        // Parallel search: the controller owns the table (clearing, generation)
+        if (transpositionTable.buffer !== sharedTable) {
+            transpositionTable = new TranspositionTable(hashSizeMb, sharedTable);
+        }
+        transpositionTable.setGeneration(ttGeneration);
+    } else {
+        if (typeof hashSizeMb === 'number' && normalizeTableSizeMb(hashSizeMb) !== transpositionTable.sizeMb) {
+            transpositionTable.resize(hashSizeMb);
+        } else if (newGame) {
+            transpositionTable.clear();
+        }
+        transpositionTable.newSearch(); // Keep entries from earlier turns, but age them
+    }
+    stopSignal = stopBuffer ? new Int32Array(stopBuffer) : null;
+}
+
+/**
+ * Prepares a search between requests (pondering): it keeps the current table as it is,
+ * without aging it or touching a shared table's generation, and ignores the stop flag
+ * of the last parallel search.
+ */
+export function preparePonderSearch() {
+    stopSignal = null;
+}
+
+/**
+ * Chooses the evaluator of the following searches. Any object with IncrementalEvaluator's
+ * methods (reset, makeMove, unmakeMove, makeNullMove, unmakeNullMove, evaluate) and the
+ * same scores will do, such as wasmEvaluate.js's WasmEvaluator.
+ * @param {object|null} evaluator - The evaluator, or null for a new IncrementalEvaluator.
+ */
+export function setSearchEvaluator(evaluator) {
+    searchEvaluator = evaluator || new IncrementalEvaluator();
+}
+
+/** Nodes visited by the current (or last) search. */
+export function getSearchNodeCount() {
+    return aiRunCounter;
+}
@@ -0,0 +1,231 @@
+// js/aiSearchPool.js
+// Main-thread controller for the AI workers. It has the same surface game.js used
+// with a single Worker (postMessage / onmessage / onerror / terminate), but can run
+// a parallel "Lazy SMP" search: every worker searches the same root with its own
+// depth offset and root move order, all sharing one lock-free transposition table
+// in a SharedArrayBuffer. Worker 0 is the main search; when it finishes the helpers
+// are told to stop, and the deepest completed result of all workers is reported.
+//
+// SharedArrayBuffer needs a cross-origin isolated page (COOP/COEP headers). Without
+// it the pool falls back to a single worker with its own private table.
+//
+// Requests are packed here into the binary form of aiMessages.js and results are
+// unpacked on arrival, so callers keep using board states and move objects. Progress
+// reports of the main search go to onprogress as they arrive. The endgame tables are
+// fetched once by the page and handed to the workers here (attachTablebases).
+
+import { TranspositionTable, DEFAULT_TT_SIZE_MB, normalizeTableSizeMb } from './transpositionTable.js';
+import { encodeRequest, decodeResult, REQUEST_SEARCH, REQUEST_PONDER, REQUEST_STOP_PONDER } from './aiMessages.js';
+import { Position, toSquare, encodeMove } from './position.js';
+import { Player } from './constants.js';
+
+const WORKER_URL = "js/aiWorker.js";
+
+let sharedTablebases = null; // { pack, buffer }: shared copy of a table pack, reused by later pools
+
+/** True if workers can share memory in this context. */
+export function isSharedMemoryAvailable() {
+    return typeof SharedArrayBuffer !== 'undefined' &&
+        (typeof crossOriginIsolated === 'undefined' || crossOriginIsolated === true);
+}
+
+/**
+ * Resolves how many search workers to start.
+ * @param {number} requested - Configured thread count; 0 means one per logical core.
+ * @param {number} maxThreads - Upper bound.
+ * @returns {number} Thread count (1 when memory cannot be shared).
+ */
+export function resolveSearchThreadCount(requested, maxThreads) {
+    if (!isSharedMemoryAvailable()) return 1;
+    const cores = (typeof navigator !== 'undefined' && navigator.hardwareConcurrency) || 1;
+    const threads = requested > 0 ? requested : cores;
+    return Math.max(1, Math.min(maxThreads, threads));
+}
+
+export class AiSearchPool {
+    /**
+     * @param {number} threadCount - Number of workers (see resolveSearchThreadCount).
+     * @param {number} [hashSizeMb] - Size of the shared transposition table.
+     */
+    constructor(threadCount, hashSizeMb = DEFAULT_TT_SIZE_MB) {
+        this.onmessage = null; // Receives { data: result } like Worker.onmessage
+        this.onerror = null;   // Receives the worker's ErrorEvent
+        this.onprogress = null; // Receives the main search's progress reports (decoded, `progress: true`)
+        this.threadCount = Math.max(1, threadCount);
+        this.parallel = this.threadCount > 1;
+        this.workers = [];
+        this.searchId = 0;
+        this.pendingResults = [];
+        this.pendingCount = 0;
+
+        if (this.parallel) {
+            this.table = new TranspositionTable(hashSizeMb, TranspositionTable.createSharedBuffer(hashSizeMb));
+            this.stopBuffer = new SharedArrayBuffer(Int32Array.BYTES_PER_ELEMENT);
+            this.stopSignal = new Int32Array(this.stopBuffer);
+        }
+
+        // Create every worker up front; a failure is thrown to the caller like `new Worker`
+        for (let i = 0; i < this.threadCount; i++) {
+            const worker = new Worker(WORKER_URL, { type: "module" });
+            worker.onmessage = (e) => this.handleWorkerMessage(decodeResult(e.data));
+            worker.onerror = (event) => { if (this.onerror) this.onerror(event); };
+            this.workers.push(worker);
+        }
+        if (this.parallel) this.attachSharedMemory();
+    }
+
+    /** Hands the shared table and stop flag to every worker (they keep them for later requests). */
+    attachSharedMemory() {
+        for (const worker of this.workers) {
+            worker.postMessage({ type: 'attachShared', sharedTable: this.table.buffer, stopBuffer: this.stopBuffer });
+        }
+    }
+
+    /**
+     * Hands the endgame tables (a pack, tablebase.js) to the workers: in parallel mode
+     * one SharedArrayBuffer copy they all probe, else a transferred copy. The caller
+     * keeps `pack` for the next pool.
+     * @param {ArrayBuffer} pack
+     */
+    attachTablebases(pack) {
+        if (this.parallel) {
+            if (sharedTablebases?.pack !== pack) {
+                const buffer = new SharedArrayBuffer(pack.byteLength);
+                new Uint8Array(buffer).set(new Uint8Array(pack));
+                sharedTablebases = { pack, buffer };
+            }
+            for (const worker of this.workers) worker.postMessage({ type: 'attachShared', tablebases: sharedTablebases.buffer });
+        } else if (this.workers.length > 0) {
+            const copy = pack.slice(0);
+            this.workers[0].postMessage({ type: 'attachShared', tablebases: copy }, [copy]);
+        }
+    }
+
+    /** Packs a request and transfers it to a worker. */
+    send(worker, kind, request) {
+        const buffer = encodeRequest(kind, request);
+        worker.postMessage(buffer, [buffer]);
+    }
+
+    /**
+     * Starts a search. Accepts the single-worker request ({ boardState, sideToMove, targetDepth,
+     * timeLimit, nodeLimit, gameHistory, pruning, hashSizeMb, newGame, useBook, timeManagement, keepPonder }); the reply arrives
+     * through onmessage.
+     * `sideToMove` is the side the search plays (Player 1 if omitted).
+     * A node budget applies to every worker on its own.
+     */
+    postMessage(request) {
+        this.searchId++;
+        this.pendingResults = [];
+        this.pendingCount = this.threadCount;
+        const sideToMove = request.sideToMove ?? Player.PLAYER1;
+        const packed = {
+            squares: Position.fromBoardState(request.boardState, sideToMove).squares,
+            sideToMove,
+            targetDepth: request.targetDepth,
+            timeLimit: request.timeLimit,
+            nodeLimit: request.nodeLimit,
+            gameHistory: request.gameHistory,
+            pruning: request.pruning,
+            hashSizeMb: request.hashSizeMb,
+            newGame: request.newGame, // Clears each worker's move history (a shared table is cleared below)
+            useBook: request.useBook, // Only worker 0 probes the opening book
+            timeManagement: request.timeManagement, // Worker 0 decides when to stop
+            keepPonder: request.keepPonder, // Worker 0 resumes pondering afterwards
+            searchId: this.searchId
+        };
+
+        if (!this.parallel) {
+            this.send(this.workers[0], REQUEST_SEARCH, packed);
+            return;
+        }
+
+        if (typeof request.hashSizeMb === 'number' && normalizeTableSizeMb(request.hashSizeMb) !== this.table.sizeMb) {
+            this.table = new TranspositionTable(request.hashSizeMb, TranspositionTable.createSharedBuffer(request.hashSizeMb));
+            this.attachSharedMemory();
+        } else if (request.newGame) {
+            this.table.clear();
+        }
+        this.table.newSearch();
+        Atomics.store(this.stopSignal, 0, 0);
+
+        for (let i = 0; i < this.threadCount; i++) {
+            this.send(this.workers[i], REQUEST_SEARCH, {
+                ...packed,
+                hashSizeMb: this.table.sizeMb,
+                ttGeneration: this.table.generation,
+                workerIndex: i
+            });
+        }
+    }
+
+    /**
+     * Lets worker 0 search on the opponent's time ({ boardState, sideToMove, reply, targetDepth,
+     * maxTimeMs, gameHistory, pruning }, see aiWorker.js). `sideToMove` is the opponent, who
+     * plays `reply` (Player 0 if omitted). It sends no reply; the next request for the
+     * position after `reply` may be answered from it at once.
+     */
+    ponder({ boardState, sideToMove = Player.PLAYER0, reply, targetDepth, maxTimeMs, gameHistory, pruning }) {
+        if (this.workers.length === 0 || !boardState || !reply) return;
+        this.send(this.workers[0], REQUEST_PONDER, {
+            squares: Position.fromBoardState(boardState, sideToMove).squares,
+            sideToMove,
+            reply: encodeMove(toSquare(reply.fromRow, reply.fromCol), toSquare(reply.toRow, reply.toCol)),
+            targetDepth, timeLimit: maxTimeMs, gameHistory, pruning
+        });
+    }
+
+    /** Stops pondering (the position changed some other way). */
+    stopPonder() {
+        if (this.workers.length > 0) this.send(this.workers[0], REQUEST_STOP_PONDER, {});
+    }
+
+    handleWorkerMessage(result) {
+        if (result.searchId !== this.searchId) return; // Reply to an abandoned search
+        if (result.progress) {
+            if (this.onprogress) this.onprogress(result);
+            return;
+        }
+
+        if (this.parallel && result.workerIndex === 0) {
+            // The main search is done; helpers stop at their next node
+            Atomics.store(this.stopSignal, 0, 1);
+        }
+        this.pendingResults.push(result);
+        if (--this.pendingCount > 0) return;
+
+        const reply = this.parallel ? this.selectResult(this.pendingResults) : result;
+        this.pendingResults = [];
+        if (this.onmessage) this.onmessage({ data: reply });
+    }
+
+    /** Picks the deepest completed result (main search wins ties) and sums the node counts. */
+    selectResult(results) {
+        const main = results.find(r => r.workerIndex === 0) || results[0];
+        if (main.error || main.bookMove) return main; // A book move beats the helpers' aborted searches
+
+        let best = main;
+        let totalNodes = 0;
+        for (const r of results) {
+            totalNodes += r.nodes || 0;
+            if (!r.error && r.move && r.depthAchieved > best.depthAchieved) best = r;
+        }
+        if (best !== main) {
+            console.log(`[Pool] Using helper ${best.workerIndex} result (depth ${best.depthAchieved} vs ${main.depthAchieved}).`);
+        }
+        return {
+            ...best,
+            nodes: totalNodes,
+            ttHitRate: main.ttHitRate, // Table stats as seen by the main search
+            ttFill: main.ttFill,
+            threads: this.threadCount
+        };
+    }
+
+    terminate() {
+        for (const worker of this.workers) worker.terminate();
+        this.workers = [];
+        this.pendingResults = [];
+        this.pendingCount = 0;
+    }
+}
@@ -0,0 +1,159 @@
+// js/assetLoader.js
+// Preloads the game's images and sounds before the first board is drawn (main.js
+// shows the progress). The piece heads and decorations come from one sprite atlas
+// (assets/atlas, built by tools/buildAtlas.js); each sprite is cut out once into an
+// object URL, which assetUrl() hands to the <img> elements in place of the source
+// file. The sounds are decoded in parallel into AudioBuffers of a single AudioContext
+// and played from a small pool of voices, so the first move does not wait on a decode.
+// Whatever fails to load falls back to the individual files: assetUrl() returns the
+// path it was given and playSoundEffect() returns false (renderer.js then uses <audio>).
+
+import {
+    PIECES, BASE_ASSETS_PATH, ATLAS_MANIFEST, SOUNDS_PATH,
+    TILESET_IMAGE, WATER_BACKGROUND, TRAP_BACKGROUND
+} from './constants.js';
+
+// Sounds played by the game (renderer.js playSound names)
+const SOUND_NAMES = [...Object.keys(PIECES).map(type => `capture_${type}`), 'move', 'victory', 'defeat', 'draw'];
+// Images drawn as CSS backgrounds, outside the atlas (the tileset; the GIFs are animated)
+const BACKGROUND_IMAGES = [TILESET_IMAGE, WATER_BACKGROUND, TRAP_BACKGROUND];
+// Sounds playing at once; a new one beyond this stops the oldest
+const MAX_VOICES = 6;
+
+const spriteUrls = new Map(); // Source path relative to assets/ -> object URL
+const soundBuffers = new Map(); // Sound name -> AudioBuffer
+const keptImages = []; // Decoded backgrounds, referenced so the browser keeps them
+let audioContext = null;
+let masterGain = null;
+const voices = []; // Playing AudioBufferSourceNodes, oldest first
+
+/** Piece head image of a type. */
+export function pieceImageUrl(type) {
+    return assetUrl(`${BASE_ASSETS_PATH}images/head_no_background/${type}.png`);
+}
+
+/**
+ * URL to show an image under: its atlas sprite once preloaded, else the path itself.
+ * @param {string} path - Image path as in constants.js (BASE_ASSETS_PATH + ...).
+ */
+export function assetUrl(path) {
+    const key = path.startsWith(BASE_ASSETS_PATH) ? path.slice(BASE_ASSETS_PATH.length) : path;
+    return spriteUrls.get(key) ?? path;
+}
+
+/** Loads an image element and waits until it is decoded. */
+async function loadImage(url) {
+    const image = new Image();
+    image.src = url;
+    await image.decode();
+    return image;
+}
+
+/** Cuts the atlas sprites out into object URLs. */
+async function loadAtlas() {
+    const manifestUrl = new URL(ATLAS_MANIFEST, document.baseURI);
+    const response = await fetch(manifestUrl);
+    if (!response.ok) throw new Error(`HTTP ${response.status}`);
+    const manifest = await response.json();
+    const atlas = await loadImage(new URL(manifest.image, manifestUrl).href);
+    const canvas = document.createElement('canvas');
+    const context = canvas.getContext('2d');
+    for (const [name, { x, y, w, h }] of Object.entries(manifest.sprites)) {
+        canvas.width = w;
+        canvas.height = h;
+        context.clearRect(0, 0, w, h);
+        context.drawImage(atlas, x, y, w, h, 0, 0, w, h);
+        const blob = await new Promise(resolve => canvas.toBlob(resolve, 'image/png'));
+        if (!blob) throw new Error(`could not cut out ${name}`);
+        spriteUrls.set(name, URL.createObjectURL(blob));
+    }
+    // Decode the sprites now rather than when the board first shows them
+    await Promise.all([...spriteUrls.values()].map(url => loadImage(url).catch(() => null)));
+}
+
+/** The shared AudioContext, created on first use; null where Web Audio is missing. */
+function getAudioContext() {
+    if (audioContext) return audioContext;
+    const AudioContextClass = window.AudioContext || window.webkitAudioContext;
+    if (!AudioContextClass) return null;
+    audioContext = new AudioContextClass();
+    masterGain = audioContext.createGain();
+    masterGain.connect(audioContext.destination);
+    // Browsers start the context suspended until the page gets a user gesture
+    const resume = () => {
+        if (audioContext.state === 'suspended') audioContext.resume().catch(() => {});
+        if (audioContext.state === 'running') {
+            document.removeEventListener('pointerdown', resume);
+            document.removeEventListener('keydown', resume);
+        }
+    };
+    document.addEventListener('pointerdown', resume);
+    document.addEventListener('keydown', resume);
+    return audioContext;
+}
+
+async function loadSound(context, name) {
+    const response = await fetch(`${SOUNDS_PATH}${name}.mp3`);
+    if (!response.ok) throw new Error(`HTTP ${response.status}`);
+    const data = await response.arrayBuffer();
+    // Promise form; older Safari only has the callback form
+    const buffer = await new Promise((resolve, reject) => {
+        const promise = context.decodeAudioData(data, resolve, reject);
+        if (promise) promise.then(resolve, reject);
+    });
+    soundBuffers.set(name, buffer);
+}
+
+/**
+ * Plays a preloaded sound on a pooled voice.
+ * @returns {boolean} False if the sound is not preloaded (play it another way).
+ */
+export function playSoundEffect(name) {
+    const buffer = soundBuffers.get(name);
+    if (!buffer || !audioContext) return false;
+    if (audioContext.state === 'suspended') audioContext.resume().catch(() => {});
+    if (voices.length >= MAX_VOICES) {
+        const oldest = voices.shift();
+        oldest.onended = null;
+        try { oldest.stop(); } catch (e) { /* Already ended */ }
+    }
+    const source = audioContext.createBufferSource();
+    source.buffer = buffer;
+    source.connect(masterGain);
+    source.onended = () => {
+        const index = voices.indexOf(source);
+        if (index >= 0) voices.splice(index, 1);
+        source.disconnect();
+    };
+    voices.push(source);
+    source.start();
+    return true;
+}
+
+/**
+ * Loads the atlas, the background images and the sounds, all in parallel. Never
+ * rejects: what fails is logged and left to the fallbacks.
+ * @param {function(number, number): void} [onProgress] - Called with (loaded, total) as the assets settle.
+ * @returns {Promise<{ sprites: number, sounds: number, failed: number }>}
+ */
+export async function preloadAssets(onProgress) {
+    const startTime = performance.now();
+    const context = getAudioContext();
+    const tasks = [
+        ['sprite atlas', loadAtlas()],
+        ...BACKGROUND_IMAGES.map(url => [url, loadImage(url).then(image => { keptImages.push(image); })]),
+        ...(context ? SOUND_NAMES.map(name => [`sound ${name}`, loadSound(context, name)]) : [])
+    ];
+    let loaded = 0;
+    let failed = 0;
+    onProgress?.(0, tasks.length);
+    await Promise.all(tasks.map(([label, promise]) => promise.then(
+        () => {},
+        e => {
+            failed++;
+            console.warn(`[Assets] Could not preload ${label}:`, e?.message || e);
+        }
+    ).then(() => onProgress?.(++loaded, tasks.length))));
+    console.log(`[Assets] Preloaded ${spriteUrls.size} sprites, ${soundBuffers.size} sounds in ${Math.round(performance.now() - startTime)}ms (${failed} failed).`);
+    return { sprites: spriteUrls.size, sounds: soundBuffers.size, failed };
+}
@@ -0,0 +1,88 @@
+// js/boardLayout.js
+// Randomized starting layouts (shared by the game's "Randomize Board" button and the
+// headless tournament runner). A layout is an array of { type, player, r, c } for
+// Board.setupPiecesFromLayout.
+import { Board } from './board.js';
+import {
+    Player, BOARD_ROWS, BOARD_COLS, TERRAIN_WATER,
+    PLAYER0_DEN_ROW, PLAYER0_DEN_COL, PLAYER1_DEN_ROW, PLAYER1_DEN_COL
+} from './constants.js';
+
+const LAYOUT_ANIMAL_TYPES = ["rat", "cat", "dog", "wolf", "leopard", "tiger", "lion", "elephant"];
+
+// Shuffle utility
+function shuffleArray(array, random) {
+    for (let i = array.length - 1; i > 0; i--) {
+        const j = Math.floor(random() * (i + 1));
+        [array[i], array[j]] = [array[j], array[i]];
+    }
+}
+
+/**
+ * Places every animal of Player 1 on a random square of its half and Player 0's at the
+ * square rotated by 180 degrees, so neither side has an advantage. Only rats go into
+ * water; the dens and the centre square stay empty.
+ * @param {function(): number} [random=Math.random] - Source of numbers in [0, 1).
+ * @returns {Array<{type:string, player:number, r:number, c:number}>|null} The layout,
+ *   or null if the animals did not all fit (the caller keeps its current board).
+ */
+export function generateSymmetricLayout(random = Math.random) {
+    const tempBoardForLayout = new Board(); // Used only for terrain info
+    tempBoardForLayout.initBoard(); // Sets up terrain
+
+    const animalTypes = [...LAYOUT_ANIMAL_TYPES];
+    shuffleArray(animalTypes, random);
+
+    const candidatePrimarySpots = [];
+    const centerR = Math.floor(BOARD_ROWS / 2);
+    const centerC = Math.floor(BOARD_COLS / 2);
+
+    for (let r = 0; r < BOARD_ROWS; r++) {
+        for (let c = 0; c < BOARD_COLS; c++) {
+            const rSym = BOARD_ROWS - 1 - r;
+            const cSym = BOARD_COLS - 1 - c;
+
+            if (r === centerR && c === centerC) continue; // D5 is always skipped
+
+            const isPrimaryHalf = r < rSym || (r === rSym && c < cSym);
+            if (!isPrimaryHalf) continue;
+
+            const isP1Den = r === PLAYER1_DEN_ROW && c === PLAYER1_DEN_COL;
+            const isP0Den = r === PLAYER0_DEN_ROW && c === PLAYER0_DEN_COL;
+            if (isP1Den || isP0Den) continue;
+
+            const isSymP1Den = rSym === PLAYER1_DEN_ROW && cSym === PLAYER1_DEN_COL;
+            const isSymP0Den = rSym === PLAYER0_DEN_ROW && cSym === PLAYER0_DEN_COL;
+            if (isSymP1Den || isSymP0Den) continue;
+
+            candidatePrimarySpots.push({ r_primary: r, c_primary: c });
+        }
+    }
+    shuffleArray(candidatePrimarySpots, random);
+
+    const generatedLayout = [];
+    let currentAnimalTypeIndex = 0;
+    let primarySpotAttemptIndex = 0;
+
+    while (currentAnimalTypeIndex < animalTypes.length && primarySpotAttemptIndex < candidatePrimarySpots.length) {
+        const animalType = animalTypes[currentAnimalTypeIndex];
+        const { r_primary, c_primary } = candidatePrimarySpots[primarySpotAttemptIndex];
+        const r_symmetric = BOARD_ROWS - 1 - r_primary;
+        const c_symmetric = BOARD_COLS - 1 - c_primary;
+
+        const onWater = tempBoardForLayout.getTerrain(r_primary, c_primary) === TERRAIN_WATER ||
+                        tempBoardForLayout.getTerrain(r_symmetric, c_symmetric) === TERRAIN_WATER;
+
+        if (animalType === "rat" || !onWater) {
+            generatedLayout.push({ type: animalType, player: Player.PLAYER1, r: r_primary, c: c_primary });
+            generatedLayout.push({ type: animalType, player: Player.PLAYER0, r: r_symmetric, c: c_symmetric });
+            currentAnimalTypeIndex++;
+            candidatePrimarySpots.splice(primarySpotAttemptIndex, 1);
+        } else {
+            primarySpotAttemptIndex++;
+        }
+    }
+
+    // 8 types * 2 players
+    return generatedLayout.length === LAYOUT_ANIMAL_TYPES.length * 2 ? generatedLayout : null;
+}
@@ -54,10 +54,45 @@ export const GameStatus = {
 export const DEFAULT_LANGUAGE = 'vn';
 
 // AI Configuration (Defaults) (unchanged)
-export const aiPlayer = Player.PLAYER1; // AI is Red
+export const DEFAULT_AI_PLAYER = Player.PLAYER1; // Side the AI plays in Player vs AI (Red; changeable in the UI)
 export const DEFAULT_AI_TARGET_DEPTH = 9;
 export const DEFAULT_AI_TIME_LIMIT_MS = 1000;
 export const MIN_AI_TIME_LIMIT_MS = 100;
+export const AI_HASH_SIZE_MB = 16; // Transposition table size used by the AI worker
+export const AI_SEARCH_THREADS = 0; // Parallel search workers; 0 = one per logical core (needs cross-origin isolation)
+export const AI_MAX_SEARCH_THREADS = 8;
+// Pondering: after its move the AI keeps searching the position after the expected reply
+// (not with node budgets, which must give the same move every time)
+export const AI_PONDER = true;
+export const AI_PONDER_MAX_TIME_MS = 20000;
+export const AI_USE_OPENING_BOOK = true; // Answer known opening positions from assets/book/openings.bin
+// Evaluate with the weights tools/tuneEval.js writes to assets/eval/weights.json (none ship;
+// off, the page and the workers do not fetch it and keep the built-in weights)
+export const AI_TUNED_WEIGHTS = false;
+// Time management: the time limit is the most a move may take, and the AI moves sooner
+// when its best move is settled (see timeManager.js); off, it searches the full limit
+export const AI_TIME_MANAGEMENT = true;
+export const AI_HINT_MAX_TIME_MS = 2000; // Hints search at the AI's depth, but for at most this long
+export const AI_VS_AI_MOVE_DELAY_MS = 600; // Pause between moves in AI vs AI games, so they can be followed
+// Node budgets per target depth. When enabled they replace the time limit, so each
+// difficulty plays the same moves on fast and slow devices (the search is then single-threaded).
+export const AI_USE_NODE_BUDGET = false;
+export const AI_NODE_BUDGETS = {
+    4: 20000, 5: 50000, 6: 100000, 7: 200000,
+    8: 400000, 9: 800000, 10: 1500000, 11: 3000000
+};
+// Forward pruning per target depth (difficulty): null-move pruning and late-move reductions.
+// The low depths finish within the time limit anyway and keep the full-width search.
+export const AI_FORWARD_PRUNING = {
+    4: { nullMove: false, lateMoveReductions: false },
+    5: { nullMove: false, lateMoveReductions: false },
+    6: { nullMove: true, lateMoveReductions: false },
+    7: { nullMove: true, lateMoveReductions: false },
+    8: { nullMove: true, lateMoveReductions: true },
+    9: { nullMove: true, lateMoveReductions: true },
+    10: { nullMove: true, lateMoveReductions: true },
+    11: { nullMove: true, lateMoveReductions: true }
+};
 
 // Animation duration (unchanged)
 export const ANIMATION_DURATION = 300; // ms
@@ -102,6 +137,10 @@ export const DECORATION_CHANCE = 0.5; // 40% chance to place a decoration on a l
 export const DEN_PLAYER0_TEXTURE = BASE_ASSETS_PATH + 'images/elements/den_p1.png'; // Image for Player 0 (Blue) Den
 export const DEN_PLAYER1_TEXTURE = BASE_ASSETS_PATH + 'images/elements/den_p2.png'; // Image for Player 1 (Red) Den
 
+// Sprite atlas of the heads and decorations (generated by tools/buildAtlas.js)
+export const ATLAS_MANIFEST = BASE_ASSETS_PATH + 'atlas/sprites.json';
+export const SOUNDS_PATH = BASE_ASSETS_PATH + 'sounds/';
+
 // Tile Configuration Map
 // Describes which tile from the tileset to use based on Land (L) or Other (O) neighbors (T, L, B, R)
 // Value format: CSS background-position string "Xpx Ypx" relative to the tileset image origin (0,0)
@@ -11,10 +11,14 @@ import {
   playSound,
   updateTurnDisplay,
   updateAiDepthDisplay,
+  updateAiPlanDisplay,
+  updateSearchTelemetryDisplay,
+  showSearchTelemetry,
   updateWinChanceBar,
   animatePieceMove,
   removeLastMoveFromHistory,
   updateUndoButtonState,
+  getPlayerLabelKey,
 } from "./renderer.js";
 import { initializeLandTilePatterns, renderBoard } from "./renderBoard.js";
 import {
@@ -26,10 +30,23 @@ import {
 import {
   Player,
   GameStatus,
-  aiPlayer,
+  DEFAULT_AI_PLAYER,
   DEFAULT_AI_TARGET_DEPTH,
   DEFAULT_AI_TIME_LIMIT_MS,
   MIN_AI_TIME_LIMIT_MS,
+  AI_HASH_SIZE_MB,
+  AI_SEARCH_THREADS,
+  AI_MAX_SEARCH_THREADS,
+  AI_USE_NODE_BUDGET,
+  AI_NODE_BUDGETS,
+  AI_FORWARD_PRUNING,
+  AI_PONDER,
+  AI_PONDER_MAX_TIME_MS,
+  AI_USE_OPENING_BOOK,
+  AI_TUNED_WEIGHTS,
+  AI_TIME_MANAGEMENT,
+  AI_HINT_MAX_TIME_MS,
+  AI_VS_AI_MOVE_DELAY_MS,
   PIECES,
   ANIMATION_DURATION,
   getPieceKey,
@@ -46,8 +63,13 @@ import {
   PLAYER1_DEN_COL,
 } from "./constants.js";
 import * as rules from "./rules.js";
-import { evaluateBoard } from "./aiEvaluate.js";
+import { evaluateBoard, loadEvalParams, EVAL_WEIGHTS_URL } from "./aiEvaluate.js";
+import { AiSearchPool, resolveSearchThreadCount } from "./aiSearchPool.js";
+import { fetchTablebasePack, TABLEBASE_PACK_URL } from "./tablebase.js";
+import { SearchTelemetry } from "./searchTelemetry.js";
 import { initializeZobrist, computeZobristKey } from "./zobrist.js";
+import { generateSymmetricLayout } from "./boardLayout.js";
+import { GameRecord, encodePlacement, parseNotation } from "./gameRecord.js";
 
 // --- Module State ---
 let board = new Board();
@@ -57,14 +79,16 @@ let gameStatus = GameStatus.INIT;
 let validMovesCache = [];
 let isGameOver = false;
 let isAiThinking = false;
+let aiRequest = null; // { kind: 'move' | 'hint', player } of the search in progress
+let aiPlayer = DEFAULT_AI_PLAYER; // Side the AI plays in 'PVA'
 let aiWorker = null;
 let lastMove = null;
 let capturedByPlayer0 = [];
 let capturedByPlayer1 = [];
 let moveHistory = [];
 let lastEvalScore = null;
-let gameStateHistory = [];
-let repetitionMap = new Map();
+let gameRecord = null; // Move log of the game, with an undo record per move (gameRecord.js)
+const searchTelemetry = new SearchTelemetry(); // Performance log of the session's searches
 
 // --- UI Cache ---
 let difficultySelect;
@@ -73,23 +97,23 @@ let resetButton;
 let langSelect;
 let gameModeSelect;
 let playerStartsSelect;
+let aiSideSelect;
 let aiControlsContainer;
 let undoButton;
+let hintButton;
 let randomizeBoardButton;
+let telemetryToggle;
+let telemetryExportButton;
+let exportGameButton;
+let importGameButton;
 let aiTargetDepth = DEFAULT_AI_TARGET_DEPTH;
 let aiTimeLimitMs = DEFAULT_AI_TIME_LIMIT_MS;
+let aiNewGamePending = true; // Tells the worker to drop its transposition table on the next request
+let aiPonderReply = null; // Expected reply from the AI's last principal variation, pondered after its move
 
 const STANDARD_LAYOUT_ID = "STANDARD_LAYOUT";
 let initialBoardLayoutConfig = STANDARD_LAYOUT_ID; // Default to standard game setup
 
-// Shuffle utility
-function shuffleArray(array) {
-  for (let i = array.length - 1; i > 0; i--) {
-    const j = Math.floor(Math.random() * (i + 1));
-    [array[i], array[j]] = [array[j], array[i]];
-  }
-}
-
 // List of all game pieces - not used by current randomize but could be for other variants
 const ALL_GAME_PIECES_FOR_PLAYERS = [];
 (() => {
@@ -102,6 +126,12 @@ const ALL_GAME_PIECES_FOR_PLAYERS = [];
 
 // --- Initialize Zobrist Hashing ---
 initializeZobrist();
+// The win chance bar evaluates with the same weights as the AI worker; main.js waits
+// for them before the first game, so no move is scored with the built-in ones first
+export const evalParamsReady = AI_TUNED_WEIGHTS ? loadEvalParams(EVAL_WEIGHTS_URL) : Promise.resolve(false);
+
+// Endgame tables, fetched once and handed to every pool
+const tablebasePack = fetchTablebasePack(TABLEBASE_PACK_URL);
 
 // --- AI Worker ---
 function initializeAiWorker() {
@@ -111,30 +141,74 @@ function initializeAiWorker() {
     aiWorker = null;
   }
   try {
-    aiWorker = new Worker("js/aiWorker.js", { type: "module" });
-    console.log("[Main] AI Worker created successfully (as module).");
+    // A node budget only gives reproducible play with a single search thread
+    const threads = AI_USE_NODE_BUDGET ? 1 : resolveSearchThreadCount(AI_SEARCH_THREADS, AI_MAX_SEARCH_THREADS);
+    aiWorker = new AiSearchPool(threads, AI_HASH_SIZE_MB);
+    console.log(`[Main] AI Worker created successfully (as module, ${threads} search thread(s)).`);
     aiWorker.onmessage = handleAiWorkerMessage;
     aiWorker.onerror = handleAiWorkerError;
+    aiWorker.onprogress = handleAiWorkerProgress;
+    const pool = aiWorker;
+    tablebasePack.then(pack => { if (pack && aiWorker === pool) pool.attachTablebases(pack); });
   } catch (e) {
     console.error("Failed to create AI Worker:", e);
     updateStatus("errorWorkerInit", {}, true);
-    setGameOver(Player.PLAYER0, GameStatus.PLAYER0_WINS);
+    forfeitAiGame(aiPlayer);
     updateWinChanceBar(null);
   }
 }
 
+/** Whether the AI moves for `player` in the current game mode. */
+function isAiControlled(player) {
+  const mode = gameModeSelect?.value;
+  return mode === "AVA" || (mode === "PVA" && player === aiPlayer);
+}
+
+/** Ends the game after an AI failure: the side the AI was moving for loses. */
+function forfeitAiGame(side) {
+  const winner = Player.getOpponent(side);
+  setGameOver(
+    winner,
+    winner === Player.PLAYER0 ? GameStatus.PLAYER0_WINS : GameStatus.PLAYER1_WINS
+  );
+}
+
+/** Shows a completed iteration of the running search (depth and plan while the AI moves). */
+function handleAiWorkerProgress(report) {
+  if (!isAiThinking) return;
+  updateSearchTelemetryDisplay(searchTelemetry.recordProgress(report));
+  if (aiRequest?.kind === "move") {
+    updateAiDepthDisplay(report.depthAchieved);
+    updateAiPlanDisplay(report.pv);
+  }
+}
+
 function handleAiWorkerMessage(e) {
+  updateSearchTelemetryDisplay(searchTelemetry.finishSearch(e.data));
   isAiThinking = false;
+  const request = aiRequest || { kind: "move", player: currentPlayer };
+  aiRequest = null;
   const {
     move: bestMoveData,
     depthAchieved,
     nodes,
     eval: score,
+    pv,
+    ponderHit,
+    bookMove,
     error,
   } = e.data;
-  updateAiDepthDisplay(depthAchieved ?? "?");
+  if (request.kind === "hint") {
+    showHint(bestMoveData, error);
+    return;
+  }
+  if (ponderHit) console.log("[Main] AI answered from its ponder search.");
+  aiPonderReply = Array.isArray(pv) && pv.length > 1 ? pv[1] : null;
+  updateAiDepthDisplay(bookMove ? getString("aiDepthBook") : depthAchieved ?? "?");
+  updateAiPlanDisplay(pv);
   if (score !== null && score !== undefined && isFinite(score)) {
-    lastEvalScore = score;
+    // The search scores for the side it moved; the bar shows Player 1's view
+    lastEvalScore = request.player === Player.PLAYER1 ? score : -score;
     updateWinChanceBar(lastEvalScore);
   } else if (!error) {
     lastEvalScore = null;
@@ -151,10 +225,10 @@ function handleAiWorkerMessage(e) {
         ? "errorAIMove"
         : "errorAIWorker";
     updateStatus(errorKey, {}, true);
-    setGameOver(Player.PLAYER0, GameStatus.PLAYER0_WINS);
+    forfeitAiGame(request.player);
     playSound("victory");
     renderBoard(board.getState(), handleSquareClick, lastMove);
-    updateTurnDisplay(currentPlayer, gameModeSelect.value, isGameOver);
+    updateTurnDisplay(currentPlayer, gameModeSelect.value, isGameOver, aiPlayer);
     return;
   }
   if (bestMoveData) {
@@ -164,7 +238,7 @@ function handleAiWorkerMessage(e) {
     );
     if (
       pieceToMove &&
-      pieceToMove.player === aiPlayer &&
+      pieceToMove.player === request.player &&
       pieceToMove.name === bestMoveData.pieceName
     ) {
       const targetPiece = board.getPiece(
@@ -181,27 +255,30 @@ function handleAiWorkerMessage(e) {
       );
     } else {
       updateStatus("errorAISync", {}, true);
-      setGameOver(Player.PLAYER0, GameStatus.PLAYER0_WINS);
+      forfeitAiGame(request.player);
       playSound("victory");
       renderBoard(board.getState(), handleSquareClick, lastMove);
-      updateTurnDisplay(currentPlayer, gameModeSelect.value, isGameOver);
+      updateTurnDisplay(currentPlayer, gameModeSelect.value, isGameOver, aiPlayer);
     }
   } else {
     const allAiMoves = rules.getAllValidMoves(
-      aiPlayer,
+      request.player,
       board.getClonedStateForWorker()
     );
+    forfeitAiGame(request.player);
     if (allAiMoves.length === 0) {
-      updateStatus("statusWin", { winner: getString("player1Name") }, false);
-      setGameOver(Player.PLAYER0, GameStatus.PLAYER0_WINS);
-      playSound("victory");
+      const winnerKey = getPlayerLabelKey(
+        Player.getOpponent(request.player),
+        gameModeSelect.value,
+        aiPlayer
+      );
+      updateStatus("statusWin", { winner: getString(winnerKey) }, false);
     } else {
       updateStatus("errorAIMove", {}, true);
-      setGameOver(Player.PLAYER0, GameStatus.PLAYER0_WINS);
-      playSound("victory");
     }
+    playSound("victory");
     renderBoard(board.getState(), handleSquareClick, lastMove);
-    updateTurnDisplay(currentPlayer, gameModeSelect.value, isGameOver);
+    updateTurnDisplay(currentPlayer, gameModeSelect.value, isGameOver, aiPlayer);
   }
 }
 
@@ -211,11 +288,14 @@ function handleAiWorkerError(event) {
     event
   );
   updateStatus("errorAIWorker", {}, true);
+  const request = aiRequest || { kind: "move", player: currentPlayer };
   isAiThinking = false;
+  aiRequest = null;
   lastEvalScore = null;
   updateWinChanceBar(lastEvalScore);
-  if (!isGameOver) {
-    setGameOver(Player.PLAYER0, GameStatus.PLAYER0_WINS);
+  // A failed hint search costs the player nothing
+  if (!isGameOver && request.kind === "move") {
+    forfeitAiGame(request.player);
     playSound("victory");
     renderBoard(board.getState(), handleSquareClick, lastMove);
   }
@@ -237,10 +317,20 @@ export function initGame() {
   aiControlsContainer =
     aiControlsContainer || document.getElementById("ai-controls");
   undoButton = undoButton || document.getElementById("undo-button");
+  hintButton = hintButton || document.getElementById("hint-button");
+  aiSideSelect = aiSideSelect || document.getElementById("ai-side-select");
   playerStartsSelect =
     playerStartsSelect || document.getElementById("player-starts-select");
   randomizeBoardButton =
     randomizeBoardButton || document.getElementById("randomize-board-button");
+  telemetryToggle =
+    telemetryToggle || document.getElementById("telemetry-toggle");
+  telemetryExportButton =
+    telemetryExportButton || document.getElementById("telemetry-export-button");
+  exportGameButton =
+    exportGameButton || document.getElementById("export-game-button");
+  importGameButton =
+    importGameButton || document.getElementById("import-game-button");
 
   // Initialize board object (terrain setup, clear pieces)
   board.initBoard(); // Assumes this now prepares terrain and clears existing pieces
@@ -266,19 +356,23 @@ export function initGame() {
     console.log("[Main] Resetting during AI calculation, terminating worker.");
     aiWorker.terminate();
     initializeAiWorker();
+  } else {
+    aiWorker.stopPonder();
   }
+  aiPonderReply = null;
 
   selectedPieceInfo = null;
+  aiNewGamePending = true;
   gameStatus = GameStatus.ONGOING;
   validMovesCache = [];
   isGameOver = false;
   isAiThinking = false;
+  aiRequest = null;
   lastMove = null;
   capturedByPlayer0 = [];
   capturedByPlayer1 = [];
   moveHistory = [];
   lastEvalScore = null;
-  gameStateHistory = [];
   updateUndoButtonState(false);
 
   const startingPlayerValue = playerStartsSelect
@@ -286,23 +380,24 @@ export function initGame() {
     : Player.PLAYER0;
   currentPlayer =
     startingPlayerValue === Player.PLAYER1 ? Player.PLAYER1 : Player.PLAYER0;
+  const aiSideValue = aiSideSelect
+    ? parseInt(aiSideSelect.value, 10)
+    : DEFAULT_AI_PLAYER;
+  aiPlayer = aiSideValue === Player.PLAYER0 ? Player.PLAYER0 : Player.PLAYER1;
 
-  repetitionMap.clear();
+  let initialHash = null;
   try {
-    const currentBoardStateForHash = board.getState();
-    const initialHash = computeZobristKey(
-      currentBoardStateForHash,
-      currentPlayer
-    );
-    repetitionMap.set(initialHash, 1);
+    initialHash = computeZobristKey(board.getState(), currentPlayer);
     console.log(
-      `Board hash ${initialHash} (Player ${currentPlayer} to move) added to repetition map (Count: 1).`
+      `Board hash ${initialHash} (Player ${currentPlayer} to move) starts the game record.`
     );
   } catch (e) {
     console.error("Error calculating initial Zobrist hash:", e);
   }
+  gameRecord = new GameRecord(encodePlacement(board.getState()), currentPlayer, initialHash);
 
   updateAiDepthDisplay("0");
+  updateAiPlanDisplay(null);
   if (difficultySelect) difficultySelect.value = aiTargetDepth.toString();
   if (timeLimitInput) timeLimitInput.value = aiTimeLimitMs.toString();
 
@@ -315,12 +410,7 @@ export function initGame() {
   setupUIListeners();
   console.log("Game Initialized. Current Turn:", currentPlayer);
 
-  if (
-    !isGameOver &&
-    gameModeSelect?.value === "PVA" &&
-    currentPlayer === aiPlayer &&
-    !isAiThinking
-  ) {
+  if (!isGameOver && isAiControlled(currentPlayer) && !isAiThinking) {
     setTimeout(triggerAiTurn, 250);
   }
 }
@@ -357,25 +447,40 @@ function setupUIListeners() {
   gameModeSelect?.addEventListener("change", () => {
     const newMode = gameModeSelect.value;
     if (aiControlsContainer)
-      aiControlsContainer.style.display = newMode === "PVA" ? "flex" : "none";
+      aiControlsContainer.style.display = newMode === "PVP" ? "none" : "flex";
     if (isAiThinking) {
       if (aiWorker) aiWorker.terminate();
       aiWorker = null;
       isAiThinking = false;
+      aiRequest = null;
       initializeAiWorker();
+    } else if (aiWorker) {
+      aiWorker.stopPonder();
     }
+    aiPonderReply = null;
     updateGameStatusUI();
-    if (!isGameOver && newMode === "PVA" && currentPlayer === aiPlayer)
+    if (!isGameOver && isAiControlled(currentPlayer))
       setTimeout(triggerAiTurn, 150);
   });
   undoButton?.addEventListener("click", () => undoMove());
+  hintButton?.addEventListener("click", () => requestHint());
   if (aiControlsContainer && gameModeSelect)
     aiControlsContainer.style.display =
-      gameModeSelect.value === "PVA" ? "flex" : "none";
+      gameModeSelect.value === "PVP" ? "none" : "flex";
   playerStartsSelect?.addEventListener("change", () => {
     initGame();
   });
+  aiSideSelect?.addEventListener("change", () => {
+    initGame();
+  });
   randomizeBoardButton?.addEventListener("click", handleRandomizeBoard);
+  telemetryToggle?.addEventListener("change", () => {
+    showSearchTelemetry(telemetryToggle.checked);
+  });
+  if (telemetryToggle) showSearchTelemetry(telemetryToggle.checked);
+  telemetryExportButton?.addEventListener("click", exportSearchTelemetry);
+  exportGameButton?.addEventListener("click", exportGame);
+  importGameButton?.addEventListener("click", importGame);
 }
 setupUIListeners.alreadyRun = false;
 
@@ -386,109 +491,12 @@ function handleRandomizeBoard() {
     console.log("AI is thinking, terminating worker before randomizing.");
     if (aiWorker) aiWorker.terminate();
     isAiThinking = false;
+    aiRequest = null;
     initializeAiWorker();
   }
 
-  const tempBoardForLayout = new Board(); // Used only for terrain info
-  tempBoardForLayout.initBoard(); // Sets up terrain
-
-  const animalTypes = [
-    "rat",
-    "cat",
-    "dog",
-    "wolf",
-    "leopard",
-    "tiger",
-    "lion",
-    "elephant",
-  ];
-  shuffleArray(animalTypes);
-
-  const candidatePrimarySpots = [];
-  const centerR = Math.floor(BOARD_ROWS / 2);
-  const centerC = Math.floor(BOARD_COLS / 2);
-  const d5Key = `${centerR}-${centerC}`;
-
-  for (let r = 0; r < BOARD_ROWS; r++) {
-    for (let c = 0; c < BOARD_COLS; c++) {
-      const currentKey = `${r}-${c}`;
-      const rSym = BOARD_ROWS - 1 - r;
-      const cSym = BOARD_COLS - 1 - c;
-
-      if (currentKey === d5Key) continue; // D5 is always skipped
-
-      const isPrimaryHalf = r < rSym || (r === rSym && c < cSym);
-
-      if (isPrimaryHalf) {
-        const isP1Den = r === PLAYER1_DEN_ROW && c === PLAYER1_DEN_COL;
-        const isP0Den = r === PLAYER0_DEN_ROW && c === PLAYER0_DEN_COL;
-        if (isP1Den || isP0Den) continue;
-
-        const isSymP1Den = rSym === PLAYER1_DEN_ROW && cSym === PLAYER1_DEN_COL;
-        const isSymP0Den = rSym === PLAYER0_DEN_ROW && cSym === PLAYER0_DEN_COL;
-        if (isSymP1Den || isSymP0Den) continue;
-
-        candidatePrimarySpots.push({ r_primary: r, c_primary: c });
-      }
-    }
-  }
-  shuffleArray(candidatePrimarySpots);
-
-  const generatedLayout = [];
-  let currentAnimalTypeIndex = 0;
-  let primarySpotAttemptIndex = 0;
-
-  while (
-    currentAnimalTypeIndex < animalTypes.length &&
-    primarySpotAttemptIndex < candidatePrimarySpots.length
-  ) {
-    const animalType = animalTypes[currentAnimalTypeIndex];
-    const primaryCandidate = candidatePrimarySpots[primarySpotAttemptIndex];
-
-    const r_primary = primaryCandidate.r_primary;
-    const c_primary = primaryCandidate.c_primary;
-    const r_symmetric = BOARD_ROWS - 1 - r_primary;
-    const c_symmetric = BOARD_COLS - 1 - c_primary;
-
-    const terrain_primary = tempBoardForLayout.getTerrain(r_primary, c_primary);
-    const terrain_symmetric = tempBoardForLayout.getTerrain(
-      r_symmetric,
-      c_symmetric
-    );
-
-    let placementValidForThisAnimalType = true;
-    if (animalType !== "rat") {
-      if (
-        terrain_primary === TERRAIN_WATER ||
-        terrain_symmetric === TERRAIN_WATER
-      ) {
-        placementValidForThisAnimalType = false;
-      }
-    }
-
-    if (placementValidForThisAnimalType) {
-      generatedLayout.push({
-        type: animalType,
-        player: Player.PLAYER1,
-        r: r_primary,
-        c: c_primary,
-      });
-      generatedLayout.push({
-        type: animalType,
-        player: Player.PLAYER0,
-        r: r_symmetric,
-        c: c_symmetric,
-      });
-
-      currentAnimalTypeIndex++;
-      candidatePrimarySpots.splice(primarySpotAttemptIndex, 1);
-    } else {
-      primarySpotAttemptIndex++;
-    }
-  }
-
-  if (generatedLayout.length < 16) {
-    // 8 types * 2 players
+  const generatedLayout = generateSymmetricLayout();
+  if (!generatedLayout) {
     console.error(
       "Could not generate a full valid symmetric layout. Sticking to current/standard board."
     );
@@ -503,32 +511,66 @@ function handleRandomizeBoard() {
   initGame();
 }
 
-function saveCurrentStateToHistory() {
+/**
+ * Zobrist keys of the game positions before the current one, oldest first, for the
+ * AI's repetition detection. Only positions since the last capture are included:
+ * earlier ones have more pieces and cannot repeat.
+ */
+function getRepetitionHistory() {
+  const keys = gameRecord.keysSinceCapture();
+  keys.pop(); // The current position itself
+  return keys;
+}
+
+/**
+ * Adds the move just played on the board (by `currentPlayer`) to the game record.
+ * Its evaluation is filled in by postMoveChecks.
+ */
+function recordMove(piece, fromRow, fromCol, toRow, toCol, capturedPiece) {
+  let hash = null;
   try {
-    const currentState = board.getClonedStateForWorker();
-    const playerWhoJustMoved = currentPlayer;
-    const nextPlayerTurn = Player.getOpponent(playerWhoJustMoved);
-    const hashOfCurrentStateAndNextTurn = computeZobristKey(
-      currentState,
-      nextPlayerTurn
-    );
-    const stateEntry = {
-      boardState: currentState,
-      currentPlayer: nextPlayerTurn,
-      capturedP0: [...capturedByPlayer0],
-      capturedP1: [...capturedByPlayer1],
-      lastMove: lastMove ? { ...lastMove } : null,
-      lastEval: lastEvalScore,
-      isGameOver: isGameOver,
-      gameStatus: gameStatus,
-      hashOfThisState: hashOfCurrentStateAndNextTurn,
-    };
-    gameStateHistory.push(stateEntry);
-    updateUndoButtonState(true);
+    hash = computeZobristKey(board.getState(), Player.getOpponent(currentPlayer));
   } catch (error) {
-    console.error("Error saving game state to history:", error);
-    updateUndoButtonState(false);
+    console.error("Error hashing the position for the game record:", error);
+  }
+  gameRecord.push({
+    from: { r: fromRow, c: fromCol },
+    to: { r: toRow, c: toCol },
+    piece: { type: piece.type, player: piece.player },
+    captured: capturedPiece ? { type: capturedPiece.type, player: capturedPiece.player } : null,
+    hash,
+    eval: null,
+  });
+  updateUndoButtonState(true);
+}
+
+/** Takes the last move of the game record back on the board and the captured lists. */
+function unwindLastMove() {
+  const entry = gameRecord.pop();
+  if (!entry) return null;
+  const piece = board.getPiece(entry.to.r, entry.to.c);
+  board.setPiece(entry.from.r, entry.from.c, piece);
+  board.setPiece(
+    entry.to.r,
+    entry.to.c,
+    entry.captured
+      ? new Piece(entry.captured.type, entry.captured.player, entry.to.r, entry.to.c)
+      : null
+  );
+  if (entry.captured) {
+    if (entry.piece.player === Player.PLAYER0) capturedByPlayer0.pop();
+    else capturedByPlayer1.pop();
   }
+  currentPlayer = entry.piece.player;
+  return entry;
+}
+
+/** lastMove of the position after the record's last move (null at the start). */
+function lastMoveOfRecord() {
+  const entry = gameRecord.last();
+  return entry
+    ? { start: { ...entry.from }, end: { ...entry.to }, player: entry.piece.player }
+    : null;
 }
 
 function selectPiece(piece, row, col) {
@@ -564,7 +606,7 @@ function handleSquareClick(row, col) {
   if (
     isGameOver ||
     isAiThinking ||
-    (gameModeSelect.value === "PVA" && currentPlayer === aiPlayer)
+    isAiControlled(currentPlayer)
   )
     return;
   const clickedPiece = board.getPiece(row, col);
@@ -640,8 +682,8 @@ function performMoveWithAnimation(piece, toRow, toCol, fromRow, fromCol, targetP
     // 1. Update logical board state
     updateBoardState(piece, toRow, toCol, fromRow, fromCol, capturedPieceData);
 
-    // 2. Save state to history
-    saveCurrentStateToHistory();
+    // 2. Add the move to the game record
+    recordMove(piece, fromRow, fromCol, toRow, toCol, capturedPieceData);
 
     // 3. Add to visual move list
     addMoveToHistory(piece, fromRow, fromCol, toRow, toCol, capturedPieceData);
@@ -686,6 +728,27 @@ function performMoveWithAnimation(piece, toRow, toCol, fromRow, fromCol, targetP
     });
 }
 
+/**
+ * Bookkeeping after a move in a game that goes on: evaluates the position (kept in the
+ * move's record), passes the turn and applies the threefold repetition rule.
+ * @returns {boolean} True if the game ended in a draw by repetition.
+ */
+function advanceTurn() {
+  try {
+    const boardStateForEval = board.getClonedStateForWorker();
+    lastEvalScore = evaluateBoard(boardStateForEval);
+  } catch (e) {
+    lastEvalScore = null;
+  }
+  gameRecord.last().eval = lastEvalScore;
+  switchPlayer();
+  if (gameRecord.repetitionCount() >= 3) {
+    setGameOver(Player.NONE, GameStatus.DRAW);
+    return true;
+  }
+  return false;
+}
+
 function postMoveChecks() {
   renderBoard(board.getState(), handleSquareClick, lastMove);
   renderCapturedPieces(capturedByPlayer0, capturedByPlayer1);
@@ -706,47 +769,49 @@ function postMoveChecks() {
         : 0
     );
     let soundToPlay = "defeat";
-    if (winner === Player.PLAYER0) soundToPlay = "victory";
     if (winner === Player.NONE || currentStatus === GameStatus.DRAW)
       soundToPlay = "draw";
-    if (gameModeSelect.value === "PVP" && winner !== Player.NONE)
+    else if (gameModeSelect.value !== "PVA" || winner !== aiPlayer)
       soundToPlay = "victory";
     playSound(soundToPlay);
     updateGameStatusUI();
     return;
   }
-  try {
-    const boardStateForEval = board.getClonedStateForWorker();
-    lastEvalScore = evaluateBoard(boardStateForEval);
-  } catch (e) {
-    lastEvalScore = null;
-  }
+  const repetitionDraw = advanceTurn();
   updateWinChanceBar(lastEvalScore);
-  switchPlayer();
-  try {
-    const currentHash = computeZobristKey(board.getState(), currentPlayer);
-    const count = (repetitionMap.get(currentHash) || 0) + 1;
-    repetitionMap.set(currentHash, count);
-    if (count >= 3) {
-      setGameOver(Player.NONE, GameStatus.DRAW);
-      playSound("draw");
-      updateGameStatusUI();
-      return;
-    }
-  } catch (e) {
-    console.error("Error checking repetition:", e);
+  if (repetitionDraw) {
+    playSound("draw");
+    updateGameStatusUI();
+    return;
   }
   updateGameStatusUI();
-  if (
-    !isGameOver &&
-    gameModeSelect.value === "PVA" &&
-    currentPlayer === aiPlayer &&
-    !isAiThinking
-  ) {
-    setTimeout(triggerAiTurn, 150);
+  if (!isGameOver && isAiControlled(currentPlayer) && !isAiThinking) {
+    const delay = gameModeSelect.value === "AVA" ? AI_VS_AI_MOVE_DELAY_MS : 150;
+    setTimeout(triggerAiTurn, delay);
+  } else if (!isGameOver && gameModeSelect.value === "PVA") {
+    startAiPondering();
   }
 }
 
+/**
+ * While the player thinks, lets the AI search the position after the reply it expects
+ * (from its last principal variation). Once per AI move.
+ */
+function startAiPondering() {
+  const reply = aiPonderReply;
+  aiPonderReply = null;
+  if (!AI_PONDER || AI_USE_NODE_BUDGET || !reply || !aiWorker) return;
+  aiWorker.ponder({
+    boardState: board.getState(),
+    sideToMove: currentPlayer,
+    reply: reply,
+    targetDepth: aiTargetDepth,
+    maxTimeMs: AI_PONDER_MAX_TIME_MS,
+    gameHistory: getRepetitionHistory(),
+    pruning: AI_FORWARD_PRUNING[aiTargetDepth],
+  });
+}
+
 function switchPlayer() {
   currentPlayer = Player.getOpponent(currentPlayer);
   deselectPiece();
@@ -761,35 +826,27 @@ function setGameOver(winner, status) {
 function updateGameStatusUI() {
   let statusKey = "statusLoading";
   let statusParams = {};
-  let displayPlayerLabel = "";
-  if (gameModeSelect.value === "PVP") {
-    displayPlayerLabel = getString(
-      currentPlayer === Player.PLAYER0 ? "player1Name" : "player2Name"
-    );
-  } else {
-    displayPlayerLabel = getString(
-      currentPlayer === Player.PLAYER0 ? "playerName" : "aiName"
-    );
-  }
+  const mode = gameModeSelect.value;
+  const displayPlayerLabel = getString(
+    getPlayerLabelKey(currentPlayer, mode, aiPlayer)
+  );
   if (isGameOver) {
     if (gameStatus === GameStatus.DRAW) {
       statusKey = "statusDrawRepetition";
     } else {
       let winnerLabel = "";
       if (gameStatus === GameStatus.PLAYER0_WINS)
-        winnerLabel = getString("player1Name");
-      else if (gameStatus === GameStatus.PLAYER1_WINS) {
-        winnerLabel =
-          gameModeSelect.value === "PVA"
-            ? getString("aiName")
-            : getString("player2Name");
-      }
+        winnerLabel = getString(getPlayerLabelKey(Player.PLAYER0, mode, aiPlayer));
+      else if (gameStatus === GameStatus.PLAYER1_WINS)
+        winnerLabel = getString(getPlayerLabelKey(Player.PLAYER1, mode, aiPlayer));
       statusKey = "statusWin";
       statusParams = { winner: winnerLabel };
     }
+  } else if (isAiThinking && aiRequest?.kind === "hint") {
+    statusKey = "statusHintThinking";
   } else if (isAiThinking) {
     statusKey = "statusAIThinking";
-    statusParams = { aiName: getString("aiName") };
+    statusParams = { aiName: displayPlayerLabel };
   } else if (selectedPieceInfo) {
     statusKey = "statusPlayerSelected";
     const pieceLocaleKey = `animal_${selectedPieceInfo.piece.type}`;
@@ -804,132 +861,214 @@ function updateGameStatusUI() {
     statusParams = { player: displayPlayerLabel };
   }
   updateStatus(statusKey, statusParams);
-  updateTurnDisplay(currentPlayer, gameModeSelect.value, isGameOver);
+  updateTurnDisplay(currentPlayer, mode, isGameOver, aiPlayer);
 }
 
 function triggerAiTurn() {
-  if (isGameOver || isAiThinking || currentPlayer !== aiPlayer || !aiWorker) {
+  if (isGameOver || isAiThinking || !isAiControlled(currentPlayer) || !aiWorker) {
     return;
   }
+  requestAiSearch("move", aiTimeLimitMs);
+}
+
+/** Searches for the player to move and shows the best move on the board instead of playing it. */
+function requestHint() {
+  if (isGameOver || isAiThinking || isAiControlled(currentPlayer) || !aiWorker) {
+    return;
+  }
+  deselectPiece();
+  clearHighlights("hint-move");
+  requestAiSearch("hint", Math.min(aiTimeLimitMs, AI_HINT_MAX_TIME_MS));
+}
+
+/** Starts a search for `currentPlayer`; its result is handled by handleAiWorkerMessage. */
+function requestAiSearch(kind, timeLimitMs) {
   isAiThinking = true;
+  aiRequest = { kind, player: currentPlayer };
   updateGameStatusUI();
-  updateAiDepthDisplay("-");
+  if (kind === "move") updateAiDepthDisplay("-");
   let boardStateForWorker;
   try {
-    boardStateForWorker = board.getClonedStateForWorker();
+    // The pool packs the squares into its message at once, so no copy is needed
+    boardStateForWorker = board.getState();
   } catch (e) {
     updateStatus("errorBoardClone", {}, true);
     isAiThinking = false;
+    aiRequest = null;
+    if (kind === "hint") return;
     lastEvalScore = null;
     updateWinChanceBar(lastEvalScore);
-    setGameOver(Player.PLAYER0, GameStatus.PLAYER0_WINS);
+    forfeitAiGame(currentPlayer);
     playSound("victory");
     return;
   }
+  const nodeLimit = AI_USE_NODE_BUDGET ? AI_NODE_BUDGETS[aiTargetDepth] || 0 : 0;
+  searchTelemetry.beginSearch({
+    kind,
+    player: currentPlayer,
+    ply: gameRecord.length,
+    targetDepth: aiTargetDepth,
+    timeLimitMs: nodeLimit > 0 ? null : timeLimitMs,
+    nodeLimit,
+    threads: aiWorker.threadCount,
+  });
   aiWorker.postMessage({
     boardState: boardStateForWorker,
+    sideToMove: currentPlayer,
     targetDepth: aiTargetDepth,
-    timeLimit: aiTimeLimitMs,
+    timeLimit: nodeLimit > 0 ? Infinity : timeLimitMs,
+    nodeLimit: nodeLimit,
+    gameHistory: getRepetitionHistory(),
+    pruning: AI_FORWARD_PRUNING[aiTargetDepth],
+    hashSizeMb: AI_HASH_SIZE_MB,
+    newGame: aiNewGamePending,
+    useBook: AI_USE_OPENING_BOOK,
+    timeManagement: AI_TIME_MANAGEMENT,
+    keepPonder: kind === "hint", // The AI's pondering for its next move goes on
   });
+  aiNewGamePending = false;
+}
+
+/** Downloads the performance log of the session's searches as JSON. */
+function exportSearchTelemetry() {
+  const blob = new Blob([searchTelemetry.exportJson()], { type: "application/json" });
+  const link = document.createElement("a");
+  link.href = URL.createObjectURL(blob);
+  link.download = `jungle-chess-search-log-${Date.now()}.json`;
+  link.click();
+  setTimeout(() => URL.revokeObjectURL(link.href), 0);
+}
+
+/** Highlights the squares of a hint search's move. */
+function showHint(moveData, error) {
+  updateGameStatusUI();
+  if (error || !moveData) {
+    console.error("[Main] Hint search failed:", error || "no move");
+    return;
+  }
+  highlightSquare(moveData.fromRow, moveData.fromCol, "hint-move");
+  highlightSquare(moveData.toRow, moveData.toCol, "hint-move");
 }
 
 function undoMove() {
   if (isAiThinking) {
     if (aiWorker) aiWorker.terminate();
     isAiThinking = false;
+    aiRequest = null;
     initializeAiWorker();
+  } else if (aiWorker) {
+    aiWorker.stopPonder();
   }
-  let undoCount = 0;
+  aiPonderReply = null;
+  // In Player vs AI a move of the AI is taken back together with the player's move before it
   const mode = gameModeSelect?.value || "PVA";
-  if (gameStateHistory.length > 0) {
-    undoCount = 1;
-    if (mode === "PVA" && gameStateHistory.length >= 2) {
-      const stateBeforeLast = gameStateHistory[gameStateHistory.length - 2];
-      if (stateBeforeLast.currentPlayer === aiPlayer) {
-        undoCount = 2;
-      }
-    }
+  const lastEntry = gameRecord.last();
+  let undoCount = lastEntry ? 1 : 0;
+  if (mode === "PVA" && gameRecord.length >= 2 && lastEntry.piece.player === aiPlayer) {
+    undoCount = 2;
   }
-  if (undoCount === 0 || gameStateHistory.length < undoCount) {
-    updateUndoButtonState(gameStateHistory.length > 0);
+  if (undoCount === 0) {
+    updateUndoButtonState(false);
     return;
   }
-  let stateToRestoreData = null;
   for (let i = 0; i < undoCount; i++) {
-    if (gameStateHistory.length === 0) {
-      initGame();
-      return;
-    }
-    const poppedStateData = gameStateHistory.pop();
-    if (poppedStateData && poppedStateData.hashOfThisState) {
-      const hashToDecrement = poppedStateData.hashOfThisState;
-      try {
-        let currentCount = repetitionMap.get(hashToDecrement);
-        if (currentCount !== undefined && currentCount > 0) {
-          currentCount--;
-          if (currentCount === 0) {
-            repetitionMap.delete(hashToDecrement);
-          } else {
-            repetitionMap.set(hashToDecrement, currentCount);
-          }
-        }
-      } catch (e) {
-        console.error("Error decrementing repetition map:", e);
-      }
-    }
+    unwindLastMove();
     removeLastMoveFromHistory();
   }
-  if (gameStateHistory.length === 0) {
-    initGame();
-    return;
-  } else {
-    stateToRestoreData = gameStateHistory[gameStateHistory.length - 1];
+  // A position a move was played from was not over yet
+  lastMove = lastMoveOfRecord();
+  lastEvalScore = gameRecord.last()?.eval ?? null;
+  isGameOver = false;
+  gameStatus = GameStatus.ONGOING;
+  deselectPiece();
+  renderBoard(board.getState(), handleSquareClick, lastMove);
+  renderCapturedPieces(capturedByPlayer0, capturedByPlayer1);
+  updateGameStatusUI();
+  updateWinChanceBar(lastEvalScore);
+  updateUndoButtonState(gameRecord.length > 0);
+  // AI vs AI carries on from the restored position
+  if (!isGameOver && isAiControlled(currentPlayer))
+    setTimeout(triggerAiTurn, AI_VS_AI_MOVE_DELAY_MS);
+}
+
+/** Copies the game in notation (gameRecord.js) to the clipboard, or shows it to copy by hand. */
+async function exportGame() {
+  const notation = gameRecord.toNotation();
+  try {
+    await navigator.clipboard.writeText(notation);
+    updateStatus("statusGameCopied");
+  } catch (e) {
+    window.prompt(getString("exportGamePrompt"), notation);
   }
+}
+
+/** Asks for a game in notation and replays it: the new game starts from its position after the last move. */
+function importGame() {
+  const text = window.prompt(getString("importGamePrompt"), "");
+  if (!text) return;
+  let game;
   try {
-    if (
-      !stateToRestoreData ||
-      !stateToRestoreData.boardState ||
-      !Array.isArray(stateToRestoreData.boardState)
-    ) {
-      throw new Error("Invalid state data for restoration.");
-    }
-    board.state = stateToRestoreData.boardState.map((row) => {
-      if (!Array.isArray(row))
-        throw new Error("Invalid row structure in restore data.");
-      return row.map((cell) => {
-        if (!cell || typeof cell.terrain !== "number")
-          throw new Error("Invalid cell structure in restore data.");
-        return {
-          terrain: cell.terrain,
-          piece: cell.piece
-            ? new Piece(
-                cell.piece.type,
-                cell.piece.player,
-                cell.piece.row,
-                cell.piece.col
-              )
-            : null,
-        };
-      });
-    });
-    currentPlayer = stateToRestoreData.currentPlayer;
-    capturedByPlayer0 = [...stateToRestoreData.capturedP0];
-    capturedByPlayer1 = [...stateToRestoreData.capturedP1];
-    lastMove = stateToRestoreData.lastMove
-      ? { ...stateToRestoreData.lastMove }
-      : null;
-    lastEvalScore = stateToRestoreData.lastEval;
-    isGameOver = stateToRestoreData.isGameOver;
-    gameStatus = stateToRestoreData.gameStatus;
-  } catch (error) {
-    initGame();
+    game = parseNotation(text);
+  } catch (e) {
+    console.error("[Main] Game import failed:", e.message);
+    updateStatus("errorImportGame", {}, true);
     return;
   }
-  deselectPiece();
+  initialBoardLayoutConfig = game.layout;
+  if (playerStartsSelect) playerStartsSelect.value = game.firstPlayer.toString();
+  initGame();
+  const replayed = replayMoves(game.moves);
+  if (replayed < game.moves.length) {
+    console.error(`[Main] Game import stopped at move ${replayed + 1}: not a legal move.`);
+    updateStatus("errorImportGame", {}, true);
+  }
+  if (!isGameOver && isAiControlled(currentPlayer) && !isAiThinking) {
+    setTimeout(triggerAiTurn, 250);
+  }
+}
+
+/**
+ * Plays moves without animation or sounds (an imported game), then shows the result.
+ * @param {Array<{from: {r, c}, to: {r, c}}>} moves
+ * @returns {number} Moves played: the first illegal one and the rest are left out.
+ */
+function replayMoves(moves) {
+  let played = 0;
+  for (const { from, to } of moves) {
+    if (isGameOver) break;
+    const piece = board.getPiece(from.r, from.c);
+    if (!piece || piece.player !== currentPlayer) break;
+    const legal = rules
+      .getValidMovesForPiece(piece, from.r, from.c, board.getState())
+      .some((move) => move.row === to.r && move.col === to.c);
+    if (!legal) break;
+    const targetPiece = board.getPiece(to.r, to.c);
+    const capturedPieceData = targetPiece ? { ...targetPiece } : null;
+    updateBoardState(piece, to.r, to.c, from.r, from.c, capturedPieceData);
+    recordMove(piece, from.r, from.c, to.r, to.c, capturedPieceData);
+    addMoveToHistory(piece, from.r, from.c, to.r, to.c, capturedPieceData);
+    played++;
+    const status = rules.getGameStatus(board.getState());
+    if (status !== GameStatus.ONGOING) {
+      setGameOver(
+        status === GameStatus.PLAYER0_WINS ? Player.PLAYER0 : status === GameStatus.PLAYER1_WINS ? Player.PLAYER1 : Player.NONE,
+        status
+      );
+    } else {
+      advanceTurn();
+    }
+  }
+  aiNewGamePending = true;
   renderBoard(board.getState(), handleSquareClick, lastMove);
   renderCapturedPieces(capturedByPlayer0, capturedByPlayer1);
   updateGameStatusUI();
-  updateWinChanceBar(lastEvalScore);
-  updateUndoButtonState(gameStateHistory.length > 0);
+  updateWinChanceBar(
+    gameStatus === GameStatus.PLAYER1_WINS
+      ? Infinity
+      : gameStatus === GameStatus.PLAYER0_WINS
+      ? -Infinity
+      : lastEvalScore
+  );
+  return played;
 }
 // No direct default export for game.js, initGame is exported and called by main.js
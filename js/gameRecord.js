@@ -0,0 +1,165 @@
+// js/gameRecord.js
+// Game history as a move log: the starting placement and side, then one small undo
+// record per move (the move, the piece captured, the Zobrist key and evaluation of the
+// position after it). Earlier positions are not stored; game.js unwinds the board
+// move by move for undo and replays the log for an imported game. The keys feed the
+// threefold repetition rule and the AI's repetition detection.
+//
+// Notation (for sharing; one line):
+//   JC1 <placement> <b|r> <move> <move> ...
+// The placement lists the rows from the top (row 0) down, separated by '/', like FEN:
+// a letter per piece (r c d w p t l e = rat, cat, dog, wolf, leopard, tiger, lion,
+// elephant; upper case for Blue, Player 0, lower case for Red) and a digit for a run
+// of empty squares. Then the side that moves first, and the moves as start and end
+// square in the move list's coordinates (column letter, row number from the bottom),
+// e.g. "A3A4".
+
+import { BOARD_ROWS, BOARD_COLS, Player, PIECES } from './constants.js';
+
+export const NOTATION_TAG = "JC1";
+
+const PIECE_LETTERS = { rat: 'r', cat: 'c', dog: 'd', wolf: 'w', leopard: 'p', tiger: 't', lion: 'l', elephant: 'e' };
+const LETTER_PIECES = Object.fromEntries(Object.entries(PIECE_LETTERS).map(([type, letter]) => [letter, type]));
+const SIDE_LETTERS = { [Player.PLAYER0]: 'b', [Player.PLAYER1]: 'r' };
+
+/** Square in the move list's coordinates ("A1" is the bottom left corner). */
+export function squareName(row, col) {
+    return `${String.fromCharCode(65 + col)}${BOARD_ROWS - row}`;
+}
+
+/** Inverse of squareName; null if it is not a square of the board. */
+function parseSquare(name) {
+    const match = /^([A-Z])(\d+)$/.exec(name);
+    if (!match) return null;
+    const col = match[1].charCodeAt(0) - 65;
+    const row = BOARD_ROWS - Number(match[2]);
+    return row >= 0 && row < BOARD_ROWS && col < BOARD_COLS ? { r: row, c: col } : null;
+}
+
+/**
+ * Placement part of the notation for a board state (Board.getState()).
+ * @returns {string}
+ */
+export function encodePlacement(boardState) {
+    const rows = [];
+    for (let r = 0; r < BOARD_ROWS; r++) {
+        let text = "";
+        let empty = 0;
+        for (let c = 0; c < BOARD_COLS; c++) {
+            const piece = boardState[r][c].piece;
+            if (!piece) { empty++; continue; }
+            if (empty > 0) { text += empty; empty = 0; }
+            const letter = PIECE_LETTERS[piece.type];
+            text += piece.player === Player.PLAYER0 ? letter.toUpperCase() : letter;
+        }
+        if (empty > 0) text += empty;
+        rows.push(text);
+    }
+    return rows.join("/");
+}
+
+/**
+ * Layout of a placement, in the form of Board.setupPiecesFromLayout.
+ * @returns {Array<{type:string, player:number, r:number, c:number}>}
+ * @throws {Error} If the placement is malformed.
+ */
+export function decodePlacement(placement) {
+    const rows = placement.split("/");
+    if (rows.length !== BOARD_ROWS) throw new Error(`expected ${BOARD_ROWS} rows`);
+    const layout = [];
+    rows.forEach((text, r) => {
+        let c = 0;
+        for (const ch of text) {
+            if (ch >= '1' && ch <= '9') { c += Number(ch); continue; }
+            const type = LETTER_PIECES[ch.toLowerCase()];
+            if (!type || !PIECES[type]) throw new Error(`unknown piece '${ch}'`);
+            const player = ch === ch.toUpperCase() ? Player.PLAYER0 : Player.PLAYER1;
+            if (layout.some(p => p.type === type && p.player === player)) throw new Error(`piece '${ch}' placed twice`);
+            if (c >= BOARD_COLS) throw new Error(`row ${r + 1} has more than ${BOARD_COLS} squares`);
+            layout.push({ type, player, r, c });
+            c++;
+        }
+        if (c !== BOARD_COLS) throw new Error(`row ${r + 1} does not have ${BOARD_COLS} squares`);
+    });
+    return layout;
+}
+
+export class GameRecord {
+    /**
+     * @param {string} placement - Starting placement (encodePlacement).
+     * @param {number} firstPlayer - Side to move first.
+     * @param {number|null} initialHash - Zobrist key of the starting position, with its side to move.
+     */
+    constructor(placement, firstPlayer, initialHash) {
+        this.placement = placement;
+        this.firstPlayer = firstPlayer;
+        this.initialHash = initialHash;
+        // { from: {r, c}, to: {r, c}, piece: {type, player}, captured: {type, player}|null, hash, eval }
+        this.entries = [];
+    }
+
+    get length() {
+        return this.entries.length;
+    }
+
+    /** Undo record of the last move, or null at the start. */
+    last() {
+        return this.entries.length > 0 ? this.entries[this.entries.length - 1] : null;
+    }
+
+    push(entry) {
+        this.entries.push(entry);
+    }
+
+    pop() {
+        return this.entries.pop() ?? null;
+    }
+
+    /**
+     * Zobrist keys of the positions since the last capture, oldest first, the current
+     * one included (earlier positions have more pieces and cannot come back).
+     */
+    keysSinceCapture() {
+        let last = this.entries.length - 1;
+        while (last >= 0 && !this.entries[last].captured) last--;
+        // From the position after the last capture, or from the start
+        const keys = last < 0 && this.initialHash !== null ? [this.initialHash] : [];
+        for (let i = Math.max(0, last); i < this.entries.length; i++) keys.push(this.entries[i].hash);
+        return keys;
+    }
+
+    /** How often the current position has occurred (for the threefold repetition rule). */
+    repetitionCount() {
+        const keys = this.keysSinceCapture();
+        const current = keys[keys.length - 1];
+        return keys.reduce((count, key) => count + (key === current ? 1 : 0), 0);
+    }
+
+    /** @returns {string} The game in notation (see the top of the file). */
+    toNotation() {
+        const moves = this.entries.map(e => squareName(e.from.r, e.from.c) + squareName(e.to.r, e.to.c));
+        return [NOTATION_TAG, this.placement, SIDE_LETTERS[this.firstPlayer], ...moves].join(" ");
+    }
+}
+
+/**
+ * Parses a game in notation. The moves are not checked against the rules here.
+ * @returns {{ layout: Array<object>, placement: string, firstPlayer: number, moves: Array<{from: {r, c}, to: {r, c}}> }}
+ * @throws {Error} If the text is not in the notation.
+ */
+export function parseNotation(text) {
+    const [tag, placement, side, ...moveTokens] = text.trim().split(/\s+/);
+    if (tag !== NOTATION_TAG) throw new Error(`the game must start with ${NOTATION_TAG}`);
+    if (!placement) throw new Error("missing placement");
+    const layout = decodePlacement(placement);
+    const firstPlayer = side === 'b' ? Player.PLAYER0 : side === 'r' ? Player.PLAYER1 : null;
+    if (firstPlayer === null) throw new Error("the side to move first must be b or r");
+    const moves = moveTokens.map(token => {
+        const match = /^([A-Z]\d+)([A-Z]\d+)$/.exec(token.toUpperCase());
+        const from = match && parseSquare(match[1]);
+        const to = match && parseSquare(match[2]);
+        if (!from || !to) throw new Error(`malformed move '${token}'`);
+        return { from, to };
+    });
+    return { layout, placement, firstPlayer, moves };
+}
@@ -1,5 +1,6 @@
 // js/localization.js
 import { PIECES } from './constants.js';
+import { pieceImageUrl } from './assetLoader.js';
 
 let currentLanguageData = {};
 let currentLangCode = 'vn';
@@ -60,7 +61,7 @@ export function renderGameRules() {
         if (key === 'ruleRank') {
             let rankHtml = rankOrder.map((pieceType, index) => {
                 const pieceName = getString(`animal_${pieceType}`) || PIECES[pieceType]?.name || pieceType;
-                const imgSrc = `assets/images/head_no_background/${pieceType}.png`;
+                const imgSrc = pieceImageUrl(pieceType);
                 // Use rule-piece-icon class for specific sizing
                 let pieceHtml = `<span class="rank-piece"><img src="${imgSrc}" alt="${pieceName}" title="${pieceName}" class="rule-piece-icon"></span>`;
                 if (index < rankOrder.length - 1) { pieceHtml += '<span class="rank-separator"> > </span>'; }
@@ -1,8 +1,9 @@
 // js/main.js
-import { initGame } from './game.js';
+import { initGame, evalParamsReady } from './game.js';
 // ** Import renderGameRules from localization **
 import { loadLanguage, applyLocalizationToPage, getString, renderGameRules } from './localization.js';
 import { DEFAULT_LANGUAGE } from './constants.js'
+import { preloadAssets } from './assetLoader.js';
 
 /**
  * Asynchronously sets up and starts the application.
@@ -22,6 +23,18 @@ async function startApp() {
     // Apply loaded language to static elements
     applyLocalizationToPage();
 
+    // Images and sounds before the first board, behind the progress screen
+    const loadingScreen = document.getElementById('loading-screen');
+    const loadingProgress = document.getElementById('loading-progress');
+    await Promise.all([
+        preloadAssets((loadedCount, total) => {
+            if (!loadingProgress) return;
+            loadingProgress.max = total;
+            loadingProgress.value = loadedCount;
+        }),
+        evalParamsReady // Tuned evaluation weights of the win chance bar, if enabled
+    ]);
+
     // ** Render dynamic rules after localization **
     renderGameRules(); // <-- Call the function here
 
@@ -34,6 +47,7 @@ async function startApp() {
         console.error("Error initializing game:", error);
          document.body.innerHTML = `Critical error during game initialization: ${error.message}`;
     }
+    if (loadingScreen) loadingScreen.hidden = true;
 }
 
 document.addEventListener('DOMContentLoaded', startApp);
\ No newline at end of file
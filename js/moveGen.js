@@ -0,0 +1,155 @@
+// js/moveGen.js
+// Game rules on the packed Position (see position.js), used by the AI engine.
+// NOTE: This logic mirrors rules.js (the reference implementation used by the UI).
+// Ensure consistency if changes are made here or in rules.js.
+
+import {
+    TERRAIN_WATER,
+    TERRAIN_PLAYER0_DEN, TERRAIN_PLAYER1_DEN,
+    Player, GameStatus
+} from './constants.js';
+import {
+    EMPTY, TERRAIN_TABLE, TRAP_OWNER, CODE_RANK,
+    PLAYER0_DEN_SQ, PLAYER1_DEN_SQ,
+    TYPE_RAT, TYPE_TIGER, TYPE_LION, TYPE_ELEPHANT,
+    NEIGHBORS, JUMPS_AT, JUMP_LANDING, JUMP_PATH, JUMP_PATH_LENGTH, JUMP_LION_ONLY, MAX_JUMP_PATH,
+    codeType, codePlayer, encodeMove
+} from './position.js';
+
+// Largest number of moves one side can have (16 pieces x 4 steps + jumps, rounded up)
+export const MAX_MOVES = 128;
+// Largest number of moves of a single piece (4 steps + 2 jumps, rounded up)
+const MAX_PIECE_MOVES = 8;
+
+// Move generation filters
+export const GEN_CAPTURES = 1;
+export const GEN_QUIETS = 2;
+export const GEN_ALL = GEN_CAPTURES | GEN_QUIETS;
+
+/** Effective rank of a piece code on a square: 0 inside an opponent's trap. */
+export function getEffectiveRankPacked(code, sq) {
+    const owner = TRAP_OWNER[sq];
+    if (owner !== Player.NONE && owner !== codePlayer(code)) return 0;
+    return CODE_RANK[code];
+}
+
+/** Packed equivalent of rules.canCapture. */
+export function canCapturePacked(attCode, defCode, attSq, defSq) {
+    if (attCode === EMPTY || defCode === EMPTY || codePlayer(attCode) === codePlayer(defCode)) return false;
+
+    const attType = codeType(attCode);
+    const attInWater = TERRAIN_TABLE[attSq] === TERRAIN_WATER;
+
+    // A piece in water (only the Rat) can only attack another piece in water
+    if (attInWater && (attType !== TYPE_RAT || TERRAIN_TABLE[defSq] !== TERRAIN_WATER)) return false;
+
+    const defType = codeType(defCode);
+    if (attType === TYPE_RAT && defType === TYPE_ELEPHANT) return !attInWater;
+    if (attType === TYPE_ELEPHANT && defType === TYPE_RAT) return false;
+
+    return getEffectiveRankPacked(attCode, attSq) >= getEffectiveRankPacked(defCode, defSq);
+}
+
+/** Destination check shared by steps and jumps; returns true when the move may be played. */
+function canEnter(squares, code, from, to, ownDen) {
+    const terrain = TERRAIN_TABLE[to];
+    if (terrain === ownDen) return false;
+    const target = squares[to];
+    if (target === EMPTY) return true;
+    if (codePlayer(target) === codePlayer(code)) return false;
+    return canCapturePacked(code, target, from, to);
+}
+
+/** Checks that every river square crossed by jump j is empty (not blocked by a Rat). */
+export function jumpPathClear(squares, j) {
+    const base = j * MAX_JUMP_PATH;
+    for (let k = 0; k < JUMP_PATH_LENGTH[j]; k++) {
+        if (squares[JUMP_PATH[base + k]] !== EMPTY) return false;
+    }
+    return true;
+}
+
+/**
+ * Writes every legal move of the piece on `from` into `out` starting at `count`.
+ * Same order as rules.getValidMovesForPiece: up, down, left, right, then jumps.
+ * @param {number} [filter=GEN_ALL] - GEN_CAPTURES, GEN_QUIETS or GEN_ALL.
+ * @returns {number} The new move count.
+ */
+export function generatePieceMoves(pos, from, out, count, filter = GEN_ALL) {
+    const squares = pos.squares;
+    const code = squares[from];
+    const type = codeType(code);
+    const ownDen = codePlayer(code) === Player.PLAYER0 ? TERRAIN_PLAYER0_DEN : TERRAIN_PLAYER1_DEN;
+
+    // 1. Orthogonal steps
+    const canSwim = type === TYPE_RAT;
+    for (let d = from * 4; d < from * 4 + 4; d++) {
+        const to = NEIGHBORS[d];
+        if (to >= 0 && (filter & (squares[to] === EMPTY ? GEN_QUIETS : GEN_CAPTURES)) &&
+            (canSwim || TERRAIN_TABLE[to] !== TERRAIN_WATER) && canEnter(squares, code, from, to, ownDen)) {
+            out[count++] = encodeMove(from, to);
+        }
+    }
+
+    // 2. River jumps (Tiger vertical, Lion vertical and horizontal)
+    if (type === TYPE_LION || type === TYPE_TIGER) {
+        for (let j = JUMPS_AT[from]; j < JUMPS_AT[from + 1]; j++) {
+            if (JUMP_LION_ONLY[j] && type !== TYPE_LION) continue;
+            const to = JUMP_LANDING[j];
+            if ((filter & (squares[to] === EMPTY ? GEN_QUIETS : GEN_CAPTURES)) &&
+                jumpPathClear(squares, j) && canEnter(squares, code, from, to, ownDen)) out[count++] = encodeMove(from, to);
+        }
+    }
+    return count;
+}
+
+/**
+ * Writes all legal moves of a player into a reusable buffer.
+ * @param {Position} pos - The position.
+ * @param {number} player - Player to generate moves for.
+ * @param {Int32Array} out - Buffer of at least MAX_MOVES entries.
+ * @param {number} [filter=GEN_ALL] - GEN_CAPTURES, GEN_QUIETS or GEN_ALL.
+ * @returns {number} Number of moves written.
+ */
+export function generateMoves(pos, player, out, filter = GEN_ALL) {
+    let count = 0;
+    const n = pos.pieceCount[player];
+    for (let i = 0; i < n; i++) {
+        count = generatePieceMoves(pos, pos.pieceSquare(player, i), out, count, filter);
+    }
+    return count;
+}
+
+const pieceMoveScratch = new Int32Array(MAX_PIECE_MOVES);
+
+/**
+ * Checks that an encoded move (e.g. from the transposition table or a killer slot)
+ * is legal for `player` in this position.
+ */
+export function isLegalMove(pos, move, player) {
+    const from = move & 63;
+    const code = pos.squares[from];
+    if (code === EMPTY || codePlayer(code) !== player) return false;
+    const count = generatePieceMoves(pos, from, pieceMoveScratch, 0);
+    for (let i = 0; i < count; i++) {
+        if (pieceMoveScratch[i] === move) return true;
+    }
+    return false;
+}
+
+/**
+ * Packed equivalent of rules.getGameStatus.
+ * @returns {string} A GameStatus value (ONGOING, PLAYER0_WINS, PLAYER1_WINS).
+ */
+export function getPositionStatus(pos) {
+    const inRedDen = pos.squares[PLAYER1_DEN_SQ];
+    if (inRedDen !== EMPTY && codePlayer(inRedDen) === Player.PLAYER0) return GameStatus.PLAYER0_WINS;
+    const inBlueDen = pos.squares[PLAYER0_DEN_SQ];
+    if (inBlueDen !== EMPTY && codePlayer(inBlueDen) === Player.PLAYER1) return GameStatus.PLAYER1_WINS;
+
+    const p0Count = pos.pieceCount[Player.PLAYER0];
+    const p1Count = pos.pieceCount[Player.PLAYER1];
+    if (p1Count === 0 && p0Count > 0) return GameStatus.PLAYER0_WINS;
+    if (p0Count === 0 && p1Count > 0) return GameStatus.PLAYER1_WINS;
+    return GameStatus.ONGOING;
+}
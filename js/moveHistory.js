@@ -0,0 +1,77 @@
+// js/moveHistory.js
+// Quiet-move ordering statistics of the AI search, kept across iterations and turns:
+//   - the history table ("butterfly" by piece and target square) scores how often a
+//     quiet move caused a beta cutoff, weighted by depth, minus how often it was
+//     searched in vain before another quiet move cut off;
+//   - the countermove table remembers, per previous move (by the piece that moved
+//     and its target square), the quiet move that last refuted it.
+// Both are indexed by piece code, which includes the player, so one table serves
+// both sides. Moves are the encoded integers of position.js.
+
+import { NUM_SQUARES, NUM_PIECE_CODES, NO_MOVE, moveTo } from './position.js';
+
+// History scores stay within +-HISTORY_MAX: each update moves a score part of the way
+// toward the bound, so old statistics fade as new ones come in
+export const HISTORY_MAX = 16384;
+const MAX_HISTORY_BONUS = 1024; // Depth bonus cap (depth * depth)
+
+export class MoveHistory {
+    constructor() {
+        this.scores = new Int32Array(NUM_PIECE_CODES * NUM_SQUARES);      // [code * NUM_SQUARES + to]
+        this.countermoves = new Int32Array(NUM_PIECE_CODES * NUM_SQUARES); // [previous code * NUM_SQUARES + previous to]
+    }
+
+    /** Forgets everything (new game). */
+    clear() {
+        this.scores.fill(0);
+        this.countermoves.fill(NO_MOVE);
+    }
+
+    /** Halves the history scores, so a new search favours what it learns itself. */
+    age() {
+        const scores = this.scores;
+        for (let i = 0; i < scores.length; i++) scores[i] = scores[i] >> 1;
+    }
+
+    /** History score of a quiet move in pos (before it is made). */
+    score(squares, move) {
+        return this.scores[squares[move & 63] * NUM_SQUARES + moveTo(move)];
+    }
+
+    /**
+     * The quiet move that last refuted `previousMove` (NO_MOVE if none).
+     * @param {Int8Array} squares - Squares of the position after previousMove.
+     */
+    countermove(squares, previousMove) {
+        if (previousMove === NO_MOVE) return NO_MOVE;
+        const to = moveTo(previousMove);
+        return this.countermoves[squares[to] * NUM_SQUARES + to];
+    }
+
+    /**
+     * Records a beta cutoff by a quiet move.
+     * @param {Int8Array} squares - Squares of the node (the move is not made).
+     * @param {number} move - The quiet move that cut off.
+     * @param {number} depth - Remaining depth of the node.
+     * @param {number} previousMove - Move that led to the node (NO_MOVE at the root or after a null move).
+     * @param {Int32Array} triedQuiets - Quiet moves searched before `move` at this node.
+     * @param {number} triedCount - Number of entries in triedQuiets.
+     */
+    recordCutoff(squares, move, depth, previousMove, triedQuiets, triedCount) {
+        const bonus = Math.min(depth * depth, MAX_HISTORY_BONUS);
+        this.update(squares[move & 63] * NUM_SQUARES + moveTo(move), bonus);
+        for (let i = 0; i < triedCount; i++) {
+            const tried = triedQuiets[i];
+            this.update(squares[tried & 63] * NUM_SQUARES + moveTo(tried), -bonus);
+        }
+        if (previousMove !== NO_MOVE) {
+            const to = moveTo(previousMove);
+            this.countermoves[squares[to] * NUM_SQUARES + to] = move;
+        }
+    }
+
+    update(index, bonus) {
+        const score = this.scores[index];
+        this.scores[index] = score + bonus - ((score * Math.abs(bonus) / HISTORY_MAX) | 0);
+    }
+}
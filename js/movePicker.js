@@ -0,0 +1,216 @@
+// js/movePicker.js
+// Staged move generation for the AI search. Instead of generating, scoring and
+// sorting every move of a node up front, a MovePicker hands moves out one at a
+// time in the order they are most likely to cut off:
+//   1. the transposition table move,
+//   2. captures, most valuable victim first, then least valuable attacker (MVV-LVA),
+//   3. the two killer moves of the ply, then the countermove of the previous move,
+//   4. the remaining quiet moves by history score (see moveHistory.js), with a bonus
+//      for advancing toward the opponent's den.
+// Each stage is only generated when the previous one is used up, so a node that
+// cuts off on the table move or a capture never generates its quiet moves.
+// Moves are the encoded integers of position.js, kept in a preallocated buffer
+// owned by the picker (one picker per search ply).
+// For the quiescence search the picker only hands out den entries, then captures.
+
+import { Player, PLAYER0_DEN_ROW, PLAYER1_DEN_ROW } from './constants.js';
+import {
+    EMPTY, NO_MOVE, CODE_VALUE, NEIGHBORS, PLAYER0_DEN_SQ, PLAYER1_DEN_SQ,
+    encodeMove, codePlayer, moveFrom, moveTo, squareRow
+} from './position.js';
+import { generateMoves, isLegalMove, MAX_MOVES, GEN_CAPTURES, GEN_QUIETS } from './moveGen.js';
+
+// Stages, in the order they are visited
+const STAGE_TT_MOVE = 0;
+const STAGE_GEN_CAPTURES = 1;
+const STAGE_CAPTURES = 2;
+const STAGE_KILLER1 = 3;
+const STAGE_KILLER2 = 4;
+const STAGE_COUNTERMOVE = 5;
+const STAGE_GEN_QUIETS = 6;
+const STAGE_QUIETS = 7;
+const STAGE_DONE = 8;
+const STAGE_DEN_ENTRIES = 9; // Quiescence only, before the (empty) table move stage
+
+// Capture ordering: the victim dominates, the attacker breaks ties (piece values are < 1024)
+const MVV_LVA_VICTIM_WEIGHT = 1024;
+// Quiet ordering bonus for a move toward the opponent's den, on the history scale
+const ADVANCE_BONUS = 256;
+
+export class MovePicker {
+    /** @param {MoveHistory} history - History tables that order the quiet moves. */
+    constructor(history) {
+        this.history = history;
+        this.moves = new Int32Array(MAX_MOVES);
+        this.scores = new Int32Array(MAX_MOVES);
+        this.count = 0;
+        this.index = 0;
+        this.stage = STAGE_DONE;
+        this.player = Player.PLAYER0;
+        this.ttMove = NO_MOVE;
+        this.killer1 = NO_MOVE;
+        this.killer2 = NO_MOVE;
+        this.countermove = NO_MOVE;
+        this.quiescence = false;
+    }
+
+    /**
+     * Prepares the picker for a node. Nothing is generated until next() is called.
+     * @param {Position} pos - Position of the node.
+     * @param {number} player - Side to move.
+     * @param {number} ttMove - Move from the transposition table (NO_MOVE if none).
+     * @param {number} killer1 - First killer move of the ply (NO_MOVE if none).
+     * @param {number} killer2 - Second killer move of the ply (NO_MOVE if none).
+     * @param {number} countermove - Countermove of the previous move (NO_MOVE if none).
+     */
+    init(pos, player, ttMove, killer1, killer2, countermove) {
+        this.player = player;
+        this.ttMove = ttMove;
+        this.killer1 = killer1;
+        this.killer2 = killer2;
+        this.countermove = countermove;
+        this.count = 0;
+        this.index = 0;
+        this.stage = STAGE_TT_MOVE;
+        this.quiescence = false;
+    }
+
+    /**
+     * Prepares the picker for a quiescence node: moves into the opponent's den first,
+     * then captures (MVV-LVA). Quiet moves are never returned.
+     * @param {Position} pos - Position of the node.
+     * @param {number} player - Side to move.
+     */
+    initQuiescence(pos, player) {
+        this.player = player;
+        this.ttMove = NO_MOVE;
+        this.killer1 = NO_MOVE;
+        this.killer2 = NO_MOVE;
+        this.countermove = NO_MOVE;
+        this.count = 0;
+        this.index = 0;
+        this.stage = STAGE_DEN_ENTRIES;
+        this.quiescence = true;
+    }
+
+    /** A killer (or countermove) is only tried if it is a legal quiet move that is not the table move. */
+    isValidKiller(pos, move) {
+        return move !== NO_MOVE && move !== this.ttMove &&
+            pos.squares[moveTo(move)] === EMPTY && isLegalMove(pos, move, this.player);
+    }
+
+    /**
+     * Returns the next move to search, or NO_MOVE when every move has been returned.
+     * The position must be the one given to init() (children are unmade before calling again).
+     */
+    next(pos) {
+        const moves = this.moves;
+        const scores = this.scores;
+        const squares = pos.squares;
+
+        switch (this.stage) {
+            case STAGE_DEN_ENTRIES: {
+                // The den squares are always empty, so these are never captures
+                const den = this.player === Player.PLAYER1 ? PLAYER0_DEN_SQ : PLAYER1_DEN_SQ;
+                while (this.index < 4) {
+                    const from = NEIGHBORS[den * 4 + this.index++];
+                    if (from < 0 || squares[from] === EMPTY || codePlayer(squares[from]) !== this.player) continue;
+                    const move = encodeMove(from, den);
+                    if (isLegalMove(pos, move, this.player)) return move;
+                }
+                this.stage = STAGE_TT_MOVE;
+            }
+                // falls through
+            case STAGE_TT_MOVE:
+                this.stage = STAGE_GEN_CAPTURES;
+                // Validated lazily: table moves may come from a hash collision (or another worker)
+                if (this.ttMove !== NO_MOVE) {
+                    if (isLegalMove(pos, this.ttMove, this.player)) return this.ttMove;
+                    this.ttMove = NO_MOVE;
+                }
+                // falls through
+            case STAGE_GEN_CAPTURES:
+                this.count = generateMoves(pos, this.player, moves, GEN_CAPTURES);
+                for (let i = 0; i < this.count; i++) {
+                    const move = moves[i];
+                    scores[i] = CODE_VALUE[squares[moveTo(move)]] * MVV_LVA_VICTIM_WEIGHT - CODE_VALUE[squares[moveFrom(move)]];
+                }
+                this.index = 0;
+                this.stage = STAGE_CAPTURES;
+                // falls through
+            case STAGE_CAPTURES:
+                while (this.index < this.count) {
+                    // Selection step: only the captures actually searched get ordered
+                    let best = this.index;
+                    for (let i = this.index + 1; i < this.count; i++) {
+                        if (scores[i] > scores[best]) best = i;
+                    }
+                    const move = moves[best];
+                    moves[best] = moves[this.index];
+                    scores[best] = scores[this.index];
+                    this.index++;
+                    if (move !== this.ttMove) return move;
+                }
+                if (this.quiescence) {
+                    this.stage = STAGE_DONE;
+                    return NO_MOVE;
+                }
+                this.stage = STAGE_KILLER1;
+                // falls through
+            case STAGE_KILLER1:
+                this.stage = STAGE_KILLER2;
+                // Killers come from sibling nodes, so they may not be legal (or quiet) here
+                if (this.isValidKiller(pos, this.killer1)) return this.killer1;
+                this.killer1 = NO_MOVE;
+                // falls through
+            case STAGE_KILLER2:
+                this.stage = STAGE_COUNTERMOVE;
+                if (this.killer2 !== this.killer1 && this.isValidKiller(pos, this.killer2)) return this.killer2;
+                this.killer2 = NO_MOVE;
+                // falls through
+            case STAGE_COUNTERMOVE:
+                this.stage = STAGE_GEN_QUIETS;
+                if (this.countermove !== this.killer1 && this.countermove !== this.killer2 &&
+                    this.isValidKiller(pos, this.countermove)) return this.countermove;
+                this.countermove = NO_MOVE;
+                // falls through
+            case STAGE_GEN_QUIETS: {
+                this.count = generateMoves(pos, this.player, moves, GEN_QUIETS);
+                const opponentDenRow = (this.player === Player.PLAYER1) ? PLAYER0_DEN_ROW : PLAYER1_DEN_ROW;
+                const history = this.history;
+                // Score, then insertion sort (descending, stable for equal scores)
+                for (let i = 0; i < this.count; i++) {
+                    const move = moves[i];
+                    const currentDist = Math.abs(squareRow(moveFrom(move)) - opponentDenRow);
+                    const newDist = Math.abs(squareRow(moveTo(move)) - opponentDenRow);
+                    const score = history.score(squares, move) + (newDist < currentDist ? ADVANCE_BONUS : 0);
+                    let j = i;
+                    while (j > 0 && scores[j - 1] < score) {
+                        moves[j] = moves[j - 1];
+                        scores[j] = scores[j - 1];
+                        j--;
+                    }
+                    moves[j] = move;
+                    scores[j] = score;
+                }
+                this.index = 0;
+                this.stage = STAGE_QUIETS;
+            }
+                // falls through
+            case STAGE_QUIETS:
+                while (this.index < this.count) {
+                    const move = moves[this.index++];
+                    if (this.isFreshQuiet(move)) return move;
+                }
+                this.stage = STAGE_DONE;
+                // falls through
+            default:
+                return NO_MOVE;
+        }
+    }
+
+    /** True if a quiet move was not already returned by an earlier stage. */
+    isFreshQuiet(move) {
+        return move !== this.ttMove && move !== this.killer1 && move !== this.killer2 && move !== this.countermove;
+    }
+}
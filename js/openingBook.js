@@ -0,0 +1,126 @@
+// js/openingBook.js
+// Opening book of the AI: positions keyed by Zobrist hash, each with weighted moves,
+// in a compact binary table that is probed before searching. The book is built
+// offline by tools/buildBook.js from deep searches of the engine's own lines.
+//
+// File layout (little-endian):
+//   header, 16 bytes: magic "JBK1", entry count (uint32), 8 reserved bytes
+//   entries, 16 bytes each, sorted by (keyHi, keyLo) as unsigned numbers:
+//     keyLo, keyHi (uint32) - Position.hashLo / hashHi (side to move included)
+//     move (uint16)         - encoded move (position.js)
+//     weight (uint16)       - relative choice weight, > 0
+//     score (int32)         - search score after the move, from the mover's view
+// A position with several moves has several consecutive entries.
+
+import { isLegalMove } from './moveGen.js';
+
+const MAGIC = 0x314B424A; // "JBK1"
+const HEADER_BYTES = 16;
+const ENTRY_BYTES = 16;
+
+export class OpeningBook {
+    /**
+     * @param {ArrayBuffer} buffer - Book file contents.
+     * @throws {Error} If the data is not a book.
+     */
+    constructor(buffer) {
+        if (buffer.byteLength < HEADER_BYTES) throw new Error("Opening book too short");
+        this.view = new DataView(buffer);
+        if (this.view.getUint32(0, true) !== MAGIC) throw new Error("Not an opening book");
+        this.size = this.view.getUint32(4, true);
+        if (buffer.byteLength < HEADER_BYTES + this.size * ENTRY_BYTES) throw new Error("Opening book truncated");
+    }
+
+    /**
+     * Serializes book entries into the file format.
+     * @param {Array<{hashLo:number, hashHi:number, move:number, weight:number, score:number}>} entries
+     * @returns {ArrayBuffer}
+     */
+    static build(entries) {
+        const sorted = entries
+            .map(e => ({ ...e, hashLo: e.hashLo >>> 0, hashHi: e.hashHi >>> 0 }))
+            .sort((a, b) => a.hashHi - b.hashHi || a.hashLo - b.hashLo || b.weight - a.weight);
+        const buffer = new ArrayBuffer(HEADER_BYTES + sorted.length * ENTRY_BYTES);
+        const view = new DataView(buffer);
+        view.setUint32(0, MAGIC, true);
+        view.setUint32(4, sorted.length, true);
+        sorted.forEach((e, i) => {
+            const offset = HEADER_BYTES + i * ENTRY_BYTES;
+            view.setUint32(offset, e.hashLo, true);
+            view.setUint32(offset + 4, e.hashHi, true);
+            view.setUint16(offset + 8, e.move, true);
+            view.setUint16(offset + 10, Math.max(1, Math.min(0xFFFF, Math.round(e.weight))), true);
+            view.setInt32(offset + 12, e.score, true);
+        });
+        return buffer;
+    }
+
+    /**
+     * Book moves of a position, best weight first ([] if the position is not in the book).
+     * @returns {Array<{move:number, weight:number, score:number}>}
+     */
+    probe(hashLo, hashHi) {
+        const lo = hashLo >>> 0;
+        const hi = hashHi >>> 0;
+        // Lower bound of the key
+        let first = 0;
+        let last = this.size;
+        while (first < last) {
+            const mid = (first + last) >>> 1;
+            const offset = HEADER_BYTES + mid * ENTRY_BYTES;
+            const midHi = this.view.getUint32(offset + 4, true);
+            const midLo = this.view.getUint32(offset, true);
+            if (midHi < hi || (midHi === hi && midLo < lo)) first = mid + 1;
+            else last = mid;
+        }
+        const moves = [];
+        for (let i = first; i < this.size; i++) {
+            const offset = HEADER_BYTES + i * ENTRY_BYTES;
+            if (this.view.getUint32(offset, true) !== lo || this.view.getUint32(offset + 4, true) !== hi) break;
+            moves.push({
+                move: this.view.getUint16(offset + 8, true),
+                weight: this.view.getUint16(offset + 10, true),
+                score: this.view.getInt32(offset + 12, true)
+            });
+        }
+        return moves;
+    }
+
+    /**
+     * Chooses a book move for the side to move of `pos`, at random by weight.
+     * @param {Position} pos
+     * @param {function(): number|null} [random=Math.random] - null picks the heaviest move,
+     *   so the same position always gets the same answer.
+     * @returns {{move:number, weight:number, score:number}|null} null if out of book.
+     */
+    pickMove(pos, random = Math.random) {
+        const moves = this.probe(pos.hashLo, pos.hashHi).filter(m => isLegalMove(pos, m.move, pos.sideToMove));
+        if (moves.length === 0) return null;
+        if (random === null) return moves[0];
+        const total = moves.reduce((sum, m) => sum + m.weight, 0);
+        let ticket = random() * total;
+        for (const m of moves) {
+            ticket -= m.weight;
+            if (ticket < 0) return m;
+        }
+        return moves[moves.length - 1];
+    }
+}
+
+/**
+ * Fetches and parses a book file.
+ * @param {string|URL} url
+ * @returns {Promise<OpeningBook|null>} null (with a log line) if it cannot be loaded.
+ */
+export async function loadOpeningBook(url) {
+    try {
+        const response = await fetch(url);
+        if (!response.ok) throw new Error(`HTTP ${response.status}`);
+        const book = new OpeningBook(await response.arrayBuffer());
+        console.log(`[Book] Loaded ${book.size} opening book entries.`);
+        return book;
+    } catch (e) {
+        console.log(`[Book] No opening book (${e.message}).`);
+        return null;
+    }
+}
@@ -0,0 +1,390 @@
+// js/position.js
+// Packed board representation used by the AI engine hot path.
+// A position is a flat Int8Array of 63 squares holding piece codes, a static
+// terrain table shared by every position, and per-side piece-location lists.
+// Converters to and from the nested { terrain, piece } format keep the
+// main-thread Board and the worker message format unchanged.
+
+import {
+    BOARD_ROWS, BOARD_COLS,
+    TERRAIN_LAND, TERRAIN_WATER, TERRAIN_TRAP,
+    TERRAIN_PLAYER0_DEN, TERRAIN_PLAYER1_DEN,
+    PLAYER0_DEN_ROW, PLAYER0_DEN_COL, PLAYER1_DEN_ROW, PLAYER1_DEN_COL,
+    Player, PIECES, getPieceKey
+} from './constants.js';
+import {
+    initializeZobrist, zobristKeyIndex, combineHashHalves,
+    zobristKeysLo, zobristKeysHi, zobristSideLo, zobristSideHi, pieceNameToIndex
+} from './zobrist.js';
+
+// --- Squares ---
+export const NUM_SQUARES = BOARD_ROWS * BOARD_COLS; // 63, square index = row * BOARD_COLS + col
+export const PLAYER0_DEN_SQ = PLAYER0_DEN_ROW * BOARD_COLS + PLAYER0_DEN_COL;
+export const PLAYER1_DEN_SQ = PLAYER1_DEN_ROW * BOARD_COLS + PLAYER1_DEN_COL;
+
+export function toSquare(row, col) { return row * BOARD_COLS + col; }
+export function squareRow(sq) { return (sq / BOARD_COLS) | 0; }
+export function squareCol(sq) { return sq % BOARD_COLS; }
+
+// --- Piece Codes ---
+// 0 = empty, 1..8 = Player 0 (rat..elephant), 9..16 = Player 1 (rat..elephant).
+// The type index equals rank - 1, so the code also carries the base rank.
+export const EMPTY = 0;
+export const PIECE_TYPES = ['rat', 'cat', 'dog', 'wolf', 'leopard', 'tiger', 'lion', 'elephant'];
+export const TYPE_RAT = 0;
+export const TYPE_TIGER = 5;
+export const TYPE_LION = 6;
+export const TYPE_ELEPHANT = 7;
+export const NUM_PIECE_CODES = 17;
+
+export function makePieceCode(player, type) { return 1 + player * 8 + type; }
+export function codeType(code) { return (code - 1) & 7; }
+export function codePlayer(code) { return (code - 1) >> 3; }
+
+// Per-code lookups (index 0 is the empty square)
+export const CODE_RANK = new Uint8Array(NUM_PIECE_CODES);
+export const CODE_VALUE = new Int32Array(NUM_PIECE_CODES);
+for (let code = 1; code < NUM_PIECE_CODES; code++) {
+    const data = PIECES[PIECE_TYPES[codeType(code)]];
+    CODE_RANK[code] = data.rank;
+    CODE_VALUE[code] = data.value;
+}
+
+// --- Static Terrain ---
+// Same layout as Board._getTerrainType.
+export const TERRAIN_TABLE = new Uint8Array(NUM_SQUARES);
+// Owner of the trap on each square (Player.NONE where there is no trap)
+export const TRAP_OWNER = new Int8Array(NUM_SQUARES).fill(Player.NONE);
+
+for (let r = 0; r < BOARD_ROWS; r++) {
+    for (let c = 0; c < BOARD_COLS; c++) {
+        const sq = toSquare(r, c);
+        let terrain = TERRAIN_LAND;
+        if (r === PLAYER1_DEN_ROW && c === PLAYER1_DEN_COL) terrain = TERRAIN_PLAYER1_DEN;
+        else if (r === PLAYER0_DEN_ROW && c === PLAYER0_DEN_COL) terrain = TERRAIN_PLAYER0_DEN;
+        else if ((r === 0 && (c === 2 || c === 4)) || (r === 1 && c === 3)) { terrain = TERRAIN_TRAP; TRAP_OWNER[sq] = Player.PLAYER1; }
+        else if ((r === 8 && (c === 2 || c === 4)) || (r === 7 && c === 3)) { terrain = TERRAIN_TRAP; TRAP_OWNER[sq] = Player.PLAYER0; }
+        else if (r >= 3 && r <= 5 && (c === 1 || c === 2 || c === 4 || c === 5)) terrain = TERRAIN_WATER;
+        TERRAIN_TABLE[sq] = terrain;
+    }
+}
+
+// --- Neighbour and Jump Tables ---
+// NEIGHBORS[sq * 4 + d] is the adjacent square in direction d (up, down, left, right), or -1.
+const DIRECTION_ROW = [-1, 1, 0, 0];
+const DIRECTION_COL = [0, 0, -1, 1];
+export const NEIGHBORS = new Int8Array(NUM_SQUARES * 4).fill(-1);
+
+// River jumps, derived from the terrain: from a land square straight across
+// consecutive water squares to the first land square beyond. The jumps of sq are
+// JUMPS_AT[sq] .. JUMPS_AT[sq + 1] - 1, in the same direction order as NEIGHBORS.
+// Each has its origin and landing square, the river squares it crosses (which
+// must be empty; JUMP_PATH[j * MAX_JUMP_PATH + k]) and whether only the Lion may
+// use it (horizontal jumps) or the Tiger too (vertical jumps).
+export const MAX_JUMP_PATH = 3;
+export const JUMPS_AT = new Uint8Array(NUM_SQUARES + 1);
+const jumpOrigins = [], jumpLandings = [], jumpPaths = [], jumpPathLengths = [], jumpLionOnly = [];
+
+for (let sq = 0; sq < NUM_SQUARES; sq++) {
+    const r = squareRow(sq);
+    const c = squareCol(sq);
+    JUMPS_AT[sq] = jumpOrigins.length;
+    for (let d = 0; d < 4; d++) {
+        const nr = r + DIRECTION_ROW[d];
+        const nc = c + DIRECTION_COL[d];
+        if (nr < 0 || nr >= BOARD_ROWS || nc < 0 || nc >= BOARD_COLS) continue;
+        NEIGHBORS[sq * 4 + d] = toSquare(nr, nc);
+
+        if (TERRAIN_TABLE[sq] === TERRAIN_WATER) continue; // Jumps start on land
+        const path = [];
+        let jr = nr, jc = nc;
+        while (jr >= 0 && jr < BOARD_ROWS && jc >= 0 && jc < BOARD_COLS && TERRAIN_TABLE[toSquare(jr, jc)] === TERRAIN_WATER) {
+            path.push(toSquare(jr, jc));
+            jr += DIRECTION_ROW[d];
+            jc += DIRECTION_COL[d];
+        }
+        if (path.length === 0 || path.length > MAX_JUMP_PATH || jr < 0 || jr >= BOARD_ROWS || jc < 0 || jc >= BOARD_COLS) continue;
+        jumpOrigins.push(sq);
+        jumpLandings.push(toSquare(jr, jc));
+        for (let k = 0; k < MAX_JUMP_PATH; k++) jumpPaths.push(k < path.length ? path[k] : -1);
+        jumpPathLengths.push(path.length);
+        jumpLionOnly.push(DIRECTION_ROW[d] === 0 ? 1 : 0);
+    }
+}
+JUMPS_AT[NUM_SQUARES] = jumpOrigins.length;
+export const JUMP_COUNT = jumpOrigins.length;
+export const JUMP_ORIGIN = Int8Array.from(jumpOrigins);
+export const JUMP_LANDING = Int8Array.from(jumpLandings);
+export const JUMP_PATH = Int8Array.from(jumpPaths);
+export const JUMP_PATH_LENGTH = Uint8Array.from(jumpPathLengths);
+export const JUMP_LION_ONLY = Uint8Array.from(jumpLionOnly);
+
+// --- Zobrist Keys (flattened per code and square, two 32-bit halves) ---
+initializeZobrist();
+const ZOBRIST_LO = new Int32Array(NUM_PIECE_CODES * NUM_SQUARES);
+const ZOBRIST_HI = new Int32Array(NUM_PIECE_CODES * NUM_SQUARES);
+for (let code = 1; code < NUM_PIECE_CODES; code++) {
+    const pieceIndex = pieceNameToIndex[PIECE_TYPES[codeType(code)]];
+    for (let sq = 0; sq < NUM_SQUARES; sq++) {
+        const index = zobristKeyIndex(pieceIndex, codePlayer(code), squareRow(sq), squareCol(sq));
+        ZOBRIST_LO[code * NUM_SQUARES + sq] = zobristKeysLo[index];
+        ZOBRIST_HI[code * NUM_SQUARES + sq] = zobristKeysHi[index];
+    }
+}
+const SIDE_LO = zobristSideLo;
+const SIDE_HI = zobristSideHi;
+
+// --- Moves ---
+// A move is a small integer: from | (to << 6). 0 never encodes a legal move.
+export const NO_MOVE = 0;
+export function encodeMove(from, to) { return from | (to << 6); }
+export function moveFrom(move) { return move & 63; }
+export function moveTo(move) { return (move >> 6) & 63; }
+
+const MAX_PIECES_PER_SIDE = 16;
+export const MAX_GAME_PLY = 128; // Depth of the make/unmake stack
+
+export class Position {
+    constructor() {
+        this.squares = new Int8Array(NUM_SQUARES);                  // Piece code per square
+        this.pieceList = new Int8Array(2 * MAX_PIECES_PER_SIDE);     // Squares, [player * 16 + i]
+        this.pieceCount = new Uint8Array(2);                         // Pieces per player
+        this.listIndex = new Int8Array(NUM_SQUARES).fill(-1);        // Index of a square in its owner's list
+        this.sideToMove = Player.PLAYER0;
+        this.hashLo = 0;                                             // Zobrist key, low 32 bits
+        this.hashHi = 0;                                             // Zobrist key, high 32 bits
+        // Undo stack
+        this.ply = 0;
+        this.capturedStack = new Int8Array(MAX_GAME_PLY);
+        this.capturedIndexStack = new Int8Array(MAX_GAME_PLY); // Piece-list slot of the captured piece
+        this.hashLoStack = new Int32Array(MAX_GAME_PLY);
+        this.hashHiStack = new Int32Array(MAX_GAME_PLY);
+    }
+
+    /**
+     * Builds a packed position from the nested board format.
+     * @param {Array<Array<object>>} boardState - Board state from board.getState() or getClonedStateForWorker().
+     * @param {number} sideToMove - Player whose turn it is.
+     * @returns {Position}
+     */
+    static fromBoardState(boardState, sideToMove) {
+        const pos = new Position();
+        for (let r = 0; r < BOARD_ROWS; r++) {
+            for (let c = 0; c < BOARD_COLS; c++) {
+                const piece = boardState[r]?.[c]?.piece;
+                if (!piece) continue;
+                const type = PIECE_TYPES.indexOf(piece.type ?? getPieceKey(piece.name));
+                if (type < 0 || (piece.player !== Player.PLAYER0 && piece.player !== Player.PLAYER1)) {
+                    console.warn("[Position] Skipped invalid piece data", piece);
+                    continue;
+                }
+                pos.addPiece(toSquare(r, c), makePieceCode(piece.player, type));
+            }
+        }
+        pos.sideToMove = sideToMove;
+        pos.computeHash();
+        return pos;
+    }
+
+    /**
+     * Builds a position from a piece code per square (the `squares` layout, e.g. as
+     * packed into a worker message).
+     * @param {ArrayLike<number>} squares - NUM_SQUARES piece codes (EMPTY for none).
+     * @param {number} sideToMove - Player whose turn it is.
+     * @returns {Position}
+     */
+    static fromSquares(squares, sideToMove) {
+        const pos = new Position();
+        for (let sq = 0; sq < NUM_SQUARES; sq++) {
+            const code = squares[sq];
+            if (code === EMPTY) continue;
+            if (!(code > EMPTY && code < NUM_PIECE_CODES)) {
+                console.warn(`[Position] Skipped invalid piece code ${code} on square ${sq}`);
+                continue;
+            }
+            pos.addPiece(sq, code);
+        }
+        pos.sideToMove = sideToMove;
+        pos.computeHash();
+        return pos;
+    }
+
+    /**
+     * Converts back to the nested format used by board.getClonedStateForWorker().
+     * @returns {Array<Array<object>>}
+     */
+    toBoardState() {
+        const state = [];
+        for (let r = 0; r < BOARD_ROWS; r++) {
+            const row = [];
+            for (let c = 0; c < BOARD_COLS; c++) {
+                const sq = toSquare(r, c);
+                const code = this.squares[sq];
+                let piece = null;
+                if (code !== EMPTY) {
+                    const type = PIECE_TYPES[codeType(code)];
+                    const data = PIECES[type];
+                    piece = { type, name: data.name, rank: data.rank, symbol: data.symbol, player: codePlayer(code), row: r, col: c, value: data.value };
+                }
+                row.push({ terrain: TERRAIN_TABLE[sq], piece });
+            }
+            state.push(row);
+        }
+        return state;
+    }
+
+    /** Recomputes hashLo/hashHi from scratch (same key as computeZobristKey on the nested format). */
+    computeHash() {
+        let lo = 0;
+        let hi = 0;
+        for (let sq = 0; sq < NUM_SQUARES; sq++) {
+            const code = this.squares[sq];
+            if (code !== EMPTY) {
+                lo ^= ZOBRIST_LO[code * NUM_SQUARES + sq];
+                hi ^= ZOBRIST_HI[code * NUM_SQUARES + sq];
+            }
+        }
+        if (this.sideToMove === Player.PLAYER1) {
+            lo ^= SIDE_LO;
+            hi ^= SIDE_HI;
+        }
+        this.hashLo = lo;
+        this.hashHi = hi;
+    }
+
+    /** The Zobrist key as a single 53-bit number (equals computeZobristKey for the same position). */
+    hashKey() {
+        return combineHashHalves(this.hashLo, this.hashHi);
+    }
+
+    // --- Piece List Maintenance ---
+
+    addPiece(sq, code) {
+        const player = codePlayer(code);
+        const index = this.pieceCount[player]++;
+        this.pieceList[player * MAX_PIECES_PER_SIDE + index] = sq;
+        this.listIndex[sq] = index;
+        this.squares[sq] = code;
+    }
+
+    removePiece(sq) {
+        const player = codePlayer(this.squares[sq]);
+        const base = player * MAX_PIECES_PER_SIDE;
+        const index = this.listIndex[sq];
+        const lastIndex = --this.pieceCount[player];
+        const lastSq = this.pieceList[base + lastIndex];
+        this.pieceList[base + index] = lastSq; // Move the last entry into the hole
+        this.listIndex[lastSq] = index;
+        this.listIndex[sq] = -1;
+        this.squares[sq] = EMPTY;
+    }
+
+    /** Puts a piece back into the exact list slot removePiece took it from. */
+    restorePiece(sq, code, index) {
+        const player = codePlayer(code);
+        const base = player * MAX_PIECES_PER_SIDE;
+        const count = this.pieceCount[player]++;
+        if (index < count) { // Undo the "last entry into the hole" swap
+            const movedSq = this.pieceList[base + index];
+            this.pieceList[base + count] = movedSq;
+            this.listIndex[movedSq] = count;
+        }
+        this.pieceList[base + index] = sq;
+        this.listIndex[sq] = index;
+        this.squares[sq] = code;
+    }
+
+    /** Returns the square of the i-th piece of a player. */
+    pieceSquare(player, i) {
+        return this.pieceList[player * MAX_PIECES_PER_SIDE + i];
+    }
+
+    // --- Make/Unmake ---
+
+    /**
+     * Applies a move in place, toggles the side to move and pushes undo data.
+     * @param {number} move - Encoded move (see encodeMove).
+     */
+    makeMove(move) {
+        const from = move & 63;
+        const to = (move >> 6) & 63;
+        const code = this.squares[from];
+        const captured = this.squares[to];
+
+        this.hashLoStack[this.ply] = this.hashLo;
+        this.hashHiStack[this.ply] = this.hashHi;
+        this.capturedStack[this.ply] = captured;
+        this.ply++;
+
+        const fromIndex = code * NUM_SQUARES + from;
+        const toIndex = code * NUM_SQUARES + to;
+        let lo = this.hashLo ^ ZOBRIST_LO[fromIndex] ^ ZOBRIST_LO[toIndex] ^ SIDE_LO;
+        let hi = this.hashHi ^ ZOBRIST_HI[fromIndex] ^ ZOBRIST_HI[toIndex] ^ SIDE_HI;
+        if (captured !== EMPTY) {
+            lo ^= ZOBRIST_LO[captured * NUM_SQUARES + to];
+            hi ^= ZOBRIST_HI[captured * NUM_SQUARES + to];
+            this.capturedIndexStack[this.ply - 1] = this.listIndex[to];
+            this.removePiece(to);
+        }
+        // Move the piece, keeping its slot in the piece list
+        const index = this.listIndex[from];
+        this.pieceList[codePlayer(code) * MAX_PIECES_PER_SIDE + index] = to;
+        this.listIndex[to] = index;
+        this.listIndex[from] = -1;
+        this.squares[to] = code;
+        this.squares[from] = EMPTY;
+
+        this.sideToMove ^= 1;
+        this.hashLo = lo;
+        this.hashHi = hi;
+    }
+
+    /** Passes the turn without moving (null-move pruning in the search); pushes undo data. */
+    makeNullMove() {
+        this.hashLoStack[this.ply] = this.hashLo;
+        this.hashHiStack[this.ply] = this.hashHi;
+        this.capturedStack[this.ply] = EMPTY;
+        this.ply++;
+        this.sideToMove ^= 1;
+        this.hashLo ^= SIDE_LO;
+        this.hashHi ^= SIDE_HI;
+    }
+
+    /** Reverts makeNullMove. */
+    unmakeNullMove() {
+        this.ply--;
+        this.sideToMove ^= 1;
+        this.hashLo = this.hashLoStack[this.ply];
+        this.hashHi = this.hashHiStack[this.ply];
+    }
+
+    /** Piece code captured by the last move made (EMPTY for a quiet move or at the stack bottom). */
+    lastCapturedCode() {
+        return this.ply > 0 ? this.capturedStack[this.ply - 1] : EMPTY;
+    }
+
+    /**
+     * Reverts the last move applied with makeMove, restoring piece-list order exactly.
+     * @param {number} move - The same encoded move.
+     */
+    unmakeMove(move) {
+        const from = move & 63;
+        const to = (move >> 6) & 63;
+        const code = this.squares[to];
+
+        this.ply--;
+        const captured = this.capturedStack[this.ply];
+
+        const index = this.listIndex[to];
+        this.pieceList[codePlayer(code) * MAX_PIECES_PER_SIDE + index] = from;
+        this.listIndex[from] = index;
+        this.listIndex[to] = -1;
+        this.squares[from] = code;
+        this.squares[to] = EMPTY;
+        if (captured !== EMPTY) this.restorePiece(to, captured, this.capturedIndexStack[this.ply]);
+
+        this.sideToMove ^= 1;
+        this.hashLo = this.hashLoStack[this.ply];
+        this.hashHi = this.hashHiStack[this.ply];
+    }
+}
@@ -5,11 +5,11 @@ import {
   TILESET_COLS, TILESET_ROWS, // Ensure these are correctly set in constants.js!
   DECORATION_IMAGES, DECORATION_CHANCE, TILE_CONFIG_MAP,
   WATER_BACKGROUND,
-  BASE_ASSETS_PATH, // Assuming you added this for piece paths too
   TRAP_BACKGROUND,
   BRIGDE_DECORATION,
   DEN_DECORATION
 } from './constants.js';
+import { assetUrl, pieceImageUrl } from './assetLoader.js';
 
 const colLabelsTop = document.getElementById('col-labels-top');
 const colLabelsBottom = document.getElementById('col-labels-bottom');
@@ -23,6 +23,7 @@ let landTilePatterns = null;
 export function initializeLandTilePatterns(boardState) {
 	console.log("Initializing land tile patterns...");
 	landTilePatterns = Array(BOARD_ROWS).fill(null).map(() => Array(BOARD_COLS).fill(null));
+	squareNodes = null; // New decorations: the next render rebuilds the grid
 	for (let r = 0; r < BOARD_ROWS; r++) {
 		for (let c = 0; c < BOARD_COLS; c++) {
             if (DECORATION_IMAGES.length > 0 && Math.random() < DECORATION_CHANCE){
@@ -50,204 +51,249 @@ function getTileConfigurationKey(boardState, r, c) {
     return TILE_CONFIG_MAP[configKey] ? configKey : "LLLL";
 }
 
-export function renderBoard(boardState, clickHandler, lastMove = null) {
-    if (!boardElement) { console.error("Board element not found!"); return; }
+// --- Persistent Grid ---
+// The 63 squares (terrain, decorations, overlays) are built once, and again only after
+// initializeLandTilePatterns changes the decorations. Later renders patch the squares
+// whose piece or last-move highlight changed, and clear selection and move highlights.
+let squareNodes = null; // [r][c] -> { square, highlightOverlay, pieceElement, pieceKey, lastMoveClass }
+let currentClickHandler = null; // The squares' listeners call the handler of the latest render
 
-    const fragment = document.createDocumentFragment();
+const LAST_MOVE_CLASSES = ['last-move-start-p0', 'last-move-start-p1', 'last-move-end-p0', 'last-move-end-p1'];
 
-    // --- Clear previous dynamic state ---
-    // Clear selection highlights
-    boardElement.querySelectorAll('.square.selected').forEach(sq => sq.classList.remove('selected'));
-    // Clear previous last move highlights from overlays
-    const lastMoveClasses = ['last-move-start-p0', 'last-move-start-p1', 'last-move-end-p0', 'last-move-end-p1'];
-    boardElement.querySelectorAll('.highlight-overlay').forEach(overlay => {
-        overlay.classList.remove(...lastMoveClasses);
-    });
-     // Clear previous action highlights (if different from standard highlights)
-     boardElement.querySelectorAll('.action-highlight-overlay').forEach(overlay => {
-         // Assuming action highlights have specific classes to remove, e.g., 'possible-move', 'capture-move'
-         overlay.classList.remove('possible-move', 'capture-move'); // Adjust classes as needed
-     });
-     // Remove all previously added decorations or texture overlays
-     boardElement.querySelectorAll('.decoration, .trap-texture-container, .den-texture-container').forEach(el => el.remove());
+/** Builds the static part of one square: terrain background, decorations and the highlight overlays. */
+function buildSquareElement(boardState, r, c, landBackgroundSize) {
+    const squareElement = document.createElement('div');
+    squareElement.className = 'square'; // Base class
+    squareElement.dataset.row = r;
+    squareElement.dataset.col = c;
 
+    const cellData = boardState[r]?.[c];
+    if (!cellData) { console.warn(`Missing cell data for ${r},${c}`); return null; }
+
+    const terrain = cellData.terrain;
+
+    // Add base terrain class (used for CSS background-color, borders)
+    squareElement.classList.add(`terrain-${terrain}`);
+
+    // Reset background styles & apply pixelated rendering for crisp scaling
+    squareElement.style.backgroundImage = '';
+    squareElement.style.backgroundPosition = '';
+    squareElement.style.backgroundSize = '';
+    squareElement.style.backgroundRepeat = '';
+    squareElement.style.imageRendering = ''; 
+    // squareElement.style.imageRendering = 'pĩxelated'; // Keep pixelated rendering
 
-    // --- Pre-calculate values used in the loop ---
-    const lastMoveStartKey = lastMove ? `${lastMove.start.r}-${lastMove.start.c}` : null;
-    const lastMoveEndKey = lastMove ? `${lastMove.end.r}-${lastMove.end.c}` : null;
-    const lastMovePlayerSuffix = lastMove ? `p${lastMove.player}` : null;
+
+    // --- STEP 1: Render Base Tile Background ---
+    // This switch focuses *only* on setting the background of the square itself
+    if (r >= 3 && r <= 5) {
+        // if (r === 3)squareElement.style.backgroundImage = `url('${UP_WATER_BACKGROUND}')`;
+        // if (r === 4)squareElement.style.backgroundImage = `url('${WATER_BACKGROUND}')`;
+        // if (r === 5)squareElement.style.backgroundImage = `url('${DOWN_WATER_BACKGROUND}')`;
+        squareElement.style.backgroundImage = `url('${WATER_BACKGROUND}')`;
+        squareElement.style.backgroundSize = 'cover';
+        squareElement.style.backgroundPosition = 'center';
+        squareElement.style.backgroundRepeat = 'no-repeat';
+    } else if (terrain === TERRAIN_LAND) {
+        squareElement.style.backgroundImage = `url('${TILESET_IMAGE}')`;
+        const configKey = getTileConfigurationKey(boardState, r, c);
+        const bgPos = TILE_CONFIG_MAP[configKey]; // Offset based on TILESET_TILE_SIZE_PX
+        if (bgPos) {
+            // landBackgroundSize is calculated outside the loop using TILESET_COLS, TILESET_ROWS, TILE_DISPLAY_SIZE_PX
+            // e.g., const totalScaledWidth = TILESET_COLS * TILE_DISPLAY_SIZE_PX; ...
+            // const landBackgroundSize = `${totalScaledWidth}px ${totalScaledHeight}px`;
+            squareElement.style.backgroundPosition = bgPos;
+            squareElement.style.backgroundSize = landBackgroundSize;
+            squareElement.style.backgroundRepeat = 'no-repeat';
+        } else {
+             console.warn(`Missing background position for config key: ${configKey} at ${r},${c}. Check TILE_CONFIG_MAP.`);
+             squareElement.style.backgroundImage = ''; // Fallback: no background image
+        }
+         // Decoration logic remains in STEP 2
+    } else if (terrain === TERRAIN_TRAP) {
+         // NOTE: Based on the *provided switch case*, Traps also get the WATER_BACKGROUND here.
+         // If you intended them to have a solid color from CSS only, you would remove this else if block.
+        squareElement.style.backgroundImage = `url('${TRAP_BACKGROUND}')`; // Applying Water background as per original switch
+        squareElement.style.backgroundSize = 'cover';
+        squareElement.style.backgroundPosition = 'center';
+        squareElement.style.backgroundRepeat = 'no-repeat';
+    } else if (terrain === TERRAIN_PLAYER0_DEN || terrain === TERRAIN_PLAYER1_DEN) {
+        // NOTE: Based on the *provided switch case*, Traps also get the WATER_BACKGROUND here.
+        // If you intended them to have a solid color from CSS only, you would remove this else if block.
+        squareElement.style.backgroundImage = `url('${TILESET_IMAGE}')`; // Applying Water background as per original switch
+        squareElement.style.backgroundPosition = TILE_CONFIG_MAP['Den'];
+        squareElement.style.backgroundSize = landBackgroundSize; // Apply calculated scaled size
+        squareElement.style.backgroundRepeat = 'no-repeat';
+    }
+
+    // --- STEP 2: Render Decorations and Texture Overlays (as child elements) ---
+    // This switch/section focuses on adding child <img> or <div> overlays
+    if (r >= 3 && r <= 5 ) {
+        const decoDiv = document.createElement('div');
+        decoDiv.className = 'trap-texture-container'; // CSS handles positioning
+        decoDiv.className = 'terrain-water';
+        decoDiv.style.backgroundImage = `url('${TILESET_IMAGE}')`;
+        decoDiv.style.backgroundSize = landBackgroundSize; // Apply calculated scaled size
+        decoDiv.style.backgroundRepeat = 'no-repeat';
+        if (r === 3) {
+            decoDiv.style.backgroundPosition = TILE_CONFIG_MAP['UPW'];
+            squareElement.appendChild(decoDiv);
+        }else if (r === 5){
+            decoDiv.style.backgroundPosition = TILE_CONFIG_MAP['DOW'];
+            squareElement.appendChild(decoDiv);
+        }
+        if ( terrain === TERRAIN_LAND){
+            const decoImg = document.createElement('img');
+            decoImg.src = assetUrl(BRIGDE_DECORATION);
+            decoImg.style.zIndex = '2';
+            decoImg.alt = 'Decoration';
+            decoImg.style.height = '100%';
+            decoImg.style.width = '100%';
+            squareElement.appendChild(decoImg);
+        }
+    } else if (terrain === TERRAIN_LAND) {
+        // Add random decorations on top of land tiles
+        if(landTilePatterns[r][c] !== null){
+            const randomDecoration = DECORATION_IMAGES[landTilePatterns[r][c]];
+            const decoImg = document.createElement('img');
+            decoImg.src = assetUrl(randomDecoration);
+            decoImg.alt = 'Decoration';
+            decoImg.className = 'decoration'; // CSS handles size/position
+            squareElement.appendChild(decoImg);
+        }
+    } else if (terrain === TERRAIN_WATER) {
+    } else if (terrain === TERRAIN_TRAP) {
+    } else if (terrain === TERRAIN_PLAYER0_DEN || terrain === TERRAIN_PLAYER1_DEN) {
+         // Add the specific den texture overlay image element
+         const den0TextureContainer = document.createElement('div');
+         den0TextureContainer.className = 'den-texture-container'; // CSS handles positioning
+         const den0Img = document.createElement('img');
+         den0Img.src = assetUrl(DEN_DECORATION); // Use constant path (requires DEN_PLAYER0_TEXTURE constant)
+         den0Img.style.width = '100%';
+         den0Img.style.height = '100%';
+         den0Img.alt = terrain === TERRAIN_PLAYER0_DEN ? 'Player 0 Den' : 'Player 1 Den';
+        //  den0Img.className = 'terrain-texture-img'; // CSS handles size
+         den0TextureContainer.appendChild(den0Img);
+         squareElement.appendChild(den0TextureContainer);
+    }
+
+
+    // --- STEP 3: Add Highlight Overlays ---
+    // These appear above tiles and decorations, below pieces
+    const highlightOverlay = document.createElement('div');
+    highlightOverlay.className = 'highlight-overlay'; // Base class for general styling; last-move classes are patched
+    squareElement.appendChild(highlightOverlay);
+
+    // Add the separate overlay for action highlights (possible moves, captures)
+    const actionHighlightOverlay = document.createElement('div');
+    actionHighlightOverlay.className = 'action-highlight-overlay'; // Specific class for actions
+    squareElement.appendChild(actionHighlightOverlay);
+
+    squareElement.addEventListener('click', () => { if (currentClickHandler) currentClickHandler(r, c); });
+    return squareElement;
+}
+
+function buildGrid(boardState) {
+    const fragment = document.createDocumentFragment();
 
     // Calculate the target background size for the SCALED tileset ONCE
     const totalScaledWidth = TILESET_COLS * TILE_DISPLAY_SIZE_PX;
     const totalScaledHeight = TILESET_ROWS * TILE_DISPLAY_SIZE_PX;
     const landBackgroundSize = `${totalScaledWidth}px ${totalScaledHeight}px`;
 
-
-    // --- Loop through board squares ---
+    squareNodes = [];
     for (let r = 0; r < BOARD_ROWS; r++) {
+        const row = [];
         for (let c = 0; c < BOARD_COLS; c++) {
-            const squareElement = document.createElement('div');
-            squareElement.className = 'square'; // Base class
-            squareElement.dataset.row = r;
-            squareElement.dataset.col = c;
-            const currentSquareKey = `${r}-${c}`;
-
-            const cellData = boardState[r]?.[c];
-            if (!cellData) { console.warn(`Missing cell data for ${r},${c}`); continue; }
-
-            const terrain = cellData.terrain;
-            const pieceData = cellData.piece;
-
-            // Add base terrain class (used for CSS background-color, borders)
-            squareElement.classList.add(`terrain-${terrain}`);
-
-            // Reset background styles & apply pixelated rendering for crisp scaling
-            squareElement.style.backgroundImage = '';
-            squareElement.style.backgroundPosition = '';
-            squareElement.style.backgroundSize = '';
-            squareElement.style.backgroundRepeat = '';
-            squareElement.style.imageRendering = ''; 
-            // squareElement.style.imageRendering = 'pĩxelated'; // Keep pixelated rendering
-
-
-            // --- STEP 1: Render Base Tile Background ---
-            // This switch focuses *only* on setting the background of the square itself
-            if (r >= 3 && r <= 5) {
-                // if (r === 3)squareElement.style.backgroundImage = `url('${UP_WATER_BACKGROUND}')`;
-                // if (r === 4)squareElement.style.backgroundImage = `url('${WATER_BACKGROUND}')`;
-                // if (r === 5)squareElement.style.backgroundImage = `url('${DOWN_WATER_BACKGROUND}')`;
-                squareElement.style.backgroundImage = `url('${WATER_BACKGROUND}')`;
-                squareElement.style.backgroundSize = 'cover';
-                squareElement.style.backgroundPosition = 'center';
-                squareElement.style.backgroundRepeat = 'no-repeat';
-            } else if (terrain === TERRAIN_LAND) {
-                squareElement.style.backgroundImage = `url('${TILESET_IMAGE}')`;
-                const configKey = getTileConfigurationKey(boardState, r, c);
-                const bgPos = TILE_CONFIG_MAP[configKey]; // Offset based on TILESET_TILE_SIZE_PX
-                if (bgPos) {
-                    // landBackgroundSize is calculated outside the loop using TILESET_COLS, TILESET_ROWS, TILE_DISPLAY_SIZE_PX
-                    // e.g., const totalScaledWidth = TILESET_COLS * TILE_DISPLAY_SIZE_PX; ...
-                    // const landBackgroundSize = `${totalScaledWidth}px ${totalScaledHeight}px`;
-                    squareElement.style.backgroundPosition = bgPos;
-                    squareElement.style.backgroundSize = landBackgroundSize;
-                    squareElement.style.backgroundRepeat = 'no-repeat';
-                } else {
-                     console.warn(`Missing background position for config key: ${configKey} at ${r},${c}. Check TILE_CONFIG_MAP.`);
-                     squareElement.style.backgroundImage = ''; // Fallback: no background image
-                }
-                 // Decoration logic remains in STEP 2
-            } else if (terrain === TERRAIN_TRAP) {
-                 // NOTE: Based on the *provided switch case*, Traps also get the WATER_BACKGROUND here.
-                 // If you intended them to have a solid color from CSS only, you would remove this else if block.
-                squareElement.style.backgroundImage = `url('${TRAP_BACKGROUND}')`; // Applying Water background as per original switch
-                squareElement.style.backgroundSize = 'cover';
-                squareElement.style.backgroundPosition = 'center';
-                squareElement.style.backgroundRepeat = 'no-repeat';
-            } else if (terrain === TERRAIN_PLAYER0_DEN || terrain === TERRAIN_PLAYER1_DEN) {
-                // NOTE: Based on the *provided switch case*, Traps also get the WATER_BACKGROUND here.
-                // If you intended them to have a solid color from CSS only, you would remove this else if block.
-                squareElement.style.backgroundImage = `url('${TILESET_IMAGE}')`; // Applying Water background as per original switch
-                squareElement.style.backgroundPosition = TILE_CONFIG_MAP['Den'];
-                squareElement.style.backgroundSize = landBackgroundSize; // Apply calculated scaled size
-                squareElement.style.backgroundRepeat = 'no-repeat';
-            }
+            const square = buildSquareElement(boardState, r, c, landBackgroundSize) || document.createElement('div');
+            row.push({
+                square,
+                highlightOverlay: square.querySelector('.highlight-overlay'),
+                pieceElement: null,
+                pieceKey: null,
+                lastMoveClass: null
+            });
+            fragment.appendChild(square);
+        }
+        squareNodes.push(row);
+    }
+    boardElement.innerHTML = ''; // Drop whatever was there before the grid
+    boardElement.appendChild(fragment);
+}
 
-            // --- STEP 2: Render Decorations and Texture Overlays (as child elements) ---
-            // This switch/section focuses on adding child <img> or <div> overlays
-            if (r >= 3 && r <= 5 ) {
-                const decoDiv = document.createElement('div');
-                decoDiv.className = 'trap-texture-container'; // CSS handles positioning
-                decoDiv.className = 'terrain-water';
-                decoDiv.style.backgroundImage = `url('${TILESET_IMAGE}')`;
-                decoDiv.style.backgroundSize = landBackgroundSize; // Apply calculated scaled size
-                decoDiv.style.backgroundRepeat = 'no-repeat';
-                if (r === 3) {
-                    decoDiv.style.backgroundPosition = TILE_CONFIG_MAP['UPW'];
-                    squareElement.appendChild(decoDiv);
-                }else if (r === 5){
-                    decoDiv.style.backgroundPosition = TILE_CONFIG_MAP['DOW'];
-                    squareElement.appendChild(decoDiv);
-                }
-                if ( terrain === TERRAIN_LAND){
-                    const decoImg = document.createElement('img');
-                    decoImg.src = BRIGDE_DECORATION;
-                    decoImg.style.zIndex = '2';
-                    decoImg.alt = 'Decoration';
-                    decoImg.loading = 'lazy';
-                    decoImg.style.height = '100%';
-                    decoImg.style.width = '100%';
-                    squareElement.appendChild(decoImg);
-                }
-            } else if (terrain === TERRAIN_LAND) {
-                // Add random decorations on top of land tiles
-                if(landTilePatterns[r][c] !== null){
-                    const randomDecoration = DECORATION_IMAGES[landTilePatterns[r][c]];
-                    const decoImg = document.createElement('img');
-                    decoImg.src = randomDecoration;
-                    decoImg.alt = 'Decoration';
-                    decoImg.className = 'decoration'; // CSS handles size/position
-                    decoImg.loading = 'lazy';
-                    squareElement.appendChild(decoImg);
-                }
-            } else if (terrain === TERRAIN_WATER) {
-            } else if (terrain === TERRAIN_TRAP) {
-            } else if (terrain === TERRAIN_PLAYER0_DEN || terrain === TERRAIN_PLAYER1_DEN) {
-                 // Add the specific den texture overlay image element
-                 const den0TextureContainer = document.createElement('div');
-                 den0TextureContainer.className = 'den-texture-container'; // CSS handles positioning
-                 const den0Img = document.createElement('img');
-                 den0Img.src = DEN_DECORATION; // Use constant path (requires DEN_PLAYER0_TEXTURE constant)
-                 den0Img.style.width = '100%';
-                 den0Img.style.height = '100%';
-                 den0Img.alt = terrain === TERRAIN_PLAYER0_DEN ? 'Player 0 Den' : 'Player 1 Den';
-                //  den0Img.className = 'terrain-texture-img'; // CSS handles size
-                 den0TextureContainer.appendChild(den0Img);
-                 squareElement.appendChild(den0TextureContainer);
-            }
+function createPieceElement(pieceData) {
+    const pieceElement = document.createElement('div');
+    pieceElement.className = `piece player${pieceData.player}`;
+    const imgElement = document.createElement('img');
+    imgElement.src = pieceImageUrl(pieceData.type); // Atlas sprite once preloaded
+    imgElement.alt = pieceData.name || pieceData.type;
+    pieceElement.appendChild(imgElement);
+    pieceElement.dataset.pieceType = pieceData.type;
+    pieceElement.dataset.player = pieceData.player;
+    return pieceElement;
+}
 
+/**
+ * Makes the square show `pieceData` (or nothing). A piece element the move animation
+ * left in the square is reused when it shows the same piece.
+ */
+function patchPiece(node, pieceData, pieceKey) {
+    const { square } = node;
+    let reused = null;
+    square.querySelectorAll('.piece').forEach(el => {
+        if (!reused && pieceData && el.dataset.pieceType === pieceData.type && el.dataset.player === String(pieceData.player)) {
+            reused = el;
+        } else {
+            el.remove();
+        }
+    });
+    node.pieceElement = null;
+    if (pieceData) {
+        node.pieceElement = reused || createPieceElement(pieceData);
+        if (node.pieceElement.parentElement !== square || square.lastElementChild !== node.pieceElement) {
+            square.appendChild(node.pieceElement); // Pieces are the top layer
+        }
+    }
+    node.pieceKey = pieceKey;
+}
 
-            // --- STEP 3: Add Highlight Overlays ---
-            // These appear above tiles and decorations, below pieces
-            const highlightOverlay = document.createElement('div');
-            highlightOverlay.className = 'highlight-overlay'; // Base class for general styling
-            if (currentSquareKey === lastMoveStartKey) {
-                highlightOverlay.classList.add(`last-move-start-${lastMovePlayerSuffix}`);
-            } else if (currentSquareKey === lastMoveEndKey) {
-                highlightOverlay.classList.add(`last-move-end-${lastMovePlayerSuffix}`);
-            }
-            squareElement.appendChild(highlightOverlay);
-
-            // Add the separate overlay for action highlights (possible moves, captures)
-            const actionHighlightOverlay = document.createElement('div');
-            actionHighlightOverlay.className = 'action-highlight-overlay'; // Specific class for actions
-            squareElement.appendChild(actionHighlightOverlay);
-
-
-            // --- STEP 4: Render Piece ---
-            // Pieces appear on the top layer
-            if (pieceData && pieceData.type) {
-                const pieceElement = document.createElement('div');
-                pieceElement.className = `piece player${pieceData.player}`;
-                const imgElement = document.createElement('img');
-                // Consider using BASE_ASSETS_PATH here too for consistency
-                imgElement.src = `${BASE_ASSETS_PATH}images/head_no_background/${pieceData.type}.png`;
-                imgElement.alt = pieceData.name || pieceData.type;
-                pieceElement.appendChild(imgElement);
-                pieceElement.dataset.pieceType = pieceData.type;
-                pieceElement.dataset.player = pieceData.player;
-                squareElement.appendChild(pieceElement);
-            }
+export function renderBoard(boardState, clickHandler, lastMove = null) {
+    if (!boardElement) { console.error("Board element not found!"); return; }
 
-            // --- STEP 5: Add Click Listener ---
-            squareElement.addEventListener('click', () => clickHandler(r, c));
+    currentClickHandler = clickHandler;
+    if (!squareNodes || !boardElement.contains(squareNodes[0][0].square)) buildGrid(boardState);
 
-            // --- STEP 6: Append Square to Fragment ---
-            fragment.appendChild(squareElement);
-        } // End for c
-    } // End for r
+    // --- Clear per-render highlights (only the squares that have them) ---
+    boardElement.querySelectorAll('.square.selected').forEach(sq => sq.classList.remove('selected'));
+    boardElement.querySelectorAll('.action-highlight-overlay.possible-move, .action-highlight-overlay.capture-move, .action-highlight-overlay.hint-move')
+        .forEach(overlay => overlay.classList.remove('possible-move', 'capture-move', 'hint-move'));
+
+    // --- Pre-calculate values used in the loop ---
+    const lastMovePlayerSuffix = lastMove ? `p${lastMove.player}` : null;
+
+    // --- Patch the squares that changed ---
+    for (let r = 0; r < BOARD_ROWS; r++) {
+        for (let c = 0; c < BOARD_COLS; c++) {
+            const node = squareNodes[r][c];
+            const pieceData = boardState[r]?.[c]?.piece || null;
 
-    // --- Final DOM Update ---
-    boardElement.innerHTML = ''; // Clear the entire board content
-    boardElement.appendChild(fragment); // Append all newly created squares at once
+            // Last-move highlight
+            let lastMoveClass = null;
+            if (lastMove && lastMove.start.r === r && lastMove.start.c === c) lastMoveClass = `last-move-start-${lastMovePlayerSuffix}`;
+            else if (lastMove && lastMove.end.r === r && lastMove.end.c === c) lastMoveClass = `last-move-end-${lastMovePlayerSuffix}`;
+            if (lastMoveClass !== node.lastMoveClass || (lastMoveClass && !node.highlightOverlay.classList.contains(lastMoveClass))) {
+                node.highlightOverlay.classList.remove(...LAST_MOVE_CLASSES);
+                if (lastMoveClass) node.highlightOverlay.classList.add(lastMoveClass);
+                node.lastMoveClass = lastMoveClass;
+            }
+
+            // Piece (also re-checked when the animation moved or removed the element)
+            const pieceKey = pieceData && pieceData.type ? `${pieceData.player}-${pieceData.type}` : null;
+            const pieceInPlace = node.pieceElement ? node.pieceElement.parentElement === node.square : pieceKey === null;
+            if (pieceKey !== node.pieceKey || !pieceInPlace) {
+                patchPiece(node, pieceKey ? pieceData : null, pieceKey);
+            }
+        }
+    }
     renderCoordinatesIfNeeded(); // Render coordinate labels if not already done
-} // End renderBoard
\ No newline at end of file
+} // End renderBoard
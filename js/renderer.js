@@ -3,6 +3,7 @@ import {
     Player, PIECES, ANIMATION_DURATION,
 } from './constants.js';
 import { getString } from './localization.js';
+import { pieceImageUrl, playSoundEffect } from './assetLoader.js';
 
 // DOM Elements Cache
 const boardElement = document.getElementById('board');
@@ -26,6 +27,7 @@ const SIGMOID_SCALE_FACTOR = 0.0015;
 const highlightClassTargets = {
     'possible-move': '.action-highlight-overlay',
     'capture-move': '.action-highlight-overlay',
+    'hint-move': '.action-highlight-overlay',
     'selected': '.square',
     'last-move-start-p0': '.highlight-overlay',
     'last-move-start-p1': '.highlight-overlay',
@@ -65,8 +67,7 @@ export function animatePieceMove(pieceElement, startSquare, endSquare, isCapture
     requestAnimationFrame(() => { requestAnimationFrame(() => { pieceElement.style.transition = `left ${ANIMATION_DURATION / 1000}s ease-out, top ${ANIMATION_DURATION / 1000}s ease-out`; pieceElement.style.left = `${targetLeft}px`; pieceElement.style.top = `${targetTop}px`; }); });
     setTimeout(() => {
         pieceElement.style.transition = 'none'; pieceElement.classList.remove('piece-global-animating');
-        const squareContent = endSquare.querySelector(':not(.highlight-overlay):not(.action-highlight-overlay)') || endSquare;
-        squareContent.appendChild(pieceElement);
+        endSquare.appendChild(pieceElement); // renderBoard keeps this element for the piece's new square
         pieceElement.style.position = ''; pieceElement.style.top = ''; pieceElement.style.left = ''; pieceElement.style.transform = '';
         const soundName = isCapture ? `capture_${capturedPieceType}` : 'move'; if (soundName && (!isCapture || capturedPieceType)) { playSound(soundName); }
         onComplete();
@@ -118,12 +119,46 @@ export function clearHighlights(className) {
 }
 
 export function updateStatus(messageKey, params = {}, isError = false) { if (!statusElement) return; const message = getString(messageKey, params); statusElement.textContent = message; statusElement.classList.toggle('error-message', isError); }
-export function updateTurnDisplay(currentPlayer, gameMode = 'PVA', isGameOver = false) { if (!turnElement) return; if (isGameOver) { turnElement.textContent = '---'; return; } let playerLabelKey; if (gameMode === 'PVP') { playerLabelKey = (currentPlayer === Player.PLAYER0) ? 'player1Name' : 'player2Name'; } else { playerLabelKey = (currentPlayer === Player.PLAYER0) ? 'playerName' : 'aiName'; } turnElement.textContent = getString(playerLabelKey); }
-export function renderCapturedPieces(capturedByPlayer0, capturedByPlayer1) { const renderPanel = (container, piecesList) => { if (!container) return; container.innerHTML = ''; if (piecesList.length === 0) { container.textContent = getString('capturedNone'); return; } piecesList.sort((a, b) => (PIECES[b.type]?.rank ?? 0) - (PIECES[a.type]?.rank ?? 0)); piecesList.forEach(p => { if (!p || !p.type) return; const el = document.createElement('span'); const capturingPlayer = Player.getOpponent(p.player); el.className = `captured-piece player${capturingPlayer}`; const img = document.createElement('img'); img.src = `assets/images/head_no_background/${p.type}.png`; img.alt = p.name || p.type; img.title = getString(`animal_${p.type}`) || p.name || p.type; el.appendChild(img); container.appendChild(el); }); }; renderPanel(capturedByPlayer0Container, capturedByPlayer0); renderPanel(capturedByPlayer1Container, capturedByPlayer1); }
-export function addMoveToHistory(pieceData, fromR, fromC, toR, toC, capturedPieceData) { if (!moveListElement) return; const getAlgebraic = (r, c) => `${String.fromCharCode(65 + c)}${BOARD_ROWS - r}`; const startNotation = getAlgebraic(fromR, fromC); const endNotation = getAlgebraic(toR, toC); const pieceImgSrc = `assets/images/head_no_background/${pieceData.type}.png`; const pieceName = getString(`animal_${pieceData.type}`) || pieceData.name || pieceData.type; const pieceAlt = `${PIECES[pieceData.type]?.symbol || pieceName}`; let moveHtml = `<span class="piece-hist player${pieceData.player}"><img src="${pieceImgSrc}" alt="${pieceAlt}" title="${pieceName}"></span> ${startNotation} → ${endNotation}`; if (capturedPieceData) { const capturedImgSrc = `assets/images/head_no_background/${capturedPieceData.type}.png`; const capturedName = getString(`animal_${capturedPieceData.type}`) || capturedPieceData.name || capturedPieceData.type; const capturedAlt = `${PIECES[capturedPieceData.type]?.symbol || capturedName}`; moveHtml += ` (x <span class="piece-hist player${capturedPieceData.player}"><img src="${capturedImgSrc}" alt="${capturedAlt}" title="${capturedName}"></span>)`; } const li = document.createElement('li'); li.innerHTML = moveHtml; moveListElement.appendChild(li); moveListElement.scrollTop = moveListElement.scrollHeight; if (undoButton) undoButton.disabled = false;}
+/**
+ * Localization key of a player's display name in a game mode ('PVA', 'PVP' or 'AVA').
+ * @param {number} aiPlayer - Side the AI plays in 'PVA'.
+ */
+export function getPlayerLabelKey(player, gameMode = 'PVA', aiPlayer = Player.PLAYER1) {
+    if (gameMode === 'PVP') return (player === Player.PLAYER0) ? 'player1Name' : 'player2Name';
+    if (gameMode === 'AVA' || player === aiPlayer) return (player === Player.PLAYER1) ? 'aiName' : 'aiNameBlue';
+    return (player === Player.PLAYER0) ? 'playerName' : 'playerNameRed';
+}
+export function updateTurnDisplay(currentPlayer, gameMode = 'PVA', isGameOver = false, aiPlayer = Player.PLAYER1) { if (!turnElement) return; if (isGameOver) { turnElement.textContent = '---'; return; } turnElement.textContent = getString(getPlayerLabelKey(currentPlayer, gameMode, aiPlayer)); }
+export function renderCapturedPieces(capturedByPlayer0, capturedByPlayer1) { const renderPanel = (container, piecesList) => { if (!container) return; container.innerHTML = ''; if (piecesList.length === 0) { container.textContent = getString('capturedNone'); return; } piecesList.sort((a, b) => (PIECES[b.type]?.rank ?? 0) - (PIECES[a.type]?.rank ?? 0)); piecesList.forEach(p => { if (!p || !p.type) return; const el = document.createElement('span'); const capturingPlayer = Player.getOpponent(p.player); el.className = `captured-piece player${capturingPlayer}`; const img = document.createElement('img'); img.src = pieceImageUrl(p.type); img.alt = p.name || p.type; img.title = getString(`animal_${p.type}`) || p.name || p.type; el.appendChild(img); container.appendChild(el); }); }; renderPanel(capturedByPlayer0Container, capturedByPlayer0); renderPanel(capturedByPlayer1Container, capturedByPlayer1); }
+export function addMoveToHistory(pieceData, fromR, fromC, toR, toC, capturedPieceData) { if (!moveListElement) return; const getAlgebraic = (r, c) => `${String.fromCharCode(65 + c)}${BOARD_ROWS - r}`; const startNotation = getAlgebraic(fromR, fromC); const endNotation = getAlgebraic(toR, toC); const pieceImgSrc = pieceImageUrl(pieceData.type); const pieceName = getString(`animal_${pieceData.type}`) || pieceData.name || pieceData.type; const pieceAlt = `${PIECES[pieceData.type]?.symbol || pieceName}`; let moveHtml = `<span class="piece-hist player${pieceData.player}"><img src="${pieceImgSrc}" alt="${pieceAlt}" title="${pieceName}"></span> ${startNotation} → ${endNotation}`; if (capturedPieceData) { const capturedImgSrc = pieceImageUrl(capturedPieceData.type); const capturedName = getString(`animal_${capturedPieceData.type}`) || capturedPieceData.name || capturedPieceData.type; const capturedAlt = `${PIECES[capturedPieceData.type]?.symbol || capturedName}`; moveHtml += ` (x <span class="piece-hist player${capturedPieceData.player}"><img src="${capturedImgSrc}" alt="${capturedAlt}" title="${capturedName}"></span>)`; } const li = document.createElement('li'); li.innerHTML = moveHtml; moveListElement.appendChild(li); moveListElement.scrollTop = moveListElement.scrollHeight; if (undoButton) undoButton.disabled = false;}
 export function clearMoveHistory() { if (moveListElement) moveListElement.innerHTML = ''; if (undoButton) undoButton.disabled = true;}
-export function playSound(soundName) { try { if (!soundName || typeof soundName !== 'string') { console.warn("playSound: Invalid sound name provided:", soundName); return; } const soundPath = `assets/sounds/${soundName.toLowerCase()}.mp3`; const audio = new Audio(soundPath); audio.play().catch(e => console.warn(`Sound playback failed for ${soundPath}:`, e.message || e)); } catch (e) { console.error("Error creating or playing sound:", e); } }
+export function playSound(soundName) { try { if (!soundName || typeof soundName !== 'string') { console.warn("playSound: Invalid sound name provided:", soundName); return; } if (playSoundEffect(soundName.toLowerCase())) return; const soundPath = `assets/sounds/${soundName.toLowerCase()}.mp3`; const audio = new Audio(soundPath); audio.play().catch(e => console.warn(`Sound playback failed for ${soundPath}:`, e.message || e)); } catch (e) { console.error("Error creating or playing sound:", e); } }
 export function updateAiDepthDisplay(depth) { const el = document.getElementById('ai-depth-achieved'); if (el) { el.textContent = depth.toString(); } }
+export function updateAiPlanDisplay(pv) { const el = document.getElementById('ai-plan'); if (!el) return; if (!Array.isArray(pv) || pv.length === 0) { el.textContent = '-'; el.title = ''; return; } const getAlgebraic = (r, c) => `${String.fromCharCode(65 + c)}${BOARD_ROWS - r}`; const steps = pv.map(m => { const type = Object.keys(PIECES).find(t => PIECES[t].name === m.pieceName); const name = (type && getString(`animal_${type}`)) || m.pieceName; return { symbol: type ? PIECES[type].symbol : name, name, squares: `${getAlgebraic(m.fromRow, m.fromCol)}→${getAlgebraic(m.toRow, m.toCol)}` }; }); el.textContent = steps.map(s => `${s.symbol} ${s.squares}`).join('  '); el.title = steps.map(s => `${s.name} ${s.squares}`).join(', '); }
+/** Shows or hides the search statistics overlay on the board. */
+export function showSearchTelemetry(visible) {
+    const el = document.getElementById('search-telemetry');
+    if (el) el.hidden = !visible;
+}
+
+/**
+ * Fills the search statistics overlay.
+ * @param {object|null} summary - searchTelemetry.js summary (eval from the searching side's view), or null to clear it.
+ */
+export function updateSearchTelemetryDisplay(summary) {
+    const el = document.getElementById('search-telemetry-stats');
+    if (!el) return;
+    if (!summary) { el.textContent = '-'; return; }
+    const compact = n => n >= 1e6 ? `${(n / 1e6).toFixed(1)}M` : n >= 1e3 ? `${(n / 1e3).toFixed(0)}k` : `${n}`;
+    const percent = rate => `${(rate * 100).toFixed(1)}%`;
+    const score = summary.eval === null ? '-' : `${summary.eval > 0 ? '+' : ''}${Math.round(summary.eval)}`;
+    el.textContent = [
+        `depth ${summary.depth}  eval ${score}${summary.bookMove ? '  (book)' : ''}${summary.ponderHit ? '  (ponder)' : ''}`,
+        `nodes ${compact(summary.nodes)}  nps ${compact(summary.nps)}  ${(summary.timeMs / 1000).toFixed(2)}s`,
+        `TT hits ${percent(summary.ttHitRate)}  cutoffs ${percent(summary.cutoffRate)}  first move ${percent(summary.firstMoveCutoffRate)}`
+    ].join('\n');
+}
+
 export function updateWinChanceBar(aiEvalScore) {
 	if (!winChanceBarElement || !winChanceBarBlue || !winChanceBarRed) {
 		console.error("Win chance bar elements not found!");
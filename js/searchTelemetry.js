@@ -0,0 +1,93 @@
+// js/searchTelemetry.js
+// Performance log of the AI's searches in this session. game.js feeds it the progress
+// reports the worker sends after completed iterations (aiSearchPool.js onprogress) and
+// the final results; the log can be exported as JSON, so real games can be profiled
+// without devtools. The same summaries feed the debug overlay (renderer.js).
+
+const MAX_LOGGED_SEARCHES = 500; // The oldest searches are dropped beyond this
+
+const roundRate = rate => Math.round((rate || 0) * 10000) / 10000;
+
+/**
+ * Condenses a progress report or final result (decoded aiMessages.js form) into the
+ * statistics shown and logged.
+ * @returns {{ depth: number, timeMs: number, nodes: number, nps: number, eval: number|null,
+ *   ttHitRate: number, cutoffRate: number, firstMoveCutoffRate: number }}
+ */
+export function summarizeSearchReport(report) {
+    const timeMs = report.timeMs || 0;
+    return {
+        depth: report.depthAchieved ?? 0,
+        timeMs: Math.round(timeMs),
+        nodes: report.nodes || 0,
+        nps: timeMs > 0 ? Math.round((report.nodes || 0) / (timeMs / 1000)) : 0,
+        eval: typeof report.eval === 'number' && isFinite(report.eval) ? report.eval : null,
+        ttHitRate: roundRate(report.ttHitRate),
+        cutoffRate: roundRate(report.cutoffRate),
+        firstMoveCutoffRate: roundRate(report.firstMoveCutoffRate)
+    };
+}
+
+export class SearchTelemetry {
+    constructor(maxSearches = MAX_LOGGED_SEARCHES) {
+        this.maxSearches = maxSearches;
+        this.startedAt = new Date().toISOString();
+        this.searches = [];
+        this.current = null; // Entry of the search in progress
+    }
+
+    /**
+     * Opens the entry of a new search (an unfinished previous one stays without result).
+     * @param {object} info - Request details to log: kind, player, ply, targetDepth, timeLimitMs, nodeLimit, threads.
+     */
+    beginSearch(info) {
+        this.current = { time: new Date().toISOString(), ...info, progress: [], result: null };
+        this.searches.push(this.current);
+        if (this.searches.length > this.maxSearches) this.searches.shift();
+    }
+
+    /**
+     * Logs a progress report of the search in progress.
+     * @returns {object} Its summary (summarizeSearchReport).
+     */
+    recordProgress(report) {
+        const summary = summarizeSearchReport(report);
+        this.current?.progress.push(summary);
+        return summary;
+    }
+
+    /**
+     * Closes the search in progress with its result.
+     * @returns {object} The result's summary, with bookMove, ponderHit and error when set.
+     */
+    finishSearch(result) {
+        const summary = summarizeSearchReport(result);
+        if (result.bookMove) summary.bookMove = true;
+        if (result.ponderHit) summary.ponderHit = true;
+        if (result.error) summary.error = result.error;
+        if (this.current) this.current.result = summary;
+        this.current = null;
+        return summary;
+    }
+
+    clear() {
+        this.searches = [];
+        this.current = null;
+    }
+
+    /** The log with the session's context, as exported. */
+    toJSON() {
+        return {
+            startedAt: this.startedAt,
+            exportedAt: new Date().toISOString(),
+            userAgent: typeof navigator !== 'undefined' ? navigator.userAgent : null,
+            hardwareConcurrency: typeof navigator !== 'undefined' ? navigator.hardwareConcurrency ?? null : null,
+            searches: this.searches
+        };
+    }
+
+    /** @returns {string} The log as formatted JSON. */
+    exportJson() {
+        return JSON.stringify(this, null, 2);
+    }
+}
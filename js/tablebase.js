@@ -0,0 +1,294 @@
+// js/tablebase.js
+// Endgame tablebases: exact results of every position with a given set of pieces
+// (a "material"), up to TB_MAX_PIECES pieces, built offline by retrograde analysis
+// (tools/buildTablebases.js) and probed by the search.
+//
+// A table is a flat byte array indexed directly by the position, so a file can be
+// fetched (or memory-mapped) and probed as is:
+//   index = sideToMove * positionsPerSide + sum(slot(piece_i) * stride_i)
+// with the pieces ordered by piece code and slot() numbering the squares that
+// piece can stand on in a running game (no dens; water for rats only).
+//
+// Values, from the view of the side to move:
+//   0            draw (no forced result), or a square clash that cannot occur
+//   1..127       win: the winning move (den entry or last capture) comes at ply n
+//   128 + n      loss: the opponent wins at ply n (n = 0: no legal move)
+// A side without legal moves loses, as it does in the game.
+//
+// Only one colour orientation of each material is stored: the other one is probed
+// through the board's 180-degree rotation with the players swapped.
+//
+// File layout: header, 16 bytes: magic "JTB1", material mask (uint32), piece count
+// (uint8), 7 reserved bytes; then the value bytes.
+// The tables ship packed into one file (TABLEBASE_PACK_URL), which the page fetches
+// once and hands to every search worker (aiSearchPool.js attachTablebases):
+//   header, 16 bytes: magic "JTP1", table count (uint32), 8 reserved bytes;
+//   the byte length of each table file (uint32 each); then the table files.
+
+import { Player, TERRAIN_WATER, TERRAIN_PLAYER0_DEN, TERRAIN_PLAYER1_DEN } from './constants.js';
+import {
+    NUM_SQUARES, NUM_PIECE_CODES, TERRAIN_TABLE, TYPE_RAT, EMPTY, PIECE_TYPES,
+    codeType, codePlayer, makePieceCode
+} from './position.js';
+
+export const TB_MAX_PIECES = 3;
+export const TB_DRAW = 0;
+export const TB_LOSS = 128;
+export const TB_MAX_DISTANCE = 127;
+
+const MAGIC = 0x3142544A; // "JTB1"
+const HEADER_BYTES = 16;
+const PACK_MAGIC = 0x3150544A; // "JTP1"
+const PACK_HEADER_BYTES = 16;
+
+export const TABLEBASE_PACK_FILE = "tables.bin";
+export const TABLEBASE_PACK_URL = new URL(`../assets/tablebase/${TABLEBASE_PACK_FILE}`, import.meta.url);
+
+// --- Square Slots ---
+// SQUARE_SLOTS[code] lists the squares a piece can occupy; SLOT_OF[code * NUM_SQUARES + sq]
+// is the index of sq in that list, or -1.
+export const SQUARE_SLOTS = [];
+export const SLOT_OF = new Int8Array(NUM_PIECE_CODES * NUM_SQUARES).fill(-1);
+for (let code = 0; code < NUM_PIECE_CODES; code++) {
+    const slots = [];
+    if (code !== EMPTY) {
+        for (let sq = 0; sq < NUM_SQUARES; sq++) {
+            const terrain = TERRAIN_TABLE[sq];
+            if (terrain === TERRAIN_PLAYER0_DEN || terrain === TERRAIN_PLAYER1_DEN) continue;
+            if (terrain === TERRAIN_WATER && codeType(code) !== TYPE_RAT) continue;
+            SLOT_OF[code * NUM_SQUARES + sq] = slots.length;
+            slots.push(sq);
+        }
+    }
+    SQUARE_SLOTS.push(Int8Array.from(slots));
+}
+
+// --- Materials ---
+// A material is a bitmask of piece codes (a player has one piece of each type).
+
+/** Square of the rotated board (180 degrees): row r, col c -> 8 - r, 6 - c. */
+export function mirrorSquare(sq) { return NUM_SQUARES - 1 - sq; }
+
+/** The same piece for the other player. */
+export function mirrorCode(code) { return makePieceCode(1 - codePlayer(code), codeType(code)); }
+
+/** The material code list in ascending order. */
+export function materialCodes(mask) {
+    const codes = [];
+    for (let code = 1; code < NUM_PIECE_CODES; code++) {
+        if (mask & (1 << code)) codes.push(code);
+    }
+    return codes;
+}
+
+export function mirrorMaterial(mask) {
+    let mirrored = 0;
+    for (const code of materialCodes(mask)) mirrored |= 1 << mirrorCode(code);
+    return mirrored;
+}
+
+/**
+ * The stored orientation of a material: Player 1 has more pieces, or with equal
+ * counts the larger mask. Its mirror image is probed through the rotation.
+ */
+export function isCanonicalMaterial(mask) {
+    const mirrored = mirrorMaterial(mask);
+    const count = (player) => materialCodes(mask).filter(code => codePlayer(code) === player).length;
+    const p1 = count(Player.PLAYER1);
+    const p0 = count(Player.PLAYER0);
+    return p1 > p0 || (p1 === p0 && mask >= mirrored);
+}
+
+/** File name of a material, e.g. "lion-tiger_vs_rat" (Player 1's pieces first). */
+export function materialName(mask) {
+    const side = (player) => materialCodes(mask).filter(code => codePlayer(code) === player)
+        .map(code => PIECE_TYPES[codeType(code)]).join("-");
+    return `${side(Player.PLAYER1)}_vs_${side(Player.PLAYER0)}`;
+}
+
+// --- Tables ---
+
+export class Tablebase {
+    /**
+     * @param {number} mask - Material.
+     * @param {Uint8Array} [values] - Table contents; a new zeroed table if omitted.
+     */
+    constructor(mask, values = null) {
+        this.mask = mask;
+        this.codes = Int8Array.from(materialCodes(mask));
+        this.strides = new Int32Array(this.codes.length);
+        let size = 1;
+        for (let i = this.codes.length - 1; i >= 0; i--) {
+            this.strides[i] = size;
+            size *= SQUARE_SLOTS[this.codes[i]].length;
+        }
+        this.positionsPerSide = size;
+        this.values = values || new Uint8Array(size * 2);
+        if (this.values.length !== size * 2) throw new Error(`Tablebase ${materialName(mask)} has the wrong size`);
+    }
+
+    /**
+     * Parses a table file. The values are a view into the buffer, which may be shared.
+     * @param {ArrayBuffer|SharedArrayBuffer} buffer
+     * @param {number} [byteOffset] - Start of the file in the buffer.
+     * @param {number} [byteLength] - Length of the file.
+     * @throws {Error} If the data is not a table.
+     */
+    static fromBuffer(buffer, byteOffset = 0, byteLength = buffer.byteLength - byteOffset) {
+        const view = new DataView(buffer, byteOffset, byteLength);
+        if (byteLength < HEADER_BYTES || view.getUint32(0, true) !== MAGIC) throw new Error("Not a tablebase");
+        return new Tablebase(view.getUint32(4, true), new Uint8Array(buffer, byteOffset + HEADER_BYTES, byteLength - HEADER_BYTES));
+    }
+
+    /** Serializes the table into the file format. */
+    toBuffer() {
+        const buffer = new ArrayBuffer(HEADER_BYTES + this.values.length);
+        const view = new DataView(buffer);
+        view.setUint32(0, MAGIC, true);
+        view.setUint32(4, this.mask, true);
+        view.setUint8(8, this.codes.length);
+        new Uint8Array(buffer, HEADER_BYTES).set(this.values);
+        return buffer;
+    }
+
+    /**
+     * Index of a position given by its piece squares (in code order), or -1 if a
+     * piece stands on a square of no slot.
+     */
+    indexOf(squares, sideToMove) {
+        let index = sideToMove * this.positionsPerSide;
+        for (let i = 0; i < this.codes.length; i++) {
+            const slot = SLOT_OF[this.codes[i] * NUM_SQUARES + squares[i]];
+            if (slot < 0) return -1;
+            index += slot * this.strides[i];
+        }
+        return index;
+    }
+
+    /** Inverse of indexOf: writes the piece squares into `squares` and returns the side to move. */
+    decode(index, squares) {
+        const sideToMove = index >= this.positionsPerSide ? 1 : 0;
+        let rest = index - sideToMove * this.positionsPerSide;
+        for (let i = 0; i < this.codes.length; i++) {
+            const slot = (rest / this.strides[i]) | 0;
+            rest -= slot * this.strides[i];
+            squares[i] = SQUARE_SLOTS[this.codes[i]][slot];
+        }
+        return sideToMove;
+    }
+}
+
+// --- Probing ---
+
+const loadedTables = new Map(); // Material mask -> Tablebase (canonical orientation)
+const probeSquares = new Int8Array(TB_MAX_PIECES);
+let maxLoadedPieces = 0;
+
+/** Makes a table available to probeTablebase. */
+export function registerTablebase(table) {
+    loadedTables.set(table.mask, table);
+    maxLoadedPieces = Math.max(maxLoadedPieces, table.codes.length);
+}
+
+/** Piece count up to which positions may be in a loaded table (0 if none are loaded). */
+export function tablebasePieceLimit() {
+    return maxLoadedPieces;
+}
+
+/**
+ * Looks a position up.
+ * @param {Position} pos - A running game position (not decided yet).
+ * @returns {number} The table value (see above), or -1 if no table covers it.
+ */
+export function probeTablebase(pos) {
+    const p0 = pos.pieceCount[Player.PLAYER0];
+    const p1 = pos.pieceCount[Player.PLAYER1];
+    if (p0 + p1 > maxLoadedPieces) return -1;
+
+    let mask = 0;
+    for (let player = 0; player < 2; player++) {
+        for (let i = 0; i < pos.pieceCount[player]; i++) mask |= 1 << pos.squares[pos.pieceSquare(player, i)];
+    }
+    let table = loadedTables.get(mask);
+    const mirrored = !table;
+    if (mirrored) {
+        table = loadedTables.get(mirrorMaterial(mask));
+        if (!table) return -1;
+    }
+
+    // Piece squares in the table's code order
+    const codes = table.codes;
+    for (let i = 0; i < codes.length; i++) {
+        const code = mirrored ? mirrorCode(codes[i]) : codes[i];
+        const player = codePlayer(code);
+        for (let j = 0; j < pos.pieceCount[player]; j++) {
+            const sq = pos.pieceSquare(player, j);
+            if (pos.squares[sq] === code) {
+                probeSquares[i] = mirrored ? mirrorSquare(sq) : sq;
+                break;
+            }
+        }
+    }
+    const index = table.indexOf(probeSquares, mirrored ? 1 - pos.sideToMove : pos.sideToMove);
+    return index < 0 ? -1 : table.values[index];
+}
+
+/**
+ * Packs table files into the pack format (see the top of the file).
+ * @param {Array<Tablebase>} tables
+ * @returns {ArrayBuffer}
+ */
+export function packTablebases(tables) {
+    const files = tables.map(table => new Uint8Array(table.toBuffer()));
+    const dataStart = PACK_HEADER_BYTES + files.length * 4;
+    const buffer = new ArrayBuffer(dataStart + files.reduce((sum, file) => sum + file.length, 0));
+    const view = new DataView(buffer);
+    view.setUint32(0, PACK_MAGIC, true);
+    view.setUint32(4, files.length, true);
+    let offset = dataStart;
+    files.forEach((file, i) => {
+        view.setUint32(PACK_HEADER_BYTES + i * 4, file.length, true);
+        new Uint8Array(buffer, offset).set(file);
+        offset += file.length;
+    });
+    return buffer;
+}
+
+/**
+ * Registers the tables of a pack; they stay views into the buffer, so a shared one
+ * is probed by every worker without copies.
+ * @param {ArrayBuffer|SharedArrayBuffer} buffer
+ * @returns {number} Number of tables registered.
+ * @throws {Error} If the data is not a pack.
+ */
+export function registerTablebasePack(buffer) {
+    const view = new DataView(buffer);
+    if (buffer.byteLength < PACK_HEADER_BYTES || view.getUint32(0, true) !== PACK_MAGIC) throw new Error("Not a tablebase pack");
+    const count = view.getUint32(4, true);
+    let offset = PACK_HEADER_BYTES + count * 4;
+    for (let i = 0; i < count; i++) {
+        const length = view.getUint32(PACK_HEADER_BYTES + i * 4, true);
+        if (offset + length > buffer.byteLength) throw new Error("Tablebase pack truncated");
+        registerTablebase(Tablebase.fromBuffer(buffer, offset, length));
+        offset += length;
+    }
+    return count;
+}
+
+/**
+ * Fetches the table pack (on the main thread; the workers get it from the pool).
+ * @param {URL|string} url - Location of the pack.
+ * @returns {Promise<ArrayBuffer|null>} Its contents, or null (with a log line) if it cannot be loaded.
+ */
+export async function fetchTablebasePack(url) {
+    try {
+        const response = await fetch(url);
+        if (!response.ok) throw new Error(`HTTP ${response.status}`);
+        const buffer = await response.arrayBuffer();
+        console.log(`[Tablebase] Fetched the endgame tables (${buffer.byteLength} bytes).`);
+        return buffer;
+    } catch (e) {
+        console.log(`[Tablebase] No endgame tables (${e.message}).`);
+        return null;
+    }
+}
@@ -0,0 +1,87 @@
+// js/timeManager.js
+// Time management for the iterative deepening of aiSearch.js. The time limit of a
+// request stays the hard limit (the search is aborted there), but the search usually
+// stops sooner at a soft limit that follows how settled the position looks: a best
+// move that holds over several iterations (or is the only legal one) stops it early,
+// a falling score or a changed best move gives it more time. An iteration is not
+// started when it cannot finish before the hard limit, since an aborted iteration is
+// thrown away.
+
+// Soft limit of a position without history, as a share of the hard limit
+const OPTIMUM_SHARE = 0.5;
+// Iterations this shallow are too noisy (and too quick) to judge stability from
+const MIN_JUDGED_DEPTH = 4;
+// Every iteration with the same best move shrinks the soft limit by this share, down to MIN_STABILITY_FACTOR
+const STABILITY_STEP = 0.1;
+const MIN_STABILITY_FACTOR = 0.5;
+// A new best move restarts the stability count and extends the soft limit
+const BEST_MOVE_CHANGE_FACTOR = 1.5;
+// A score falling by more than SCORE_DROP_MARGIN extends the soft limit, up to twice
+// for a drop of SCORE_DROP_MARGIN + SCORE_DROP_RANGE or more
+const SCORE_DROP_MARGIN = 25;
+const SCORE_DROP_RANGE = 200;
+// Time of the next iteration relative to the last one (its growth over the one before, within these bounds)
+const MIN_ITERATION_GROWTH = 1.5;
+const MAX_ITERATION_GROWTH = 4;
+
+export class TimeManager {
+    /**
+     * @param {number} hardLimitMs - Time from the start of the search at which it is aborted.
+     * @param {number} legalMoveCount - Moves at the root.
+     */
+    constructor(hardLimitMs, legalMoveCount) {
+        this.hardLimitMs = hardLimitMs;
+        this.softLimitMs = hardLimitMs * OPTIMUM_SHARE;
+        this.onlyMove = legalMoveCount === 1;
+        this.stableIterations = 0;
+        this.bestMove = null; // Encoded best move of the last iteration
+        this.score = null;
+        this.elapsedMs = 0; // At the end of the last iteration
+        this.lastIterationMs = 0;
+        this.previousIterationMs = 0;
+        this.stopReason = null; // Why shouldStartIteration last said no
+    }
+
+    /**
+     * Takes in a completed iteration and recomputes the soft limit.
+     * @param {number} elapsedMs - Time since the start of the search.
+     * @param {number} depth - Depth of the iteration.
+     * @param {number} bestMove - Its best move (encoded).
+     * @param {number} score - Its score, for the side to move.
+     */
+    recordIteration(elapsedMs, depth, bestMove, score) {
+        this.previousIterationMs = this.lastIterationMs;
+        this.lastIterationMs = elapsedMs - this.elapsedMs;
+        this.elapsedMs = elapsedMs;
+        const moveChanged = this.bestMove !== null && bestMove !== this.bestMove;
+        const scoreDrop = this.score === null ? 0 : this.score - score;
+        this.bestMove = bestMove;
+        this.score = score;
+        if (depth < MIN_JUDGED_DEPTH) return;
+
+        this.stableIterations = moveChanged ? 0 : this.stableIterations + 1;
+        let factor = Math.max(MIN_STABILITY_FACTOR, 1 - STABILITY_STEP * this.stableIterations);
+        if (moveChanged) factor *= BEST_MOVE_CHANGE_FACTOR;
+        if (scoreDrop > SCORE_DROP_MARGIN) factor *= 1 + Math.min(1, (scoreDrop - SCORE_DROP_MARGIN) / SCORE_DROP_RANGE);
+        this.softLimitMs = Math.min(this.hardLimitMs, this.hardLimitMs * OPTIMUM_SHARE * factor);
+    }
+
+    /** Expected time of the next iteration, from the growth of the last two. */
+    predictNextIterationMs() {
+        const growth = this.previousIterationMs > 0 ? this.lastIterationMs / this.previousIterationMs : MAX_ITERATION_GROWTH;
+        return this.lastIterationMs * Math.min(MAX_ITERATION_GROWTH, Math.max(MIN_ITERATION_GROWTH, growth));
+    }
+
+    /**
+     * Whether another iteration is worth starting (call after recordIteration).
+     * @param {number} elapsedMs - Time since the start of the search.
+     * @returns {boolean} False when the search should return its result now (see stopReason).
+     */
+    shouldStartIteration(elapsedMs) {
+        if (this.onlyMove) this.stopReason = "only move";
+        else if (elapsedMs >= this.softLimitMs) this.stopReason = `soft limit ${this.softLimitMs.toFixed(0)}ms`;
+        else if (elapsedMs + this.predictNextIterationMs() > this.hardLimitMs) this.stopReason = "next iteration would not finish";
+        else this.stopReason = null;
+        return this.stopReason === null;
+    }
+}
@@ -0,0 +1,204 @@
+// js/transpositionTable.js
+// Fixed-size transposition table for the AI search, stored in one preallocated
+// Int32Array so probing and storing never allocate. The array may live in a
+// SharedArrayBuffer, letting several search workers share one table (Lazy SMP).
+//
+// The table is split into buckets of two slots, indexed by the low bits of the
+// Zobrist key:
+//   slot 0 - depth-preferred: only replaced by a deeper (or equally deep) result,
+//            or when its entry is from an older search (generation aging).
+//   slot 1 - always-replace: takes every result that is not good enough for slot 0.
+//
+// Each slot is four int32 words: [keyLo ^ data0, keyHi ^ data1, data0, data1].
+// Workers write without locks; a slot torn by two concurrent writers no longer
+// matches its key after the XOR and is simply treated as a miss.
+
+import { NO_MOVE } from './position.js';
+
+// Entry flags (0 marks an empty slot)
+export const TT_EMPTY = 0;
+export const TT_EXACT = 1;
+export const TT_LOWERBOUND = 2;
+export const TT_UPPERBOUND = 3;
+
+export const DEFAULT_TT_SIZE_MB = 16;
+export const MIN_TT_SIZE_MB = 1;
+export const MAX_TT_SIZE_MB = 512;
+
+const SLOTS_PER_BUCKET = 2;
+const WORDS_PER_SLOT = 4;
+const BYTES_PER_BUCKET = SLOTS_PER_BUCKET * WORDS_PER_SLOT * Int32Array.BYTES_PER_ELEMENT;
+const GENERATION_MASK = 0xFF;
+const MAX_STORED_SCORE = 32767;   // Scores are packed into 16 bits
+const FILL_SAMPLE_BUCKETS = 1000; // Buckets inspected when estimating the fill level
+
+// data0: score (16 bits, signed) | move (12 bits) << 16 | flag (2 bits) << 28
+// data1: depth (8 bits, signed) | generation (8 bits) << 8
+function packData0(score, move, flag) { return (score & 0xFFFF) | (move << 16) | (flag << 28); }
+function packData1(depth, age) { return (depth & 0xFF) | (age << 8); }
+function data0Score(d0) { return (d0 << 16) >> 16; }
+function data0Move(d0) { return (d0 >>> 16) & 0xFFF; }
+function data0Flag(d0) { return (d0 >>> 28) & 0x3; }
+function data1Depth(d1) { return (d1 << 24) >> 24; }
+function data1Age(d1) { return (d1 >>> 8) & GENERATION_MASK; }
+
+/** Clamps a requested table size to the supported range of whole megabytes. */
+export function normalizeTableSizeMb(sizeMb) {
+    return Math.min(MAX_TT_SIZE_MB, Math.max(MIN_TT_SIZE_MB, sizeMb | 0));
+}
+
+/** Largest power of two not above n (n >= 1). */
+function floorPowerOfTwo(n) {
+    let p = 1;
+    while (p * 2 <= n) p *= 2;
+    return p;
+}
+
+/** Byte size of the table for a memory budget (a power-of-two number of buckets). */
+function tableByteLength(sizeMb) {
+    return floorPowerOfTwo(Math.floor(normalizeTableSizeMb(sizeMb) * 1024 * 1024 / BYTES_PER_BUCKET)) * BYTES_PER_BUCKET;
+}
+
+export class TranspositionTable {
+    /**
+     * @param {number} sizeMb - Memory budget in megabytes (clamped to MIN/MAX_TT_SIZE_MB).
+     * @param {SharedArrayBuffer} [sharedBuffer] - Existing storage to use instead of allocating,
+     *   as created by TranspositionTable.createSharedBuffer for the same size.
+     */
+    constructor(sizeMb = DEFAULT_TT_SIZE_MB, sharedBuffer = null) {
+        this.generation = 0;
+        this.probes = 0;
+        this.hits = 0;
+        // Decoded fields of the entry found by the last successful probe()
+        this.hitScore = 0;
+        this.hitMove = NO_MOVE;
+        this.hitDepth = 0;
+        this.hitFlag = TT_EMPTY;
+        if (sharedBuffer) {
+            this.attach(sizeMb, sharedBuffer);
+        } else {
+            this.resize(sizeMb);
+        }
+    }
+
+    /** Allocates zeroed shared storage for a table of the given size. */
+    static createSharedBuffer(sizeMb) {
+        return new SharedArrayBuffer(tableByteLength(sizeMb));
+    }
+
+    /** Reallocates private storage for a new memory budget, dropping every entry. */
+    resize(sizeMb) {
+        this.attach(sizeMb, new ArrayBuffer(tableByteLength(sizeMb)));
+    }
+
+    /** Uses existing storage (private or shared); its entries are kept. */
+    attach(sizeMb, buffer) {
+        this.sizeMb = normalizeTableSizeMb(sizeMb);
+        this.buffer = buffer;
+        this.data = new Int32Array(buffer);
+        this.bucketMask = buffer.byteLength / BYTES_PER_BUCKET - 1;
+        this.resetStats();
+    }
+
+    /** Empties the table (e.g. for a new game) without reallocating. */
+    clear() {
+        this.data.fill(0);
+        this.generation = 0;
+        this.resetStats();
+    }
+
+    /** Starts a new search: entries from earlier searches become replaceable. */
+    newSearch() {
+        this.setGeneration(this.generation + 1);
+    }
+
+    /** Starts a search with an explicit generation (shared tables: all workers use the same one). */
+    setGeneration(generation) {
+        this.generation = generation & GENERATION_MASK;
+        this.resetStats();
+    }
+
+    resetStats() {
+        this.probes = 0;
+        this.hits = 0;
+    }
+
+    /**
+     * Looks up a position. On a hit the entry is copied into hitScore, hitMove,
+     * hitDepth and hitFlag (read them before the next probe).
+     * @returns {boolean} True if an entry for the key was found.
+     */
+    probe(lo, hi) {
+        this.probes++;
+        const data = this.data;
+        const base = (lo & this.bucketMask) * SLOTS_PER_BUCKET * WORDS_PER_SLOT;
+        for (let w = base; w < base + SLOTS_PER_BUCKET * WORDS_PER_SLOT; w += WORDS_PER_SLOT) {
+            const d0 = data[w + 2];
+            const d1 = data[w + 3];
+            if (data0Flag(d0) !== TT_EMPTY && (data[w] ^ d0) === lo && (data[w + 1] ^ d1) === hi) {
+                this.hits++;
+                this.hitScore = data0Score(d0);
+                this.hitMove = data0Move(d0);
+                this.hitDepth = data1Depth(d1);
+                this.hitFlag = data0Flag(d0);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Stores a search result for a position.
+     * @param {number} lo - Low half of the Zobrist key.
+     * @param {number} hi - High half of the Zobrist key.
+     * @param {number} depth - Remaining depth the score was searched to.
+     * @param {number} flag - TT_EXACT, TT_LOWERBOUND or TT_UPPERBOUND.
+     * @param {number} score - Integer score.
+     * @param {number} move - Best move found (NO_MOVE keeps a previously stored move).
+     */
+    store(lo, hi, depth, flag, score, move) {
+        const data = this.data;
+        const base = (lo & this.bucketMask) * SLOTS_PER_BUCKET * WORDS_PER_SLOT;
+        const p0 = data[base + 2];
+        const p1 = data[base + 3];
+        const preferredEmpty = data0Flag(p0) === TT_EMPTY;
+        const sameKey = !preferredEmpty && (data[base] ^ p0) === lo && (data[base + 1] ^ p1) === hi;
+
+        // Always-replace slot unless the depth-preferred one qualifies
+        let w = base + WORDS_PER_SLOT;
+        if (sameKey || preferredEmpty || data1Age(p1) !== this.generation || depth >= data1Depth(p1)) {
+            w = base;
+        }
+
+        if (move === NO_MOVE) {
+            const d0 = data[w + 2];
+            if (data0Flag(d0) !== TT_EMPTY && (data[w] ^ d0) === lo && (data[w + 1] ^ data[w + 3]) === hi) {
+                move = data0Move(d0); // Keep the known best move for ordering
+            }
+        }
+
+        const clamped = Math.max(-MAX_STORED_SCORE, Math.min(MAX_STORED_SCORE, score));
+        const d0 = packData0(clamped, move, flag);
+        const d1 = packData1(depth, this.generation);
+        data[w] = lo ^ d0;
+        data[w + 1] = hi ^ d1;
+        data[w + 2] = d0;
+        data[w + 3] = d1;
+    }
+
+    /** Fraction of probes in the current search that found an entry (0..1). */
+    hitRate() {
+        return this.probes > 0 ? this.hits / this.probes : 0;
+    }
+
+    /** Estimated fraction of slots holding an entry from the current search (0..1). */
+    fillLevel() {
+        const sampleSlots = Math.min(FILL_SAMPLE_BUCKETS, this.bucketMask + 1) * SLOTS_PER_BUCKET;
+        let used = 0;
+        for (let slot = 0; slot < sampleSlots; slot++) {
+            const w = slot * WORDS_PER_SLOT;
+            if (data0Flag(this.data[w + 2]) !== TT_EMPTY && data1Age(this.data[w + 3]) === this.generation) used++;
+        }
+        return used / sampleSlots;
+    }
+}
@@ -0,0 +1,154 @@
+// js/wasmEvaluate.js
+// Optional WebAssembly evaluator for the search, with the same interface and the same
+// scores as IncrementalEvaluator (aiEvaluate.js). The threat terms, the costly part of
+// the evaluation, are computed by a SIMD kernel over packed bitboards: one 63-bit
+// board per piece type and player, with both players side by side in one v128 lane
+// pair, so a shift and a popcount handle every attacker/target pair of a direction
+// at once for both sides. The per-piece terms stay incremental, as in
+// IncrementalEvaluator; the bitboards are patched from JS on every make/unmake.
+// The module (assets/wasm/evaluate.wasm) is generated by tools/buildWasmEval.js.
+
+import { Player, GameStatus } from './constants.js';
+import { NUM_SQUARES, MAX_GAME_PLY, CODE_VALUE, EMPTY, codeType, codePlayer, makePieceCode } from './position.js';
+import { getPositionStatus } from './moveGen.js';
+import { getCompiledEvalTables, ratElephantScore, roundScore, WIN_SCORE, LOSE_SCORE } from './aiEvaluate.js';
+
+export const WASM_EVALUATOR_URL = new URL('../assets/wasm/evaluate.wasm', import.meta.url);
+
+// --- Memory Layout (shared with tools/buildWasmEval.js) ---
+// Bitboards at WASM_BITBOARD_OFFSET: type t at t * 16, Player 0's board in the low
+// 8 bytes and Player 1's in the high 8 (bit = square index). The piece values the
+// kernel was generated for follow at WASM_VALUE_OFFSET, as int32 per type.
+export const WASM_BITBOARD_OFFSET = 0;
+export const WASM_VALUE_OFFSET = 128;
+export const WASM_PIECE_TYPES = 8;
+
+export class WasmEvaluator {
+    /** @param {WebAssembly.Instance} instance - An instance of the generated module. */
+    constructor(instance) {
+        const { memory, threats } = instance.exports;
+        this.threats = threats; // threats(captureFactor, adjacentFactor, jumpFactor): signed, Player 1's view
+        // 32-bit words of the bitboards: [type * 4 + player * 2 + (sq >> 5)], bit sq & 31
+        this.bitboards = new Int32Array(memory.buffer, WASM_BITBOARD_OFFSET, WASM_PIECE_TYPES * 4);
+        const values = new Int32Array(memory.buffer, WASM_VALUE_OFFSET, WASM_PIECE_TYPES);
+        for (let type = 0; type < WASM_PIECE_TYPES; type++) {
+            if (values[type] !== CODE_VALUE[makePieceCode(Player.PLAYER0, type)]) {
+                throw new Error("evaluate.wasm was generated for other piece values");
+            }
+        }
+        this.tables = getCompiledEvalTables();
+        this.pieceSquareTotal = 0; // Sum of signed per-piece terms
+        this.pieceSquareStack = new Float64Array(MAX_GAME_PLY);
+    }
+
+    /** Flips the bit of a piece code on a square. */
+    toggle(code, sq) {
+        this.bitboards[(codeType(code) << 2) | (codePlayer(code) << 1) | (sq >> 5)] ^= 1 << (sq & 31);
+    }
+
+    /** Loads a position (call before searching it). Also takes up changed evaluation parameters. */
+    reset(pos) {
+        this.tables = getCompiledEvalTables();
+        const table = this.tables.signedPieceSquareTable;
+        this.bitboards.fill(0);
+        let pieceSquareTotal = 0;
+        for (let sq = 0; sq < NUM_SQUARES; sq++) {
+            const code = pos.squares[sq];
+            if (code === EMPTY) continue;
+            this.toggle(code, sq);
+            pieceSquareTotal += table[code * NUM_SQUARES + sq];
+        }
+        this.pieceSquareTotal = pieceSquareTotal;
+    }
+
+    /** Plays a move on pos (pos.makeMove) and updates the bitboards. */
+    makeMove(pos, move) {
+        const squares = pos.squares;
+        const table = this.tables.signedPieceSquareTable;
+        const from = move & 63;
+        const to = (move >> 6) & 63;
+        const code = squares[from];
+        const captured = squares[to];
+        this.pieceSquareStack[pos.ply] = this.pieceSquareTotal;
+        this.pieceSquareTotal += table[code * NUM_SQUARES + to] - table[code * NUM_SQUARES + from];
+        if (captured !== EMPTY) {
+            this.pieceSquareTotal -= table[captured * NUM_SQUARES + to];
+            this.toggle(captured, to);
+        }
+        this.toggle(code, from);
+        this.toggle(code, to);
+        pos.makeMove(move);
+    }
+
+    /** Takes back a move (pos.unmakeMove) and restores the bitboards. */
+    unmakeMove(pos, move) {
+        pos.unmakeMove(move);
+        const from = move & 63;
+        const to = (move >> 6) & 63;
+        const code = pos.squares[from];
+        const captured = pos.squares[to];
+        this.toggle(code, from);
+        this.toggle(code, to);
+        if (captured !== EMPTY) this.toggle(captured, to);
+        this.pieceSquareTotal = this.pieceSquareStack[pos.ply];
+    }
+
+    /** Passes the turn (pos.makeNullMove); the pieces do not change. */
+    makeNullMove(pos) {
+        this.pieceSquareStack[pos.ply] = this.pieceSquareTotal;
+        pos.makeNullMove();
+    }
+
+    /** Takes back a null move (pos.unmakeNullMove). */
+    unmakeNullMove(pos) {
+        pos.unmakeNullMove();
+    }
+
+    /**
+    * Evaluates pos from the view of its side to move; same result as evaluatePosition(pos)
+    * provided every move since reset() went through makeMove/unmakeMove.
+    * @returns {number} The evaluation score, rounded to an integer.
+    */
+    evaluate(pos) {
+        const status = getPositionStatus(pos);
+        if (status === GameStatus.DRAW) return 0;
+        if (status !== GameStatus.ONGOING) {
+            const winner = status === GameStatus.PLAYER1_WINS ? Player.PLAYER1 : Player.PLAYER0;
+            return winner === pos.sideToMove ? WIN_SCORE : LOSE_SCORE;
+        }
+        const { threatCaptureFactor, threatAdjacentFactor, jumpThreatFactor } = this.tables;
+        const threat = this.threats(threatCaptureFactor, threatAdjacentFactor, jumpThreatFactor);
+        const score = roundScore(this.pieceSquareTotal + threat + ratElephantScore(pos));
+        return pos.sideToMove === Player.PLAYER1 ? score : -score;
+    }
+}
+
+/**
+ * Compiles the generated module. Fails where WebAssembly or its SIMD extension is missing.
+ * @param {BufferSource} bytes - Contents of evaluate.wasm.
+ * @returns {Promise<WasmEvaluator>}
+ */
+export async function createWasmEvaluator(bytes) {
+    if (typeof WebAssembly === 'undefined') throw new Error("no WebAssembly");
+    if (!WebAssembly.validate(bytes)) throw new Error("no WebAssembly SIMD");
+    const { instance } = await WebAssembly.instantiate(bytes);
+    return new WasmEvaluator(instance);
+}
+
+/**
+ * Fetches and compiles the WebAssembly evaluator.
+ * @param {URL|string} url - Location of evaluate.wasm.
+ * @returns {Promise<WasmEvaluator|null>} The evaluator, or null to keep the JavaScript one.
+ */
+export async function loadWasmEvaluator(url) {
+    try {
+        const response = await fetch(url);
+        if (!response.ok) throw new Error(`HTTP ${response.status}`);
+        const evaluator = await createWasmEvaluator(await response.arrayBuffer());
+        console.log("[Eval] WebAssembly evaluator loaded.");
+        return evaluator;
+    } catch (e) {
+        console.log(`[Eval] JavaScript evaluator (${e.message}).`);
+        return null;
+    }
+}
@@ -2,98 +2,95 @@
 import { BOARD_ROWS, BOARD_COLS, Player, PIECES } from './constants.js';
 
 // --- Zobrist Hashing ---
-export const zobristTable = [];        // Stores random keys for each piece/player/square
-export let zobristBlackToMove;         // Random key for whose turn it is (Player 1's turn)
-export const pieceNameToIndex = {};    // Maps piece name ('rat') to index for zobristTable
-let pieceIndexCounter = 0;      // Counter for assigning piece indices
+// Each key is 64 bits held as two 32-bit halves in typed arrays, so hashing is plain
+// int32 XOR work (no BigInt). Keys come from a fixed-seed PRNG and are therefore
+// identical across sessions, page reloads and every worker.
+export const ZOBRIST_SEED = 0x4A554E47;  // Fixed PRNG seed ("JUNG")
+export const pieceNameToIndex = {};      // Maps piece name ('rat') to piece index (0..7)
+const PIECE_KINDS = Object.keys(PIECES).length;
+const SQUARE_COUNT = BOARD_ROWS * BOARD_COLS;
+const KEY_COUNT = PIECE_KINDS * 2 * SQUARE_COUNT;
 
-/** Generates a random 64-bit BigInt for Zobrist keys. */
-function randomBigInt() {
-    // Simple pseudo-random BigInt generator (not cryptographically secure)
-    // Using Math.random() limits precision but is sufficient for hashing purposes here.
-    const low = BigInt(Math.floor(Math.random() * (2**32)));
-    const high = BigInt(Math.floor(Math.random() * (2**32)));
-    return (high << 32n) | low;
+export const zobristKeysLo = new Int32Array(KEY_COUNT); // Low halves, see zobristKeyIndex
+export const zobristKeysHi = new Int32Array(KEY_COUNT); // High halves
+export let zobristSideLo = 0;            // Key for "Player 1 to move" (low half)
+export let zobristSideHi = 0;            // Key for "Player 1 to move" (high half)
+let zobristInitialized = false;
+
+/** Index of the key for a piece index / player / square in zobristKeysLo and zobristKeysHi. */
+export function zobristKeyIndex(pieceIndex, player, r, c) {
+    return ((pieceIndex * 2 + player) * BOARD_ROWS + r) * BOARD_COLS + c;
 }
 
+/** Creates the deterministic 32-bit PRNG (mulberry32) used to fill the key tables. */
+function createKeyGenerator(seed) {
+    let state = seed | 0;
+    return function next32() {
+        state = (state + 0x6D2B79F5) | 0;
+        let t = Math.imul(state ^ (state >>> 15), 1 | state);
+        t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+        return (t ^ (t >>> 14)) | 0;
+    };
+}
+
+/**
+ * Folds a 64-bit key given as two 32-bit halves into one 53-bit safe integer.
+ * Used wherever a key must be a single JS number (Map keys, game history).
+ */
+export function combineHashHalves(lo, hi) {
+    return (hi >>> 11) * 4294967296 + (lo >>> 0);
+}
 
 /** Initializes the Zobrist hashing keys. */
 export function initializeZobrist() {
-    // Only initialize if the table is empty to prevent re-randomizing keys mid-game
-    if (zobristTable.length > 0) return;
-
-    console.log("Initializing Zobrist Keys...");
-    pieceIndexCounter = 0;
-    // Clear pieceNameToIndex in case of re-initialization attempt
-    Object.keys(pieceNameToIndex).forEach(key => delete pieceNameToIndex[key]);
+    // The keys are deterministic, but there is still no need to build them twice
+    if (zobristInitialized) return;
 
+    const next32 = createKeyGenerator(ZOBRIST_SEED);
+    let pieceIndexCounter = 0;
     for (const pieceKey in PIECES) {
-        const nameLower = pieceKey.toLowerCase();
-        if (!pieceNameToIndex.hasOwnProperty(nameLower)) {
-            pieceNameToIndex[nameLower] = pieceIndexCounter++;
-            zobristTable[pieceNameToIndex[nameLower]] = [];
-        }
-        const index = pieceNameToIndex[nameLower];
-        zobristTable[index][Player.PLAYER0] = [];
-        zobristTable[index][Player.PLAYER1] = [];
-        for (let r = 0; r < BOARD_ROWS; r++) {
-            zobristTable[index][Player.PLAYER0][r] = [];
-            zobristTable[index][Player.PLAYER1][r] = [];
-            for (let c = 0; c < BOARD_COLS; c++) {
-                zobristTable[index][Player.PLAYER0][r][c] = randomBigInt();
-                zobristTable[index][Player.PLAYER1][r][c] = randomBigInt();
-            }
-        }
+        pieceNameToIndex[pieceKey.toLowerCase()] = pieceIndexCounter++;
+    }
+    for (let i = 0; i < KEY_COUNT; i++) {
+        zobristKeysLo[i] = next32();
+        zobristKeysHi[i] = next32();
     }
-    zobristBlackToMove = randomBigInt();
-    console.log(`Zobrist Keys Initialized. Piece Count: ${pieceIndexCounter}`);
+    zobristSideLo = next32();
+    zobristSideHi = next32();
+    zobristInitialized = true;
 }
 
 /**
  * Computes the Zobrist hash key for a given board state and player to move.
  * @param {Array<Array<object>>} currentBoard - The board state.
  * @param {number} playerToMove - The player whose turn it is (PLAYER0 or PLAYER1).
- * @returns {bigint} The Zobrist hash key.
+ * @returns {number} The Zobrist key folded into a 53-bit safe integer.
  */
 export function computeZobristKey(currentBoard, playerToMove) {
-    let key = 0n; // Use BigInt for the key
-
-    if (zobristTable.length === 0) {
-        console.warn("[Zobrist] computeZobristKey called before initialization. Initializing now.");
-        initializeZobrist(); // Attempt to initialize if called too early
-        if (zobristTable.length === 0) {
-             console.error("[Zobrist] Initialization failed. Cannot compute key.");
-             return 0n; // Return a default key on failure
-        }
-    }
-
+    initializeZobrist();
+    let lo = 0;
+    let hi = 0;
 
     for (let r = 0; r < BOARD_ROWS; r++) {
         for (let c = 0; c < BOARD_COLS; c++) {
-            const square = currentBoard[r]?.[c];
-            const piece = square?.piece; // Safe access
+            const piece = currentBoard[r]?.[c]?.piece; // Safe access
+            if (!piece || !piece.type) continue;
 
-            if (piece && piece.type) { // Use piece.type (lowercase key)
-                const pieceNameLower = piece.type; // Already lowercase key
-                const pieceIndex = pieceNameToIndex[pieceNameLower];
-
-                if (pieceIndex !== undefined &&
-                    (piece.player === Player.PLAYER0 || piece.player === Player.PLAYER1) &&
-                    r >= 0 && r < BOARD_ROWS &&
-                    c >= 0 && c < BOARD_COLS &&
-                    zobristTable[pieceIndex]?.[piece.player]?.[r]?.[c])
-                {
-                    key ^= zobristTable[pieceIndex][piece.player][r][c]; // XOR with the piece's key
-                } else {
-                     console.warn(`[Zobrist Compute] Skipped invalid piece data or missing Zobrist entry`, { type: piece.type, player: piece.player, r: r, c: c, pI: pieceIndex });
-                }
+            const pieceIndex = pieceNameToIndex[piece.type]; // piece.type is the lowercase key
+            if (pieceIndex !== undefined && (piece.player === Player.PLAYER0 || piece.player === Player.PLAYER1)) {
+                const index = zobristKeyIndex(pieceIndex, piece.player, r, c);
+                lo ^= zobristKeysLo[index];
+                hi ^= zobristKeysHi[index];
+            } else {
+                console.warn(`[Zobrist Compute] Skipped invalid piece data`, { type: piece.type, player: piece.player, r: r, c: c });
             }
         }
     }
 
     // XOR with the turn key if it's Player 1's turn
     if (playerToMove === Player.PLAYER1) {
-        key ^= zobristBlackToMove;
+        lo ^= zobristSideLo;
+        hi ^= zobristSideHi;
     }
-    return key;
-}
\ No newline at end of file
+    return combineHashHalves(lo, hi);
+}
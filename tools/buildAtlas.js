@@ -0,0 +1,282 @@
+// tools/buildAtlas.js
+// Packs the board's small images into one sprite atlas, loaded by js/assetLoader.js:
+//   node tools/buildAtlas.js [--out assets/atlas] [--head-size 128]
+//
+// The piece heads (1024px sources, shown at 60px or less) are downscaled to
+// --head-size; the decorations keep their size. Writes sprites.png and sprites.json,
+// which maps each source path (relative to assets/, as in constants.js) to its
+// rectangle in the atlas. Only 8-bit PNG sources are read (any color type, palettes of
+// 1 to 8 bits, tRNS transparency); there is no image library, so PNG is decoded and
+// encoded here with zlib. Regenerate after changing any of the source images.
+// The animated GIF terrain and the tileset stay separate files.
+
+import { readFileSync, writeFileSync, mkdirSync } from 'node:fs';
+import { join } from 'node:path';
+import { inflateSync, deflateSync, crc32 } from 'node:zlib';
+import { PIECES } from '../js/constants.js';
+
+const ASSETS_DIR = "assets";
+const DEFAULT_OUT = "assets/atlas";
+const DEFAULT_HEAD_SIZE = 128;
+const HEADS_PER_SHELF = 4; // Sets the atlas width
+const PADDING = 2; // Transparent pixels around each sprite, against bleeding when scaled
+
+// Sources, relative to assets/; heads are downscaled
+const HEAD_SPRITES = Object.keys(PIECES).map(type => `images/head_no_background/${type}.png`);
+const DECORATION_SPRITES = [
+    "decorations/decorations_1.png",
+    "decorations/decorations_2.png",
+    "decorations/decorations_3.png",
+    "decorations/decorations_4.png",
+    "decorations/chest.png",
+    "decorations/ladder.png",
+];
+
+function parseArgs(argv) {
+    const args = {};
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        if (!arg.startsWith("--")) throw new Error(`Unexpected argument: ${arg}`);
+        const value = argv[i + 1];
+        if (value === undefined || value.startsWith("--")) throw new Error(`Missing value for ${arg}`);
+        args[arg.slice(2)] = value;
+        i++;
+    }
+    return args;
+}
+
+// --- PNG Decoding ---
+
+const PNG_SIGNATURE = Buffer.from([0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a]);
+const CHANNELS = { 0: 1, 2: 3, 3: 1, 4: 2, 6: 4 }; // Per color type
+
+function paeth(a, b, c) {
+    const p = a + b - c;
+    const pa = Math.abs(p - a), pb = Math.abs(p - b), pc = Math.abs(p - c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+/** Reverses the scanline filters; returns the raw rows, rowBytes each. */
+function unfilter(data, height, rowBytes, bytesPerPixel) {
+    const out = Buffer.alloc(height * rowBytes);
+    for (let y = 0; y < height; y++) {
+        const filter = data[y * (rowBytes + 1)];
+        const line = data.subarray(y * (rowBytes + 1) + 1, (y + 1) * (rowBytes + 1));
+        const row = y * rowBytes;
+        for (let x = 0; x < rowBytes; x++) {
+            const left = x >= bytesPerPixel ? out[row + x - bytesPerPixel] : 0;
+            const up = y > 0 ? out[row - rowBytes + x] : 0;
+            const upLeft = y > 0 && x >= bytesPerPixel ? out[row - rowBytes + x - bytesPerPixel] : 0;
+            let value = line[x];
+            if (filter === 1) value += left;
+            else if (filter === 2) value += up;
+            else if (filter === 3) value += (left + up) >> 1;
+            else if (filter === 4) value += paeth(left, up, upLeft);
+            else if (filter !== 0) throw new Error(`unknown filter ${filter}`);
+            out[row + x] = value;
+        }
+    }
+    return out;
+}
+
+/**
+ * Decodes a non-interlaced PNG with 8-bit channels or a palette.
+ * @returns {{ width: number, height: number, rgba: Uint8Array }}
+ */
+function decodePng(buffer) {
+    if (!buffer.subarray(0, 8).equals(PNG_SIGNATURE)) throw new Error("not a PNG");
+    let width = 0, height = 0, bitDepth = 0, colorType = 0;
+    let palette = null, transparency = null;
+    const idat = [];
+    for (let offset = 8; offset < buffer.length;) {
+        const length = buffer.readUInt32BE(offset);
+        const type = buffer.toString('latin1', offset + 4, offset + 8);
+        const data = buffer.subarray(offset + 8, offset + 8 + length);
+        offset += 12 + length;
+        if (type === 'IHDR') {
+            width = data.readUInt32BE(0);
+            height = data.readUInt32BE(4);
+            bitDepth = data[8];
+            colorType = data[9];
+            if (data[12] !== 0) throw new Error("interlaced PNGs are not supported");
+        } else if (type === 'PLTE') palette = data;
+        else if (type === 'tRNS') transparency = data;
+        else if (type === 'IDAT') idat.push(data);
+        else if (type === 'IEND') break;
+    }
+    const channels = CHANNELS[colorType];
+    if (!channels) throw new Error(`unknown color type ${colorType}`);
+    if (colorType === 3 ? bitDepth > 8 : bitDepth !== 8) throw new Error(`bit depth ${bitDepth} is not supported`);
+    const bitsPerPixel = channels * bitDepth;
+    const rowBytes = Math.ceil(width * bitsPerPixel / 8);
+    const raw = unfilter(inflateSync(Buffer.concat(idat)), height, rowBytes, Math.max(1, bitsPerPixel >> 3));
+
+    const rgba = new Uint8Array(width * height * 4);
+    for (let y = 0; y < height; y++) {
+        for (let x = 0; x < width; x++) {
+            const out = (y * width + x) * 4;
+            if (colorType === 3) {
+                const bit = x * bitDepth;
+                const index = (raw[y * rowBytes + (bit >> 3)] >> (8 - bitDepth - (bit & 7))) & ((1 << bitDepth) - 1);
+                rgba[out] = palette[index * 3];
+                rgba[out + 1] = palette[index * 3 + 1];
+                rgba[out + 2] = palette[index * 3 + 2];
+                rgba[out + 3] = transparency && index < transparency.length ? transparency[index] : 255;
+                continue;
+            }
+            const p = y * rowBytes + x * channels;
+            const gray = colorType === 0 || colorType === 4;
+            rgba[out] = raw[p];
+            rgba[out + 1] = gray ? raw[p] : raw[p + 1];
+            rgba[out + 2] = gray ? raw[p] : raw[p + 2];
+            rgba[out + 3] = colorType === 4 ? raw[p + 1] : colorType === 6 ? raw[p + 3] : 255;
+        }
+    }
+    return { width, height, rgba };
+}
+
+// --- PNG Encoding ---
+
+function chunk(type, data) {
+    const header = Buffer.alloc(8);
+    header.writeUInt32BE(data.length, 0);
+    header.write(type, 4, 'latin1');
+    const crc = Buffer.alloc(4);
+    crc.writeUInt32BE(crc32(data, crc32(header.subarray(4))), 0);
+    return Buffer.concat([header, data, crc]);
+}
+
+/** Encodes RGBA pixels as a PNG (filter Paeth on every row, which suits the sprites). */
+function encodePng(width, height, rgba) {
+    const rowBytes = width * 4;
+    const filtered = Buffer.alloc(height * (rowBytes + 1));
+    for (let y = 0; y < height; y++) {
+        filtered[y * (rowBytes + 1)] = 4;
+        for (let x = 0; x < rowBytes; x++) {
+            const left = x >= 4 ? rgba[y * rowBytes + x - 4] : 0;
+            const up = y > 0 ? rgba[(y - 1) * rowBytes + x] : 0;
+            const upLeft = y > 0 && x >= 4 ? rgba[(y - 1) * rowBytes + x - 4] : 0;
+            filtered[y * (rowBytes + 1) + 1 + x] = rgba[y * rowBytes + x] - paeth(left, up, upLeft);
+        }
+    }
+    const header = Buffer.alloc(13);
+    header.writeUInt32BE(width, 0);
+    header.writeUInt32BE(height, 4);
+    header[8] = 8; // Bit depth
+    header[9] = 6; // RGBA
+    return Buffer.concat([
+        PNG_SIGNATURE,
+        chunk('IHDR', header),
+        chunk('IDAT', deflateSync(filtered, { level: 9 })),
+        chunk('IEND', Buffer.alloc(0)),
+    ]);
+}
+
+// --- Sprites ---
+
+/** Box-filter downscale by an integer factor, weighting colors by alpha (no dark fringes). */
+function downscale(image, factor) {
+    const width = Math.floor(image.width / factor);
+    const height = Math.floor(image.height / factor);
+    const rgba = new Uint8Array(width * height * 4);
+    for (let y = 0; y < height; y++) {
+        for (let x = 0; x < width; x++) {
+            let r = 0, g = 0, b = 0, a = 0;
+            for (let dy = 0; dy < factor; dy++) {
+                for (let dx = 0; dx < factor; dx++) {
+                    const p = ((y * factor + dy) * image.width + x * factor + dx) * 4;
+                    const alpha = image.rgba[p + 3];
+                    r += image.rgba[p] * alpha;
+                    g += image.rgba[p + 1] * alpha;
+                    b += image.rgba[p + 2] * alpha;
+                    a += alpha;
+                }
+            }
+            const out = (y * width + x) * 4;
+            if (a > 0) {
+                rgba[out] = Math.round(r / a);
+                rgba[out + 1] = Math.round(g / a);
+                rgba[out + 2] = Math.round(b / a);
+            }
+            rgba[out + 3] = Math.round(a / (factor * factor));
+        }
+    }
+    return { width, height, rgba };
+}
+
+/** Shelf packing, tallest first; sets x and y of each sprite and returns the atlas height. */
+function pack(sprites, atlasWidth) {
+    const order = [...sprites].sort((a, b) => b.image.height - a.image.height);
+    let x = 0, y = 0, shelfHeight = 0;
+    for (const sprite of order) {
+        const w = sprite.image.width + 2 * PADDING;
+        const h = sprite.image.height + 2 * PADDING;
+        if (w > atlasWidth) throw new Error(`${sprite.name} is wider than the atlas`);
+        if (x + w > atlasWidth) {
+            y += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        sprite.x = x + PADDING;
+        sprite.y = y + PADDING;
+        x += w;
+        shelfHeight = Math.max(shelfHeight, h);
+    }
+    return y + shelfHeight;
+}
+
+function buildAtlas(headSize) {
+    const sprites = [];
+    for (const name of [...HEAD_SPRITES, ...DECORATION_SPRITES]) {
+        let image = decodePng(readFileSync(join(ASSETS_DIR, name)));
+        if (HEAD_SPRITES.includes(name)) {
+            if (image.width !== image.height || image.width % headSize !== 0) {
+                throw new Error(`${name} (${image.width}x${image.height}) cannot be scaled to ${headSize}px`);
+            }
+            image = downscale(image, image.width / headSize);
+        }
+        sprites.push({ name, image, x: 0, y: 0 });
+    }
+    const width = HEADS_PER_SHELF * (headSize + 2 * PADDING);
+    const height = pack(sprites, width);
+    const rgba = new Uint8Array(width * height * 4);
+    const manifest = { image: "sprites.png", width, height, sprites: {} };
+    for (const { name, image, x, y } of sprites) {
+        for (let row = 0; row < image.height; row++) {
+            const source = image.rgba.subarray(row * image.width * 4, (row + 1) * image.width * 4);
+            rgba.set(source, ((y + row) * width + x) * 4);
+        }
+        manifest.sprites[name] = { x, y, w: image.width, h: image.height };
+    }
+    return { png: encodePng(width, height, rgba), manifest };
+}
+
+function main() {
+    let args;
+    try {
+        args = parseArgs(process.argv.slice(2));
+    } catch (e) {
+        console.error(e.message);
+        process.exit(2);
+    }
+    const out = args.out || DEFAULT_OUT;
+    const headSize = Number(args["head-size"] || DEFAULT_HEAD_SIZE);
+    if (!Number.isInteger(headSize) || headSize <= 0) {
+        console.error(`Invalid --head-size: ${args["head-size"]}`);
+        process.exit(2);
+    }
+    let atlas;
+    try {
+        atlas = buildAtlas(headSize);
+    } catch (e) {
+        console.error(`[Atlas] ${e.message}`);
+        process.exit(1);
+    }
+    mkdirSync(out, { recursive: true });
+    writeFileSync(join(out, "sprites.png"), atlas.png);
+    writeFileSync(join(out, "sprites.json"), JSON.stringify(atlas.manifest, null, 2) + "\n");
+    const count = Object.keys(atlas.manifest.sprites).length;
+    console.error(`[Atlas] Wrote ${out}/sprites.png (${atlas.manifest.width}x${atlas.manifest.height}, ${count} sprites, ${atlas.png.length} bytes).`);
+}
+
+main();
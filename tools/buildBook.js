@@ -0,0 +1,144 @@
+// tools/buildBook.js
+// Opening book generator:
+//   node tools/buildBook.js [--plies N] [--depth N] [--width N] [--margin N]
+//                           [--layouts layouts.json] [--out assets/book/openings.bin]
+//
+// Starting from the standard setup (or each layout of --layouts, a JSON array of
+// Board.setupPiecesFromLayout layouts) with either side to move, every move of a
+// position is scored by a --depth search. The best move and up to --width - 1
+// others within --margin of it go into the book, weighted by how close they are,
+// and the line continues after each of them down to --plies. The book thus follows
+// the engine's own play, with the alternatives it considers nearly as good.
+
+import { writeFileSync, readFileSync, mkdirSync } from 'node:fs';
+import { dirname } from 'node:path';
+import { Player, GameStatus } from '../js/constants.js';
+import { Board } from '../js/board.js';
+import { Position } from '../js/position.js';
+import { generateMoves, getPositionStatus, MAX_MOVES } from '../js/moveGen.js';
+import { findBestMove, prepareSearch } from '../js/aiSearch.js';
+import { WIN_SCORE, LOSE_SCORE } from '../js/aiEvaluate.js';
+import { OpeningBook } from '../js/openingBook.js';
+
+const DEFAULTS = { plies: 8, depth: 8, width: 3, margin: 40, out: "assets/book/openings.bin" };
+const MAX_WEIGHT = 1000;
+
+function parseArgs(argv) {
+    const args = {};
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        if (!arg.startsWith("--")) throw new Error(`Unexpected argument: ${arg}`);
+        const value = argv[i + 1];
+        if (value === undefined || value.startsWith("--")) throw new Error(`Missing value for ${arg}`);
+        args[arg.slice(2)] = value;
+        i++;
+    }
+    return args;
+}
+
+function toNumber(args, name, fallback) {
+    if (args[name] === undefined) return fallback;
+    const n = Number(args[name]);
+    if (!Number.isInteger(n) || n < 0) throw new Error(`--${name} expects a non-negative integer`);
+    return n;
+}
+
+/** Search score of `pos` from the view of its side to move. */
+function searchScore(pos, depth) {
+    const status = getPositionStatus(pos);
+    if (status !== GameStatus.ONGOING) {
+        // The previous move ended the game (won by the player who is not to move)
+        return status === GameStatus.DRAW ? 0 : LOSE_SCORE;
+    }
+    // The search plays whichever side is to move; it gets its own copy of the position
+    const result = findBestMove(Position.fromBoardState(pos.toBoardState(), pos.sideToMove), depth, Infinity);
+    return result.eval ?? 0;
+}
+
+/**
+ * Scores the moves of `pos` and returns the ones for the book, best first.
+ * @returns {Array<{move:number, score:number, weight:number}>}
+ */
+function selectBookMoves(pos, { depth, width, margin }) {
+    const buffer = new Int32Array(MAX_MOVES);
+    const count = generateMoves(pos, pos.sideToMove, buffer);
+    const scored = [];
+    for (let i = 0; i < count; i++) {
+        const move = buffer[i];
+        pos.makeMove(move);
+        scored.push({ move, score: -searchScore(pos, depth - 1) });
+        pos.unmakeMove(move);
+    }
+    scored.sort((a, b) => b.score - a.score);
+    if (scored.length === 0) return [];
+
+    const best = scored[0].score;
+    const decisive = Math.abs(best) >= WIN_SCORE * 0.9;
+    return scored
+        .filter((m, i) => i === 0 || (!decisive && best - m.score <= margin))
+        .slice(0, Math.max(1, width))
+        .map(m => ({ ...m, weight: Math.round(MAX_WEIGHT * (margin + 1 - (best - m.score)) / (margin + 1)) }));
+}
+
+function startPositions(layouts) {
+    const positions = [];
+    for (const layout of layouts) {
+        const board = new Board();
+        board.initBoard();
+        if (layout) board.setupPiecesFromLayout(layout);
+        else board.setupStandardInitialPieces();
+        const state = board.getClonedStateForWorker();
+        for (const side of [Player.PLAYER0, Player.PLAYER1]) positions.push(Position.fromBoardState(state, side));
+    }
+    return positions;
+}
+
+function main() {
+    let args, options;
+    try {
+        args = parseArgs(process.argv.slice(2));
+        options = {
+            plies: toNumber(args, "plies", DEFAULTS.plies),
+            depth: Math.max(1, toNumber(args, "depth", DEFAULTS.depth)),
+            width: toNumber(args, "width", DEFAULTS.width),
+            margin: toNumber(args, "margin", DEFAULTS.margin)
+        };
+    } catch (e) {
+        console.error(e.message);
+        process.exit(2);
+    }
+    const layouts = args.layouts ? JSON.parse(readFileSync(args.layouts, "utf8")) : [null];
+    const out = args.out || DEFAULTS.out;
+
+    const originalLog = console.log;
+    console.log = () => {}; // The search logs every call
+    prepareSearch({ newGame: true });
+
+    const entries = [];
+    const visited = new Set();
+    let frontier = startPositions(layouts);
+    const startTime = performance.now();
+    for (let ply = 0; ply < options.plies && frontier.length > 0; ply++) {
+        const next = [];
+        for (const pos of frontier) {
+            const key = pos.hashKey();
+            if (visited.has(key) || getPositionStatus(pos) !== GameStatus.ONGOING) continue;
+            visited.add(key);
+            for (const { move, score, weight } of selectBookMoves(pos, options)) {
+                entries.push({ hashLo: pos.hashLo, hashHi: pos.hashHi, move, weight, score });
+                const child = Position.fromBoardState(pos.toBoardState(), pos.sideToMove);
+                child.makeMove(move);
+                next.push(child);
+            }
+        }
+        console.error(`[Book] Ply ${ply + 1}: ${visited.size} positions, ${entries.length} moves (${((performance.now() - startTime) / 1000).toFixed(0)}s)`);
+        frontier = next;
+    }
+    console.log = originalLog;
+
+    mkdirSync(dirname(out), { recursive: true });
+    writeFileSync(out, new Uint8Array(OpeningBook.build(entries)));
+    console.error(`[Book] ${entries.length} entries for ${visited.size} positions written to ${out}`);
+}
+
+main();
@@ -0,0 +1,263 @@
+// tools/buildTablebases.js
+// Endgame tablebase generator (retrograde analysis):
+//   node tools/buildTablebases.js [--pieces N] [--materials lion-tiger_vs_rat,...]
+//                                 [--out assets/tablebase]
+//
+// Builds every material of up to --pieces pieces (default 2) with both sides on the
+// board, plus the --materials given by name (Player 1's pieces, "_vs_", Player 0's; at
+// most TB_MAX_PIECES; default: lion and tiger against each lone piece). The smaller
+// materials a capture leads to are built first.
+// Writes all tables packed into one tables.bin (js/tablebase.js), fetched once by the page.
+//
+// Each table is solved backwards from its decided positions: a position is won at
+// ply n + 1 when a move reaches a position lost at ply n for the opponent, and lost
+// at ply n + 1 when every move reaches an opponent win, the slowest at ply n.
+// Captures and den entries leave the table; their results come from the smaller
+// tables (or decide the game). Positions never resolved are draws.
+
+import { writeFileSync, mkdirSync } from 'node:fs';
+import { join } from 'node:path';
+import { Player, TERRAIN_PLAYER0_DEN, TERRAIN_PLAYER1_DEN } from '../js/constants.js';
+import {
+    Position, NUM_PIECE_CODES, PIECE_TYPES, TERRAIN_TABLE, EMPTY,
+    codePlayer, makePieceCode, moveFrom, moveTo
+} from '../js/position.js';
+import { generateMoves, MAX_MOVES } from '../js/moveGen.js';
+import {
+    Tablebase, TB_MAX_PIECES, TB_LOSS, TB_MAX_DISTANCE, TABLEBASE_PACK_FILE, packTablebases,
+    materialCodes, mirrorMaterial, mirrorCode, mirrorSquare, isCanonicalMaterial, materialName
+} from '../js/tablebase.js';
+
+const DEFAULT_PIECES = 2;
+const DEFAULT_MATERIALS = PIECE_TYPES.map(type => `lion-tiger_vs_${type}`);
+const DEFAULT_OUT = "assets/tablebase";
+const NO_DISTANCE = 255;
+
+function parseArgs(argv) {
+    const args = {};
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        if (!arg.startsWith("--")) throw new Error(`Unexpected argument: ${arg}`);
+        const value = argv[i + 1];
+        if (value === undefined || value.startsWith("--")) throw new Error(`Missing value for ${arg}`);
+        args[arg.slice(2)] = value;
+        i++;
+    }
+    return args;
+}
+
+/** Parses a material name such as "lion-tiger_vs_rat" into its mask. */
+function parseMaterial(name) {
+    const sides = name.split("_vs_");
+    if (sides.length !== 2) throw new Error(`Bad material name: ${name}`);
+    let mask = 0;
+    [Player.PLAYER1, Player.PLAYER0].forEach((player, i) => {
+        for (const type of sides[i].split("-")) {
+            const t = PIECE_TYPES.indexOf(type);
+            if (t < 0) throw new Error(`Unknown piece type in ${name}: ${type}`);
+            mask |= 1 << makePieceCode(player, t);
+        }
+    });
+    return mask;
+}
+
+function hasBothSides(mask) {
+    const codes = materialCodes(mask);
+    return codes.some(c => codePlayer(c) === Player.PLAYER0) && codes.some(c => codePlayer(c) === Player.PLAYER1);
+}
+
+/** Every material of exactly `n` pieces with both sides present, canonical orientation. */
+function materialsOfSize(n) {
+    const result = [];
+    const all = (1 << NUM_PIECE_CODES) - 2; // Codes 1..16
+    const visit = (start, mask, left) => {
+        if (left === 0) {
+            if (hasBothSides(mask) && isCanonicalMaterial(mask)) result.push(mask);
+            return;
+        }
+        for (let code = start; code < NUM_PIECE_CODES; code++) {
+            if (all & (1 << code)) visit(code + 1, mask | (1 << code), left - 1);
+        }
+    };
+    visit(1, 0, n);
+    return result;
+}
+
+// --- Solving ---
+
+const solved = new Map(); // Canonical mask -> Tablebase
+
+/** Value of a position of another (smaller) material, from its side to move's view. */
+function lookUp(mask, codes, squares, sideToMove) {
+    let table = solved.get(mask);
+    const mirrored = !table;
+    if (mirrored) table = solved.get(mirrorMaterial(mask));
+    const ordered = new Int8Array(table.codes.length);
+    for (let i = 0; i < table.codes.length; i++) {
+        const code = mirrored ? mirrorCode(table.codes[i]) : table.codes[i];
+        const sq = squares[codes.indexOf(code)];
+        ordered[i] = mirrored ? mirrorSquare(sq) : sq;
+    }
+    return table.values[table.indexOf(ordered, mirrored ? 1 - sideToMove : sideToMove)];
+}
+
+/** Sets up `pos` as the position of `table` at `index`; false if two pieces share a square. */
+function setUpPosition(pos, table, index, squares) {
+    const sideToMove = table.decode(index, squares);
+    for (let i = 0; i < squares.length; i++) {
+        for (let j = 0; j < i; j++) if (squares[i] === squares[j]) return false;
+    }
+    for (let player = 0; player < 2; player++) {
+        while (pos.pieceCount[player] > 0) pos.removePiece(pos.pieceSquare(player, 0));
+    }
+    for (let i = 0; i < squares.length; i++) pos.addPiece(squares[i], table.codes[i]);
+    pos.sideToMove = sideToMove;
+    return true;
+}
+
+function solve(mask) {
+    if (solved.has(mask) || solved.has(mirrorMaterial(mask))) return;
+    const codes = materialCodes(mask);
+    for (const code of codes) {
+        const smaller = mask & ~(1 << code);
+        if (hasBothSides(smaller)) solve(isCanonicalMaterial(smaller) ? smaller : mirrorMaterial(smaller));
+    }
+
+    const startTime = performance.now();
+    const table = new Tablebase(mask);
+    const size = table.values.length;
+    const pos = new Position();
+    const squares = new Int8Array(codes.length);
+    const childSquares = new Int8Array(codes.length);
+    const moves = new Int32Array(MAX_MOVES);
+
+    const valid = new Uint8Array(size);
+    const unresolved = new Uint8Array(size); // Moves not (yet) known to reach an opponent win
+    const slowestWin = new Uint8Array(size); // Largest distance of the opponent wins reached so far
+    const hasWinningMove = new Uint8Array(size);
+    const predecessorCount = new Int32Array(size + 1);
+    const buckets = Array.from({ length: TB_MAX_DISTANCE + 2 }, () => []); // [index, isWin] pairs by distance
+
+    // Calls visit(childIndex) for each move staying in the table; settles the others
+    const expand = (index, visit) => {
+        const side = pos.sideToMove;
+        const opponent = 1 - side;
+        const count = generateMoves(pos, side, moves);
+        let fastestWin = NO_DISTANCE;
+        for (let m = 0; m < count; m++) {
+            const from = moveFrom(moves[m]);
+            const to = moveTo(moves[m]);
+            const captured = pos.squares[to];
+            const denOfOpponent = opponent === Player.PLAYER0 ? TERRAIN_PLAYER0_DEN : TERRAIN_PLAYER1_DEN;
+            for (let i = 0; i < codes.length; i++) childSquares[i] = squares[i] === from ? to : squares[i];
+
+            if (TERRAIN_TABLE[to] === denOfOpponent || (captured !== EMPTY && pos.pieceCount[opponent] === 1)) {
+                fastestWin = 1; // The move wins the game
+            } else if (captured !== EMPTY) {
+                const childMask = mask & ~(1 << captured);
+                const childCodes = codes.filter(c => c !== captured);
+                const rest = Int8Array.from(childSquares.filter((sq, i) => codes[i] !== captured));
+                const value = lookUp(childMask, childCodes, rest, opponent);
+                if (value >= TB_LOSS) fastestWin = Math.min(fastestWin, value - TB_LOSS + 1);
+                else if (value > 0) slowestWin[index] = Math.max(slowestWin[index], value);
+                else unresolved[index]++; // A drawn line: this position is never lost
+            } else {
+                unresolved[index]++;
+                visit(table.indexOf(childSquares, opponent));
+            }
+        }
+        return { count, fastestWin };
+    };
+
+    // Pass 1: count the predecessors of each position and settle what is known
+    for (let index = 0; index < size; index++) {
+        if (!setUpPosition(pos, table, index, squares)) continue;
+        valid[index] = 1;
+        const { count, fastestWin } = expand(index, (child) => predecessorCount[child + 1]++);
+        if (fastestWin !== NO_DISTANCE) {
+            hasWinningMove[index] = 1;
+            buckets[fastestWin].push(index, 1);
+        } else if (unresolved[index] === 0) buckets[count === 0 ? 0 : Math.min(slowestWin[index] + 1, TB_MAX_DISTANCE + 1)].push(index, 0);
+    }
+
+    // Pass 2: predecessor lists (counts are rebuilt by expand)
+    for (let i = 0; i < size; i++) predecessorCount[i + 1] += predecessorCount[i];
+    const predecessors = new Int32Array(predecessorCount[size]);
+    const filled = predecessorCount.slice(0, size);
+    for (let index = 0; index < size; index++) {
+        if (!valid[index]) continue;
+        setUpPosition(pos, table, index, squares);
+        unresolved[index] = 0;
+        slowestWin[index] = 0;
+        expand(index, (child) => { predecessors[filled[child]++] = index; });
+    }
+
+    // Retrograde propagation in order of distance
+    const resolved = new Uint8Array(size);
+    for (let d = 0; d <= TB_MAX_DISTANCE; d++) {
+        const bucket = buckets[d];
+        for (let k = 0; k < bucket.length; k += 2) {
+            const index = bucket[k];
+            if (resolved[index]) continue;
+            const isWin = bucket[k + 1] === 1;
+            resolved[index] = 1;
+            table.values[index] = isWin ? d : TB_LOSS + d;
+            for (let p = predecessorCount[index]; p < predecessorCount[index + 1]; p++) {
+                const q = predecessors[p];
+                if (resolved[q]) continue;
+                if (!isWin) {
+                    // q can move into this lost position
+                    hasWinningMove[q] = 1;
+                    if (d + 1 <= TB_MAX_DISTANCE) buckets[d + 1].push(q, 1);
+                } else {
+                    slowestWin[q] = Math.max(slowestWin[q], d);
+                    if (--unresolved[q] === 0 && !hasWinningMove[q]) {
+                        buckets[Math.min(slowestWin[q] + 1, TB_MAX_DISTANCE + 1)].push(q, 0);
+                    }
+                }
+            }
+        }
+    }
+
+    let wins = 0, losses = 0, draws = 0;
+    for (let index = 0; index < size; index++) {
+        if (!valid[index]) continue;
+        const v = table.values[index];
+        if (v === 0) draws++; else if (v >= TB_LOSS) losses++; else wins++;
+    }
+    solved.set(mask, table);
+    console.error(`[Tablebase] ${materialName(mask)}: ${wins} wins, ${losses} losses, ${draws} draws (${((performance.now() - startTime) / 1000).toFixed(1)}s)`);
+}
+
+function main() {
+    let args, pieces, extra;
+    try {
+        args = parseArgs(process.argv.slice(2));
+        pieces = args.pieces === undefined ? DEFAULT_PIECES : Number(args.pieces);
+        if (!Number.isInteger(pieces) || pieces < 2 || pieces > TB_MAX_PIECES) {
+            throw new Error(`--pieces expects 2..${TB_MAX_PIECES}`);
+        }
+        extra = (args.materials ? args.materials.split(",") : DEFAULT_MATERIALS).map(parseMaterial);
+        for (const mask of extra) {
+            if (materialCodes(mask).length > TB_MAX_PIECES || !hasBothSides(mask)) throw new Error(`Unsupported material: ${materialName(mask)}`);
+        }
+    } catch (e) {
+        console.error(e.message);
+        process.exit(2);
+    }
+    const out = args.out || DEFAULT_OUT;
+
+    for (let n = 2; n <= pieces; n++) {
+        for (const mask of materialsOfSize(n)) solve(mask);
+    }
+    for (const mask of extra) solve(isCanonicalMaterial(mask) ? mask : mirrorMaterial(mask));
+
+    mkdirSync(out, { recursive: true });
+    // In name order, so a rebuild gives the same file
+    const tables = [...solved].sort(([a], [b]) => materialName(a) < materialName(b) ? -1 : 1).map(([, table]) => table);
+    const pack = packTablebases(tables);
+    writeFileSync(join(out, TABLEBASE_PACK_FILE), new Uint8Array(pack));
+    console.error(`[Tablebase] ${tables.length} tables written to ${join(out, TABLEBASE_PACK_FILE)} (${pack.byteLength} bytes)`);
+}
+
+main();
@@ -0,0 +1,336 @@
+// tools/buildWasmEval.js
+// Generator of the WebAssembly evaluation kernel used by js/wasmEvaluate.js:
+//   node tools/buildWasmEval.js [--out assets/wasm/evaluate.wasm]
+//
+// The module is small enough to assemble directly, so there is no compiler toolchain:
+// the kernel below is written with a few expression helpers and encoded to the
+// binary format here. The board geometry (river, traps, jump lines), the ranks and
+// the piece values are taken from position.js when generating; the values are also
+// stored in the module, so wasmEvaluate.js refuses a module built for other ones.
+// Regenerate after changing any of them or the capture rules.
+//
+// Export threats(captureFactor, adjacentFactor, jumpFactor) -> f64 returns the attack
+// and jump threat terms of evaluatePosition, signed from Player 1's view, for the
+// bitboards in memory (layout in js/wasmEvaluate.js). Each v128 holds one piece type,
+// Player 0 in lane 0 and Player 1 in lane 1; swapping the lanes turns a player's
+// attackers into the opponent's targets, so both sides are computed together. Ranks
+// and values (in units of their common divisor) are kept as bit planes, so each
+// direction costs the same whatever the pieces:
+//   - adjacent pairs: shift_d(attackers) & targets;
+//   - captures: the same where the shifted attacker rank is >= the target rank
+//     (compared bit-sliced; traps make a rank 0), plus Rat vs Elephant and Rats in water;
+//   - jumps: Lion/Tiger shifted along each jump line, masked by the empty river squares.
+// Pairs are counted per value plane with i8x16.popcnt, widened pairwise and weighted
+// by the plane's bit; the factors are applied to the three sums at the end.
+
+import { writeFileSync, mkdirSync } from 'node:fs';
+import { dirname } from 'node:path';
+import { BOARD_COLS, TERRAIN_WATER, Player } from '../js/constants.js';
+import {
+    NUM_SQUARES, TERRAIN_TABLE, TRAP_OWNER, CODE_RANK, TYPE_RAT, TYPE_TIGER, TYPE_LION, TYPE_ELEPHANT,
+    JUMP_COUNT, JUMP_ORIGIN, JUMP_LANDING, JUMP_PATH, JUMP_PATH_LENGTH, JUMP_LION_ONLY, MAX_JUMP_PATH,
+    CODE_VALUE, makePieceCode, squareCol
+} from '../js/position.js';
+import { WASM_BITBOARD_OFFSET, WASM_VALUE_OFFSET, WASM_PIECE_TYPES } from '../js/wasmEvaluate.js';
+
+const DEFAULT_OUT = "assets/wasm/evaluate.wasm";
+
+function parseArgs(argv) {
+    const args = {};
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        if (!arg.startsWith("--")) throw new Error(`Unexpected argument: ${arg}`);
+        const value = argv[i + 1];
+        if (value === undefined || value.startsWith("--")) throw new Error(`Missing value for ${arg}`);
+        args[arg.slice(2)] = value;
+        i++;
+    }
+    return args;
+}
+
+// --- Binary Encoding ---
+
+function unsignedLeb(n) {
+    const bytes = [];
+    do {
+        let byte = n & 0x7f;
+        n >>>= 7;
+        if (n !== 0) byte |= 0x80;
+        bytes.push(byte);
+    } while (n !== 0);
+    return bytes;
+}
+
+function signedLeb(n) {
+    const bytes = [];
+    for (;;) {
+        const byte = n & 0x7f;
+        n >>= 7;
+        if ((n === 0 && (byte & 0x40) === 0) || (n === -1 && (byte & 0x40) !== 0)) {
+            bytes.push(byte);
+            return bytes;
+        }
+        bytes.push(byte | 0x80);
+    }
+}
+
+const encodeString = s => [...unsignedLeb(s.length), ...Buffer.from(s, "utf8")];
+const encodeVector = items => [...unsignedLeb(items.length), ...items.flat()];
+const section = (id, bytes) => [id, ...unsignedLeb(bytes.length), ...bytes];
+
+const F64 = 0x7c, V128 = 0x7b;
+const OP = {
+    end: 0x0b, if: 0x04, blockVoid: 0x40,
+    localGet: 0x20, localSet: 0x21,
+    i32Const: 0x41, i32Add: 0x6a, i32Sub: 0x6b, i32Mul: 0x6c,
+    f64Sub: 0xa1, f64Mul: 0xa2, f64Add: 0xa0, f64ConvertI32S: 0xb7
+};
+const SIMD_PREFIX = 0xfd;
+const SIMD = {
+    load: 0x00, const: 0x0c, shuffle: 0x0d, i32x4ExtractLane: 0x1b,
+    not: 0x4d, and: 0x4e, andNot: 0x4f, or: 0x50, xor: 0x51, anyTrue: 0x53,
+    i8x16Popcnt: 0x62, i8x16Add: 0x6e,
+    i16x8ExtaddPairwiseI8x16U: 0x7d, i32x4ExtaddPairwiseI16x8U: 0x7f,
+    i32x4Shl: 0xab, i32x4Add: 0xae, i64x2Shl: 0xcb, i64x2ShrU: 0xcd
+};
+
+// --- Expression Helpers ---
+// Each helper returns the instruction bytes that leave its value on the stack.
+
+const simd = (op, ...operands) => [...operands.flat(), SIMD_PREFIX, ...unsignedLeb(op)];
+const get = index => [OP.localGet, ...unsignedLeb(index)];
+const i32 = n => [OP.i32Const, ...signedLeb(n)];
+const and = (a, b) => simd(SIMD.and, a, b);
+const andNot = (a, b) => simd(SIMD.andNot, a, b); // a & ~b
+const or = (...xs) => xs.reduce((a, b) => simd(SIMD.or, a, b));
+const addBytes = (...xs) => xs.reduce((a, b) => simd(SIMD.i8x16Add, a, b));
+const popcount = x => simd(SIMD.i8x16Popcnt, x);
+// Byte counts to int32 lanes: lanes 0 + 1 belong to Player 0, lanes 2 + 3 to Player 1
+const widen = x => simd(SIMD.i32x4ExtaddPairwiseI16x8U, simd(SIMD.i16x8ExtaddPairwiseI8x16U, x));
+const load = offset => [...i32(0), SIMD_PREFIX, ...unsignedLeb(SIMD.load), 4, ...unsignedLeb(offset)];
+const swapLanes = x => [...x, ...x, SIMD_PREFIX, ...unsignedLeb(SIMD.shuffle), 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7];
+const extractLane = (x, lane) => [...simd(SIMD.i32x4ExtractLane, x), lane];
+
+/** Both 64-bit lanes shifted: towards higher squares for n > 0. */
+function shift(x, n) {
+    if (n === 0) return x;
+    return n > 0 ? simd(SIMD.i64x2Shl, x, i32(n)) : simd(SIMD.i64x2ShrU, x, i32(-n));
+}
+
+/** v128 constant from the bitboards of lane 0 (Player 0) and lane 1 (Player 1). */
+function bitboardConst(lane0, lane1 = lane0) {
+    const bytes = [];
+    for (const lane of [lane0, lane1]) {
+        for (let i = 0n; i < 8n; i++) bytes.push(Number((lane >> (8n * i)) & 0xffn));
+    }
+    return [SIMD_PREFIX, ...unsignedLeb(SIMD.const), ...bytes];
+}
+
+function squaresMask(predicate) {
+    let mask = 0n;
+    for (let sq = 0; sq < NUM_SQUARES; sq++) if (predicate(sq)) mask |= 1n << BigInt(sq);
+    return mask;
+}
+
+// --- Board Masks ---
+
+const BOARD = squaresMask(() => true);
+const WATER = squaresMask(sq => TERRAIN_TABLE[sq] === TERRAIN_WATER);
+const TRAPS = [Player.PLAYER0, Player.PLAYER1].map(owner => squaresMask(sq => TRAP_OWNER[sq] === owner));
+const FIRST_COL = squaresMask(sq => squareCol(sq) === 0);
+const LAST_COL = squaresMask(sq => squareCol(sq) === BOARD_COLS - 1);
+
+// Steps as shift distance and the attacker squares that have a neighbour that way
+const DIRECTIONS = [
+    { shift: -BOARD_COLS, from: BOARD },
+    { shift: BOARD_COLS, from: BOARD },
+    { shift: -1, from: BOARD & ~FIRST_COL },
+    { shift: 1, from: BOARD & ~LAST_COL }
+];
+
+/**
+ * Jump lines grouped by their shift (landing - origin): the origins, the path squares
+ * as offsets from the landing, and whether the Tiger may jump too. Within a group
+ * every landing has a single origin, so its landing squares can be counted together.
+ */
+function jumpGroups() {
+    const groups = new Map();
+    for (let j = 0; j < JUMP_COUNT; j++) {
+        const origin = JUMP_ORIGIN[j], landing = JUMP_LANDING[j];
+        if (TRAP_OWNER[origin] !== Player.NONE || TRAP_OWNER[landing] !== Player.NONE) {
+            throw new Error("Jump lines touching a trap are not supported by the kernel");
+        }
+        const path = [];
+        for (let k = 0; k < JUMP_PATH_LENGTH[j]; k++) path.push(JUMP_PATH[j * MAX_JUMP_PATH + k] - landing);
+        const key = `${landing - origin}:${path.join(",")}:${JUMP_LION_ONLY[j]}`;
+        if (!groups.has(key)) groups.set(key, { shift: landing - origin, path, lionOnly: JUMP_LION_ONLY[j] === 1, origins: 0n });
+        groups.get(key).origins |= 1n << BigInt(origin);
+    }
+    return [...groups.values()];
+}
+
+// --- Kernel ---
+
+const TYPES = [...Array(WASM_PIECE_TYPES).keys()];
+const rankOf = type => CODE_RANK[makePieceCode(Player.PLAYER0, type)];
+const valueOf = type => CODE_VALUE[makePieceCode(Player.PLAYER0, type)];
+const gcd = (a, b) => (b === 0 ? a : gcd(b, a % b));
+// Ranks and values (in units of their common divisor) as bit planes
+const RANK_BITS = Math.max(...TYPES.map(rankOf)).toString(2).length;
+const VALUE_UNIT = TYPES.map(valueOf).reduce(gcd);
+const VALUE_BITS = Math.max(...TYPES.map(t => valueOf(t) / VALUE_UNIT)).toString(2).length;
+
+function buildThreatsFunction() {
+    const PARAM_CAPTURE = 0, PARAM_ADJACENT = 1, PARAM_JUMP = 2;
+    let localCount = 0;
+    const local = () => 3 + localCount++;
+    let code = []; // Instructions being emitted (switched for the conditional jump block)
+    const set = (index, expr) => code.push(...expr, OP.localSet, ...unsignedLeb(index));
+    const define = expr => { const index = local(); set(index, expr); return get(index); };
+    const unionOf = (sets, keep) => {
+        const members = TYPES.filter(keep).map(t => sets[t]);
+        return members.length > 0 ? or(...members) : bitboardConst(0n);
+    };
+
+    // attackers[t]: a player's pieces of type t; targets[t]: the opponent's (lanes swapped)
+    const attackers = TYPES.map(t => define(load(WASM_BITBOARD_OFFSET + t * 16)));
+    const targets = attackers.map(a => define(swapLanes(a)));
+    const water = bitboardConst(WATER);
+    const ownTraps = bitboardConst(TRAPS[Player.PLAYER0], TRAPS[Player.PLAYER1]); // Traps of the attacking lane
+    const opponentTraps = bitboardConst(TRAPS[Player.PLAYER1], TRAPS[Player.PLAYER0]);
+
+    const occupied = define(or(...attackers));
+    const targeted = define(swapLanes(occupied));
+    const onLand = define(andNot(occupied, water));
+    const landRats = define(andNot(attackers[TYPE_RAT], water));
+    const swimmingRats = define(and(attackers[TYPE_RAT], water));
+    const swimmingRatTargets = define(and(targets[TYPE_RAT], water));
+    // Rank planes: attackers on land outside the opponent's traps keep their rank (others
+    // count as 0); targets in the attacker's traps count as 0
+    const ranked = define(andNot(occupied, or(water, opponentTraps)));
+    const attackerRank = [], targetRank = [], targetValue = [];
+    for (let bit = 0; bit < RANK_BITS; bit++) {
+        attackerRank.push(define(and(unionOf(attackers, t => (rankOf(t) >> bit) & 1), ranked)));
+        targetRank.push(define(andNot(unionOf(targets, t => (rankOf(t) >> bit) & 1), ownTraps)));
+    }
+    for (let bit = 0; bit < VALUE_BITS; bit++) {
+        targetValue.push(define(unionOf(targets, t => ((valueOf(t) / VALUE_UNIT) >> bit) & 1)));
+    }
+
+    // Pair counts per value plane, summed over the directions
+    const adjacentCounts = targetValue.map(() => local());
+    const captureCounts = targetValue.map(() => local());
+    for (const count of [...adjacentCounts, ...captureCounts]) set(count, bitboardConst(0n));
+    const count = (counts, pairs) => {
+        const squares = define(pairs);
+        counts.forEach((c, bit) => set(c, addBytes(get(c), popcount(and(squares, targetValue[bit])))));
+    };
+
+    for (const { shift: distance, from } of DIRECTIONS) {
+        const stepped = x => shift(from === BOARD ? x : and(x, bitboardConst(from)), distance);
+        // Attacker rank >= target rank, bit-sliced from the top bit
+        let greater = null, equal = null;
+        for (let bit = RANK_BITS - 1; bit >= 0; bit--) {
+            const a = define(stepped(attackerRank[bit])), b = targetRank[bit];
+            const above = andNot(a, b), same = simd(SIMD.not, simd(SIMD.xor, a, b));
+            greater = define(greater ? or(greater, and(equal, above)) : above);
+            equal = define(equal ? and(equal, same) : same);
+        }
+        count(adjacentCounts, and(stepped(occupied), targeted));
+        count(captureCounts, or(
+            // By rank from land, except Elephants on Rats
+            andNot(and(or(greater, equal), and(stepped(onLand), targeted)), and(stepped(attackers[TYPE_ELEPHANT]), targets[TYPE_RAT])),
+            and(stepped(landRats), targets[TYPE_ELEPHANT]),  // Rats on land capture Elephants
+            and(stepped(swimmingRats), swimmingRatTargets)   // A Rat in water only captures in water
+        ));
+    }
+
+    // Jumps, only when a Lion or Tiger stands on a jump origin
+    const groups = jumpGroups();
+    const allOrigins = groups.reduce((mask, g) => mask | g.origins, 0n);
+    const jumpCounts = targetValue.map(() => local());
+    for (const c of jumpCounts) set(c, bitboardConst(0n));
+    const mainCode = code;
+    code = [];
+    {
+        const empty = define(andNot(bitboardConst(BOARD), or(occupied, targeted)));
+        const preyOf = jumper => define(unionOf(targets, t => rankOf(t) <= rankOf(jumper)));
+        const lionPrey = preyOf(TYPE_LION), tigerPrey = preyOf(TYPE_TIGER);
+        for (const g of groups) {
+            const clear = g.path.map(offset => shift(empty, -offset)).reduce((a, b) => and(a, b));
+            const landing = jumper => shift(and(attackers[jumper], bitboardConst(g.origins)), g.shift);
+            const jumpers = g.lionOnly
+                ? and(landing(TYPE_LION), lionPrey)
+                : or(and(landing(TYPE_LION), lionPrey), and(landing(TYPE_TIGER), tigerPrey));
+            count(jumpCounts, and(jumpers, clear));
+        }
+    }
+    const jumpCode = code;
+    code = mainCode;
+    const jumpers = or(attackers[TYPE_TIGER], attackers[TYPE_LION]);
+    code.push(...simd(SIMD.anyTrue, and(jumpers, bitboardConst(allOrigins))), OP.if, OP.blockVoid, ...jumpCode, OP.end);
+
+    // Value-weighted sums: plane counts widened to int32 lanes, times 2^bit
+    const weighted = counts => define(counts
+        .map((c, bit) => simd(SIMD.i32x4Shl, widen(get(c)), i32(bit)))
+        .reduce((a, b) => simd(SIMD.i32x4Add, a, b)));
+    // Player 1's sum minus Player 0's (lanes 2 + 3 minus lanes 0 + 1), in value units
+    const difference = counts => {
+        const sum = weighted(counts);
+        return [
+            ...extractLane(sum, 2), ...extractLane(sum, 3), OP.i32Add,
+            ...extractLane(sum, 0), OP.i32Sub, ...extractLane(sum, 1), OP.i32Sub,
+            ...i32(VALUE_UNIT), OP.i32Mul, OP.f64ConvertI32S
+        ];
+    };
+    code.push(
+        ...get(PARAM_ADJACENT), ...difference(adjacentCounts), OP.f64Mul,
+        ...get(PARAM_CAPTURE), ...get(PARAM_ADJACENT), OP.f64Sub, ...difference(captureCounts), OP.f64Mul, OP.f64Add,
+        ...get(PARAM_JUMP), ...difference(jumpCounts), OP.f64Mul, OP.f64Add,
+        OP.end
+    );
+    const locals = encodeVector([[...unsignedLeb(localCount), V128]]);
+    const body = [...locals, ...code];
+    return [...unsignedLeb(body.length), ...body];
+}
+
+function buildModule() {
+    const threatsType = [0x60, ...encodeVector([F64, F64, F64].map(t => [t])), ...encodeVector([[F64]])];
+    // The piece values the kernel was generated for, checked by wasmEvaluate.js
+    const values = TYPES.flatMap(t => [0, 8, 16, 24].map(b => (valueOf(t) >> b) & 0xff));
+    return new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,                 // "\0asm", version 1
+        ...section(1, encodeVector([threatsType])),                      // Types
+        ...section(3, encodeVector([[0]])),                              // Functions
+        ...section(5, encodeVector([[0x00, 1]])),                        // Memory: one page
+        ...section(7, encodeVector([
+            [...encodeString("memory"), 0x02, 0],
+            [...encodeString("threats"), 0x00, 0]
+        ])),
+        ...section(10, encodeVector([buildThreatsFunction()])),          // Code
+        ...section(11, encodeVector([[0x00, ...i32(WASM_VALUE_OFFSET), OP.end, ...encodeVector(values.map(b => [b]))]])) // Data
+    ]);
+}
+
+function main() {
+    let args;
+    try {
+        args = parseArgs(process.argv.slice(2));
+    } catch (e) {
+        console.error(e.message);
+        process.exit(2);
+    }
+    const out = args.out || DEFAULT_OUT;
+    const bytes = buildModule();
+    try {
+        new WebAssembly.Module(bytes);
+    } catch (e) {
+        console.error(`[Wasm] The generated module does not compile: ${e.message}`);
+        process.exit(1);
+    }
+    mkdirSync(dirname(out), { recursive: true });
+    writeFileSync(out, bytes);
+    console.error(`[Wasm] Wrote ${out} (${bytes.length} bytes).`);
+}
+
+main();
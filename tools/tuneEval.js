@@ -0,0 +1,213 @@
+// tools/tuneEval.js
+// Texel-style tuning of EVAL_PARAMS.HEURISTIC_WEIGHTS from self-play positions:
+//   node tools/tuneEval.js --data games.bin[,more.bin] [--threads N] [--iterations N]
+//                          [--rate R] [--k K] [--weights MATERIAL,...] [--init weights.json]
+//                          [--limit N] [--out assets/eval/weights.json]
+// Record the data first, e.g. node bench/tournament.js --games 2000 --record games.bin
+//
+// The evaluation is linear in every heuristic weight, so each position is reduced once to
+// a constant and one term per weight. The weights (all, or the --weights given) are then
+// fitted to the game results by minimizing the mean squared error of sigmoid(K * eval)
+// with Adam on the full batch. The positions are shared between worker threads, which
+// extract the terms and return the loss and gradient of their part. K is fitted first,
+// with the starting weights, unless given.
+// Writes { "HEURISTIC_WEIGHTS": {...} }, which the page and the AI workers load when
+// AI_TUNED_WEIGHTS is set (js/constants.js).
+
+import { writeFileSync, readFileSync, mkdirSync } from 'node:fs';
+import { dirname } from 'node:path';
+import { availableParallelism } from 'node:os';
+import { Worker } from 'node:worker_threads';
+import { getEvalParams } from '../js/aiEvaluate.js';
+import { countTuningRecords, readTuningRecords, TUNING_RECORD_BYTES } from '../bench/tuningData.js';
+
+const DEFAULT_OUT = "assets/eval/weights.json";
+const DEFAULT_ITERATIONS = 400;
+const DEFAULT_RATE = 0.02;
+const K_SEARCH_RANGE = [1e-5, 1e-1];
+const K_SEARCH_STEPS = 40;
+const ADAM_BETA1 = 0.9;
+const ADAM_BETA2 = 0.999;
+const ADAM_EPSILON = 1e-8;
+const REPORT_EVERY = 50;
+
+const WEIGHT_NAMES = Object.keys(getEvalParams().HEURISTIC_WEIGHTS);
+
+function parseArgs(argv) {
+    const args = {};
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        if (!arg.startsWith("--")) throw new Error(`Unexpected argument: ${arg}`);
+        const value = argv[i + 1];
+        if (value === undefined || value.startsWith("--")) throw new Error(`Missing value for ${arg}`);
+        args[arg.slice(2)] = value;
+        i++;
+    }
+    return args;
+}
+
+function toNumber(args, name, fallback, integer = false) {
+    if (args[name] === undefined) return fallback;
+    const n = Number(args[name]);
+    if (!Number.isFinite(n) || n <= 0 || (integer && !Number.isInteger(n))) {
+        throw new Error(`--${name} expects a positive ${integer ? "integer" : "number"}`);
+    }
+    return n;
+}
+
+/** Starting weights: the built-in ones, overridden by an --init weights file. */
+function startingWeights(initPath) {
+    const weights = { ...getEvalParams().HEURISTIC_WEIGHTS };
+    if (initPath) Object.assign(weights, JSON.parse(readFileSync(initPath, "utf8")).HEURISTIC_WEIGHTS || {});
+    return Float64Array.from(WEIGHT_NAMES, name => weights[name]);
+}
+
+/** Loads the records of every data file into shared memory. */
+function loadRecords(paths, limit) {
+    const counts = paths.map(countTuningRecords);
+    const total = Math.min(limit, counts.reduce((a, b) => a + b, 0));
+    const records = new SharedArrayBuffer(total * TUNING_RECORD_BYTES);
+    const bytes = new Uint8Array(records);
+    let loaded = 0;
+    for (const path of paths) {
+        if (loaded >= total) break;
+        loaded += readTuningRecords(path, bytes, loaded, total - loaded);
+    }
+    return { records, count: loaded };
+}
+
+/** Sends a message to every worker and collects the replies. */
+function broadcast(workers, message) {
+    return Promise.all(workers.map(worker => new Promise((resolve, reject) => {
+        worker.once('error', reject);
+        worker.once('message', reply => {
+            worker.off('error', reject);
+            resolve(reply);
+        });
+        worker.postMessage(message);
+    })));
+}
+
+/** Mean squared error (and its gradient) over all positions. */
+async function evaluateLoss(workers, weights, k, gradient = false) {
+    const replies = await broadcast(workers, { type: 'loss', weights, k, gradient });
+    let loss = 0, count = 0;
+    const sum = new Float64Array(weights.length);
+    for (const reply of replies) {
+        loss += reply.loss;
+        count += reply.count;
+        for (let w = 0; w < sum.length; w++) sum[w] += reply.gradient[w];
+    }
+    for (let w = 0; w < sum.length; w++) sum[w] /= count;
+    return { loss: loss / count, gradient: sum };
+}
+
+/** Fits the sigmoid scale K by golden-section search over log K. */
+async function fitK(workers, weights) {
+    const ratio = (Math.sqrt(5) - 1) / 2;
+    let lo = Math.log(K_SEARCH_RANGE[0]), hi = Math.log(K_SEARCH_RANGE[1]);
+    const lossAt = async x => (await evaluateLoss(workers, weights, Math.exp(x))).loss;
+    let a = hi - ratio * (hi - lo), b = lo + ratio * (hi - lo);
+    let fa = await lossAt(a), fb = await lossAt(b);
+    for (let step = 0; step < K_SEARCH_STEPS; step++) {
+        if (fa < fb) {
+            hi = b; b = a; fb = fa;
+            a = hi - ratio * (hi - lo); fa = await lossAt(a);
+        } else {
+            lo = a; a = b; fa = fb;
+            b = lo + ratio * (hi - lo); fb = await lossAt(b);
+        }
+    }
+    return Math.exp((lo + hi) / 2);
+}
+
+function formatWeights(weights) {
+    return WEIGHT_NAMES.map((name, i) => `${name}=${weights[i].toFixed(4)}`).join(" ");
+}
+
+async function main() {
+    let args, paths, threads, iterations, rate, fixedK, limit, tuned;
+    try {
+        args = parseArgs(process.argv.slice(2));
+        if (!args.data) throw new Error("--data expects one or more tuning data files");
+        paths = args.data.split(",");
+        threads = toNumber(args, "threads", availableParallelism(), true);
+        iterations = toNumber(args, "iterations", DEFAULT_ITERATIONS, true);
+        rate = toNumber(args, "rate", DEFAULT_RATE);
+        fixedK = toNumber(args, "k", null);
+        limit = toNumber(args, "limit", Infinity, true);
+        tuned = args.weights ? args.weights.split(",") : WEIGHT_NAMES;
+        for (const name of tuned) {
+            if (!WEIGHT_NAMES.includes(name)) throw new Error(`Unknown weight: ${name} (known: ${WEIGHT_NAMES.join(", ")})`);
+        }
+    } catch (e) {
+        console.error(e.message);
+        process.exit(2);
+    }
+    const out = args.out || DEFAULT_OUT;
+    const tunedMask = WEIGHT_NAMES.map(name => tuned.includes(name));
+    const weights = startingWeights(args.init);
+
+    const { records, count } = loadRecords(paths, limit);
+    if (count === 0) {
+        console.error("No positions in the data.");
+        process.exit(1);
+    }
+    const stride = WEIGHT_NAMES.length + 2;
+    const features = new SharedArrayBuffer(count * stride * Float64Array.BYTES_PER_ELEMENT);
+    const workerCount = Math.min(threads, count);
+    const workers = [];
+    for (let t = 0; t < workerCount; t++) {
+        const start = Math.floor(count * t / workerCount);
+        const end = Math.floor(count * (t + 1) / workerCount);
+        workers.push(new Worker(new URL('./tuneEvalWorker.js', import.meta.url), {
+            workerData: { records, features, start, end, weightNames: WEIGHT_NAMES, initialWeights: weights }
+        }));
+    }
+
+    console.error(`[Tune] Extracting evaluation terms of ${count} positions on ${workerCount} thread(s)...`);
+    const extracted = await broadcast(workers, { type: 'extract' });
+    const maxDeviation = Math.max(...extracted.map(r => r.maxDeviation));
+    console.error(`[Tune]   Linear model matches the evaluation within ${maxDeviation.toFixed(2)}.`);
+
+    const k = fixedK ?? await fitK(workers, weights);
+    const initial = await evaluateLoss(workers, weights, k);
+    console.error(`[Tune] K = ${k.toPrecision(4)}, starting error ${initial.loss.toFixed(6)}`);
+    if (fixedK === null && (k < K_SEARCH_RANGE[0] * 1.01 || k > K_SEARCH_RANGE[1] * 0.99)) {
+        console.error(`[Tune]   K is at the end of its search range; the results barely follow the evaluation (more or deeper games help).`);
+    }
+    console.error(`[Tune]   ${formatWeights(weights)}`);
+
+    // Adam on the tuned weights; the best weights seen are kept
+    const m = new Float64Array(weights.length);
+    const v = new Float64Array(weights.length);
+    let best = { loss: initial.loss, weights: Float64Array.from(weights) };
+    for (let step = 1; step <= iterations; step++) {
+        const { loss, gradient } = await evaluateLoss(workers, weights, k, true);
+        if (loss < best.loss) best = { loss, weights: Float64Array.from(weights) };
+        for (let w = 0; w < weights.length; w++) {
+            if (!tunedMask[w]) continue;
+            m[w] = ADAM_BETA1 * m[w] + (1 - ADAM_BETA1) * gradient[w];
+            v[w] = ADAM_BETA2 * v[w] + (1 - ADAM_BETA2) * gradient[w] * gradient[w];
+            const mHat = m[w] / (1 - ADAM_BETA1 ** step);
+            const vHat = v[w] / (1 - ADAM_BETA2 ** step);
+            weights[w] -= rate * mHat / (Math.sqrt(vHat) + ADAM_EPSILON);
+        }
+        if (step % REPORT_EVERY === 0 || step === iterations) {
+            console.error(`[Tune] Iteration ${step}: error ${loss.toFixed(6)}`);
+        }
+    }
+    const final = await evaluateLoss(workers, weights, k);
+    if (final.loss < best.loss) best = { loss: final.loss, weights: Float64Array.from(weights) };
+    await Promise.all(workers.map(w => w.terminate()));
+
+    const result = {};
+    WEIGHT_NAMES.forEach((name, i) => { result[name] = Math.round(best.weights[i] * 1e4) / 1e4; });
+    mkdirSync(dirname(out), { recursive: true });
+    writeFileSync(out, JSON.stringify({ HEURISTIC_WEIGHTS: result }, null, 2) + "\n");
+    console.error(`[Tune] Error ${initial.loss.toFixed(6)} -> ${best.loss.toFixed(6)}`);
+    console.error(`[Tune]   ${formatWeights(best.weights)}`);
+    console.error(`[Tune] Wrote ${out}`);
+}
+
+main();
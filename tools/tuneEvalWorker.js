@@ -0,0 +1,99 @@
+// tools/tuneEvalWorker.js
+// worker_threads side of tools/tuneEval.js. Owns records [start, end) of the shared data
+// (workerData: { records, features, start, end, weightNames, initialWeights }) and answers:
+//   { type: 'extract' }                    -> { maxDeviation }  (fills its feature rows)
+//   { type: 'loss', weights, k, gradient } -> { loss, gradient, count } (sums over its rows)
+import { parentPort, workerData } from 'node:worker_threads';
+import { Position, NUM_SQUARES } from '../js/position.js';
+import { evaluatePosition, setEvalParams } from '../js/aiEvaluate.js';
+import { decodeTuningRecord, RESULT_WIN, RESULT_DRAW } from '../bench/tuningData.js';
+
+// Terms are extracted with the weight at this value and scaled back, so the integer
+// rounding of evaluatePosition costs at most 0.5 / FEATURE_SCALE per feature
+const FEATURE_SCALE = 1000;
+
+const { records, features, start, end, weightNames: WEIGHT_NAMES, initialWeights } = workerData;
+const FEATURE_STRIDE = WEIGHT_NAMES.length + 2;
+const recordBytes = new Uint8Array(records);
+const rows = new Float64Array(features);
+
+function weightsObject(values) {
+    const weights = {};
+    WEIGHT_NAMES.forEach((name, i) => { weights[name] = values[i]; });
+    return weights;
+}
+
+/** Evaluates records [start, end) with the given weights into `out` (relative to their sides to move). */
+function evaluateAll(weightValues, out) {
+    setEvalParams({ HEURISTIC_WEIGHTS: weightsObject(weightValues) });
+    for (let i = start; i < end; i++) {
+        const { squares, sideToMove } = decodeTuningRecord(recordBytes, i);
+        out[i - start] = evaluatePosition(Position.fromSquares(squares.subarray(0, NUM_SQUARES), sideToMove));
+    }
+}
+
+/**
+ * Row layout (FEATURE_STRIDE values per record): the evaluation with every weight at 0,
+ * then one term per weight, then the result (1 win, 0.5 draw, 0 loss).
+ */
+function extract() {
+    const count = end - start;
+    const base = new Float64Array(count);
+    const scratch = new Float64Array(count);
+    const unit = new Float64Array(WEIGHT_NAMES.length);
+    evaluateAll(unit, base);
+    for (let i = start; i < end; i++) {
+        const row = i * FEATURE_STRIDE;
+        rows[row] = base[i - start];
+        const { result } = decodeTuningRecord(recordBytes, i);
+        rows[row + FEATURE_STRIDE - 1] = result === RESULT_WIN ? 1 : result === RESULT_DRAW ? 0.5 : 0;
+    }
+    for (let w = 0; w < WEIGHT_NAMES.length; w++) {
+        unit.fill(0);
+        unit[w] = FEATURE_SCALE;
+        evaluateAll(unit, scratch);
+        for (let i = start; i < end; i++) {
+            rows[i * FEATURE_STRIDE + 1 + w] = (scratch[i - start] - base[i - start]) / FEATURE_SCALE;
+        }
+    }
+    // How closely the linear model reproduces the real evaluation at the starting weights
+    evaluateAll(initialWeights, scratch);
+    let maxDeviation = 0;
+    for (let i = start; i < end; i++) {
+        const diff = Math.abs(modelScore(i, initialWeights) - scratch[i - start]);
+        if (diff > maxDeviation) maxDeviation = diff;
+    }
+    return { maxDeviation };
+}
+
+function modelScore(i, weights) {
+    const row = i * FEATURE_STRIDE;
+    let score = rows[row];
+    for (let w = 0; w < weights.length; w++) score += weights[w] * rows[row + 1 + w];
+    return score;
+}
+
+/** Sum of squared errors of sigmoid(k * score) against the results, and its gradient. */
+function loss(weights, k, withGradient) {
+    const gradient = new Float64Array(weights.length);
+    let total = 0;
+    for (let i = start; i < end; i++) {
+        const row = i * FEATURE_STRIDE;
+        const predicted = 1 / (1 + Math.exp(-k * modelScore(i, weights)));
+        const error = rows[row + FEATURE_STRIDE - 1] - predicted;
+        total += error * error;
+        if (withGradient) {
+            const slope = -2 * error * predicted * (1 - predicted) * k;
+            for (let w = 0; w < weights.length; w++) gradient[w] += slope * rows[row + 1 + w];
+        }
+    }
+    return { loss: total, gradient, count: end - start };
+}
+
+parentPort.on('message', (message) => {
+    if (message.type === 'extract') {
+        parentPort.postMessage(extract());
+    } else if (message.type === 'loss') {
+        parentPort.postMessage(loss(message.weights, message.k, message.gradient));
+    }
+});